@@ -87,6 +87,11 @@ static gboolean thunar_tpa_leave_notify_event  (GtkWidget           *button,
                                                 ThunarTpa           *plugin);
 static void     thunar_tpa_on_trash_changed    (thunarTPATrash      *proxy,
                                                 gpointer             user_data);
+static void     thunar_tpa_on_props_changed    (GDBusProxy          *proxy,
+                                                GVariant            *changed_properties,
+                                                GStrv                invalidated_properties,
+                                                ThunarTpa           *plugin);
+static gboolean thunar_tpa_cached_state        (ThunarTpa           *plugin);
 static void     thunar_tpa_display_trash       (ThunarTpa           *plugin);
 static void     thunar_tpa_empty_trash         (ThunarTpa           *plugin);
 static gboolean thunar_tpa_move_to_trash       (ThunarTpa           *plugin,
@@ -187,6 +192,10 @@ thunar_tpa_init (ThunarTpa *plugin)
     thunar_tpa_error (plugin, error);
 
   g_signal_connect (plugin->proxy, "trash_changed", G_CALLBACK (thunar_tpa_on_trash_changed), plugin);
+
+  /* the file manager publishes the trash state as properties */
+  if (G_LIKELY (plugin->proxy != NULL))
+    g_signal_connect (plugin->proxy, "g-properties-changed", G_CALLBACK (thunar_tpa_on_props_changed), plugin);
 }
 
 static void
@@ -475,6 +484,62 @@ thunar_tpa_on_trash_changed (thunarTPATrash *proxy,
 
 
 
+static void
+thunar_tpa_on_props_changed (GDBusProxy *proxy,
+                             GVariant   *changed_properties,
+                             GStrv       invalidated_properties,
+                             ThunarTpa  *plugin)
+{
+  g_return_if_fail (THUNAR_IS_TPA (plugin));
+  g_return_if_fail (G_DBUS_PROXY (plugin->proxy) == proxy);
+
+  /* update the state from the new values */
+  thunar_tpa_cached_state (plugin);
+}
+
+
+
+static gboolean
+thunar_tpa_cached_state (ThunarTpa *plugin)
+{
+  GVariant *item_count;
+  GVariant *size;
+  gchar    *size_string;
+  gchar    *tooltip;
+  guint     n_items;
+
+  /* older file managers do not publish the properties */
+  item_count = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (plugin->proxy), "ItemCount");
+  if (G_UNLIKELY (item_count == NULL))
+    return FALSE;
+
+  n_items = g_variant_get_uint32 (item_count);
+  g_variant_unref (item_count);
+
+  thunar_tpa_state (plugin, n_items > 0);
+
+  /* tell the user how much the trash contains */
+  size = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (plugin->proxy), "Size");
+  if (n_items > 0 && size != NULL)
+    {
+      size_string = g_format_size (g_variant_get_uint64 (size));
+      tooltip = g_strdup_printf (ngettext ("Trash contains %u item (%s)",
+                                           "Trash contains %u items (%s)",
+                                           n_items),
+                                 n_items, size_string);
+      gtk_widget_set_tooltip_text (plugin->button, tooltip);
+      g_free (size_string);
+      g_free (tooltip);
+    }
+
+  if (size != NULL)
+    g_variant_unref (size);
+
+  return TRUE;
+}
+
+
+
 static void
 thunar_tpa_display_trash (ThunarTpa *plugin)
 {
@@ -568,8 +633,8 @@ thunar_tpa_query_trash (ThunarTpa *plugin)
 {
   g_return_if_fail (THUNAR_IS_TPA (plugin));
 
-  /* check if we are connected to the bus */
-  if (G_LIKELY (plugin->proxy != NULL))
+  /* check if we are connected to the bus and the state is not published */
+  if (G_LIKELY (plugin->proxy != NULL) && !thunar_tpa_cached_state (plugin))
     {
       /* cancel any pending call and reset the cancellable */
       g_cancellable_cancel (plugin->cancellable_query_trash);
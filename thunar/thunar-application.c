@@ -93,6 +93,18 @@ typedef ThunarJob *(*Launcher) (GList *source_path_list,
 
 
 
+/* a job waiting for or running in the job scheduler */
+typedef struct
+{
+  ThunarJob *job;
+  gchar    **filesystems;
+  gulong     cancelled_id;
+  guint      running : 1;
+  guint      paused : 1;
+} ThunarApplicationJob;
+
+
+
 /* Property identifiers */
 enum
 {
@@ -145,6 +157,14 @@ static void           thunar_application_collect_and_launch     (ThunarApplicati
                                                                  GClosure               *new_files_closure);
 static void           thunar_application_launch_finished        (ThunarJob              *job,
                                                                  ThunarView             *view);
+static void           thunar_application_schedule_job           (ThunarApplication      *application,
+                                                                 ThunarJob              *job,
+                                                                 GList                  *source_file_list,
+                                                                 GList                  *target_file_list);
+static void           thunar_application_unschedule_job         (ThunarApplication      *application,
+                                                                 GList                  *lp);
+static void           thunar_application_schedule_jobs          (ThunarApplication      *application);
+static void           thunar_application_queue_schedule         (ThunarApplication      *application);
 static void           thunar_application_launch                 (ThunarApplication      *application,
                                                                  gpointer                parent,
                                                                  const gchar            *icon_name,
@@ -153,6 +173,10 @@ static void           thunar_application_launch                 (ThunarApplicati
                                                                  GList                  *source_path_list,
                                                                  GList                  *target_path_list,
                                                                  GClosure               *new_files_closure);
+static ThunarJob     *creat_stub                                (GList                  *template_file,
+                                                                 GList                  *target_path_list);
+static ThunarJob     *mkdir_stub                                (GList                  *source_path_list,
+                                                                 GList                  *target_path_list);
 #ifdef HAVE_GUDEV
 static void           thunar_application_uevent                 (GUdevClient            *client,
                                                                  const gchar            *action,
@@ -208,6 +232,10 @@ struct _ThunarApplication
 
   GList                 *files_to_launch;
 
+  /* file operations by filesystem, see thunar_application_schedule_jobs() */
+  GList                 *scheduled_jobs;
+  guint                  schedule_idle_id;
+
   guint                  dbus_owner_id_xfce;
   guint                  dbus_owner_id_fdo;
 };
@@ -428,6 +456,14 @@ thunar_application_shutdown (GApplication *gapp)
   if (G_UNLIKELY (application->show_dialogs_timer_id != 0))
     g_source_remove (application->show_dialogs_timer_id);
 
+  /* stop scheduling file operations */
+  if (G_UNLIKELY (application->schedule_idle_id != 0))
+    g_source_remove (application->schedule_idle_id);
+
+  /* forget about queued and running file operations */
+  while (application->scheduled_jobs != NULL)
+    thunar_application_unschedule_job (application, application->scheduled_jobs);
+
   /* drop ref on the thumbnailer */
   if (application->thumbnailer != NULL)
     g_object_unref (application->thumbnailer);
@@ -798,6 +834,261 @@ thunar_application_launch_finished (ThunarJob  *job,
 
 
 
+static gchar *
+thunar_application_get_filesystem (GFile *file)
+{
+  ThunarFile *thunar_file;
+  GFileInfo  *info;
+  GFile      *parent;
+  gchar      *filesystem = NULL;
+
+  /* use the file or its closest ancestor in the file cache, so we
+   * never block the main loop on slow or unmounted devices */
+  for (file = g_object_ref (file); filesystem == NULL && file != NULL; file = parent)
+    {
+      thunar_file = thunar_file_cache_lookup (file);
+      if (thunar_file != NULL)
+        {
+          info = thunar_file_get_info (thunar_file);
+          if (G_LIKELY (info != NULL))
+            filesystem = g_strdup (g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_ID_FILESYSTEM));
+        }
+
+      parent = g_file_get_parent (file);
+      g_object_unref (file);
+    }
+
+  if (file != NULL)
+    g_object_unref (file);
+
+  return filesystem;
+}
+
+
+
+static void
+thunar_application_collect_filesystems (GPtrArray *filesystems,
+                                        GList     *file_list)
+{
+  GList *lp;
+  gchar *filesystem;
+  guint  n;
+
+  for (lp = file_list; lp != NULL; lp = lp->next)
+    {
+      filesystem = thunar_application_get_filesystem (lp->data);
+      if (filesystem == NULL)
+        continue;
+
+      /* only add every filesystem once */
+      for (n = 0; n < filesystems->len; ++n)
+        if (strcmp (g_ptr_array_index (filesystems, n), filesystem) == 0)
+          break;
+
+      if (n < filesystems->len)
+        g_free (filesystem);
+      else
+        g_ptr_array_add (filesystems, filesystem);
+    }
+}
+
+
+
+static void
+thunar_application_job_finished (ThunarJob         *job,
+                                 ThunarApplication *application)
+{
+  GList *lp;
+
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
+  _thunar_return_if_fail (THUNAR_IS_APPLICATION (application));
+
+  for (lp = application->scheduled_jobs; lp != NULL; lp = lp->next)
+    if (((ThunarApplicationJob *) lp->data)->job == job)
+      {
+        thunar_application_unschedule_job (application, lp);
+        break;
+      }
+
+  /* the filesystems of the job are free now */
+  thunar_application_queue_schedule (application);
+}
+
+
+
+static void
+thunar_application_unschedule_job (ThunarApplication *application,
+                                   GList             *lp)
+{
+  ThunarApplicationJob *scheduled = lp->data;
+
+  application->scheduled_jobs = g_list_delete_link (application->scheduled_jobs, lp);
+
+  if (scheduled->cancelled_id != 0)
+    g_signal_handler_disconnect (exo_job_get_cancellable (EXO_JOB (scheduled->job)), scheduled->cancelled_id);
+  g_signal_handlers_disconnect_by_func (scheduled->job, thunar_application_job_finished, application);
+
+  g_object_unref (scheduled->job);
+  g_strfreev (scheduled->filesystems);
+  g_slice_free (ThunarApplicationJob, scheduled);
+}
+
+
+
+static void
+thunar_application_schedule_job (ThunarApplication *application,
+                                 ThunarJob         *job,
+                                 GList             *source_file_list,
+                                 GList             *target_file_list)
+{
+  ThunarApplicationJob *scheduled;
+  GPtrArray            *filesystems;
+
+  _thunar_return_if_fail (THUNAR_IS_APPLICATION (application));
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
+
+  /* determine the filesystems the job reads from and writes to */
+  filesystems = g_ptr_array_new ();
+  thunar_application_collect_filesystems (filesystems, source_file_list);
+  thunar_application_collect_filesystems (filesystems, target_file_list);
+  g_ptr_array_add (filesystems, NULL);
+
+  scheduled = g_slice_new0 (ThunarApplicationJob);
+  scheduled->job = g_object_ref (job);
+  scheduled->filesystems = (gchar **) g_ptr_array_free (filesystems, FALSE);
+
+  /* a queued job has no thread yet, so it is cancelled from the
+   * main loop and can be launched to finish right away */
+  scheduled->cancelled_id = g_signal_connect_swapped (exo_job_get_cancellable (EXO_JOB (job)), "cancelled",
+                                                      G_CALLBACK (thunar_application_queue_schedule), application);
+
+  g_signal_connect (job, "finished", G_CALLBACK (thunar_application_job_finished), application);
+
+  application->scheduled_jobs = g_list_append (application->scheduled_jobs, scheduled);
+
+  thunar_application_queue_schedule (application);
+}
+
+
+
+static void
+thunar_application_schedule_jobs (ThunarApplication *application)
+{
+  ThunarApplicationJob *scheduled;
+  GHashTable           *n_running;
+  GHashTable           *blocked;
+  gboolean              can_run;
+  GList                *lp;
+  gchar               **fs;
+  guint                 max_jobs;
+
+  _thunar_return_if_fail (THUNAR_IS_APPLICATION (application));
+
+  g_object_get (G_OBJECT (application->preferences), "misc-jobs-per-device", &max_jobs, NULL);
+
+  /* count the running jobs on each filesystem */
+  n_running = g_hash_table_new (g_str_hash, g_str_equal);
+  for (lp = application->scheduled_jobs; lp != NULL; lp = lp->next)
+    {
+      scheduled = lp->data;
+      if (scheduled->running)
+        for (fs = scheduled->filesystems; *fs != NULL; ++fs)
+          g_hash_table_insert (n_running, *fs, GUINT_TO_POINTER (GPOINTER_TO_UINT (g_hash_table_lookup (n_running, *fs)) + 1));
+    }
+
+  /* launch the queued jobs in order, jobs on independent
+   * filesystems run in parallel */
+  blocked = g_hash_table_new (g_str_hash, g_str_equal);
+  for (lp = application->scheduled_jobs; lp != NULL; lp = lp->next)
+    {
+      scheduled = lp->data;
+      if (scheduled->running)
+        continue;
+
+      /* a cancelled job does not touch the disk, so it is launched
+       * immediately to let it finish */
+      if (!exo_job_is_cancelled (EXO_JOB (scheduled->job)))
+        {
+          if (scheduled->paused)
+            continue;
+
+          can_run = TRUE;
+          for (fs = scheduled->filesystems; max_jobs > 0 && *fs != NULL; ++fs)
+            if (GPOINTER_TO_UINT (g_hash_table_lookup (n_running, *fs)) >= max_jobs
+                || g_hash_table_lookup (blocked, *fs) != NULL)
+              can_run = FALSE;
+
+          if (!can_run)
+            {
+              /* jobs queued later must not overtake this one */
+              for (fs = scheduled->filesystems; *fs != NULL; ++fs)
+                g_hash_table_insert (blocked, *fs, *fs);
+              continue;
+            }
+        }
+
+      for (fs = scheduled->filesystems; *fs != NULL; ++fs)
+        g_hash_table_insert (n_running, *fs, GUINT_TO_POINTER (GPOINTER_TO_UINT (g_hash_table_lookup (n_running, *fs)) + 1));
+
+      /* once running, the job is cancelled from its own thread */
+      g_signal_handler_disconnect (exo_job_get_cancellable (EXO_JOB (scheduled->job)), scheduled->cancelled_id);
+      scheduled->cancelled_id = 0;
+
+      scheduled->running = TRUE;
+      exo_job_launch (EXO_JOB (scheduled->job));
+    }
+
+  g_hash_table_destroy (blocked);
+  g_hash_table_destroy (n_running);
+
+  /* show the queue in the progress dialog */
+  if (application->progress_dialog != NULL)
+    {
+      for (lp = application->scheduled_jobs; lp != NULL; lp = lp->next)
+        {
+          scheduled = lp->data;
+          thunar_progress_dialog_set_job_queued (THUNAR_PROGRESS_DIALOG (application->progress_dialog),
+                                                 scheduled->job, !scheduled->running, scheduled->paused);
+        }
+    }
+}
+
+
+
+static gboolean
+thunar_application_schedule_idle (gpointer user_data)
+{
+  thunar_application_schedule_jobs (THUNAR_APPLICATION (user_data));
+  return FALSE;
+}
+
+
+
+static void
+thunar_application_schedule_idle_destroy (gpointer user_data)
+{
+  THUNAR_APPLICATION (user_data)->schedule_idle_id = 0;
+}
+
+
+
+static void
+thunar_application_queue_schedule (ThunarApplication *application)
+{
+  _thunar_return_if_fail (THUNAR_IS_APPLICATION (application));
+
+  /* schedule from the main loop, so we never launch jobs from
+   * within signal handlers of other jobs */
+  if (application->schedule_idle_id == 0)
+    {
+      application->schedule_idle_id =
+        gdk_threads_add_idle_full (G_PRIORITY_HIGH_IDLE, thunar_application_schedule_idle,
+                                   application, thunar_application_schedule_idle_destroy);
+    }
+}
+
+
+
 static void
 thunar_application_launch (ThunarApplication *application,
                            gpointer           parent,
@@ -838,6 +1129,16 @@ thunar_application_launch (ThunarApplication *application,
   if (G_LIKELY (new_files_closure != NULL))
     g_signal_connect_closure (job, "new-files", new_files_closure, FALSE);
 
+  /* creating files, folders and links is quick and the user waits
+   * for the result, so only bulk transfer, delete and trash jobs
+   * queue up for their filesystems */
+  if (launcher == creat_stub
+      || launcher == mkdir_stub
+      || launcher == thunar_io_jobs_link_files)
+    exo_job_launch (EXO_JOB (job));
+  else
+    thunar_application_schedule_job (application, job, source_file_list, target_file_list);
+
   /* get the shared progress dialog */
   dialog = thunar_application_get_progress_dialog (application);
 
@@ -2295,6 +2596,15 @@ thunar_application_mkdir (ThunarApplication *application,
 
 
 
+static ThunarJob *
+empty_trash_stub (GList *source_file_list,
+                  GList *target_file_list)
+{
+  return thunar_io_jobs_empty_trash ();
+}
+
+
+
 /**
  * thunar_application_empty_trash:
  * @application : a #ThunarApplication.
@@ -2346,9 +2656,7 @@ thunar_application_empty_trash (ThunarApplication *application,
   /* check if the user confirmed */
   if (G_LIKELY (response == GTK_RESPONSE_YES))
     {
-      /* fake a path list with only the trash root (the root
-       * folder itself will never be unlinked, so this is safe)
-       */
+      /* the trash root is only used to schedule the job */
       file_list.data = thunar_g_file_new_for_trash ();
       file_list.next = NULL;
       file_list.prev = NULL;
@@ -2356,7 +2664,7 @@ thunar_application_empty_trash (ThunarApplication *application,
       /* launch the operation */
       thunar_application_launch (application, parent, "user-trash",
                                  _("Emptying the Trash..."),
-                                 unlink_stub, &file_list, NULL, NULL);
+                                 empty_trash_stub, &file_list, NULL, NULL);
 
       /* cleanup */
       g_object_unref (file_list.data);
@@ -2437,6 +2745,86 @@ thunar_application_restore_files (ThunarApplication *application,
 
 
 
+/**
+ * thunar_application_move_job:
+ * @application : a #ThunarApplication.
+ * @job         : a queued #ThunarJob.
+ * @up          : whether to move @job towards the front of the queue.
+ *
+ * Swaps @job with the previous or next queued job, which changes
+ * the order in which the jobs are launched.
+ **/
+void
+thunar_application_move_job (ThunarApplication *application,
+                             ThunarJob         *job,
+                             gboolean           up)
+{
+  ThunarApplicationJob *scheduled;
+  GList                *lp;
+  GList                *sibling;
+
+  _thunar_return_if_fail (THUNAR_IS_APPLICATION (application));
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
+
+  for (lp = application->scheduled_jobs; lp != NULL; lp = lp->next)
+    if (((ThunarApplicationJob *) lp->data)->job == job)
+      break;
+
+  if (lp == NULL || ((ThunarApplicationJob *) lp->data)->running)
+    return;
+
+  /* find the closest job that is still queued */
+  for (sibling = up ? lp->prev : lp->next;
+       sibling != NULL && ((ThunarApplicationJob *) sibling->data)->running;
+       sibling = up ? sibling->prev : sibling->next);
+
+  if (sibling == NULL)
+    return;
+
+  scheduled = lp->data;
+  lp->data = sibling->data;
+  sibling->data = scheduled;
+
+  thunar_application_queue_schedule (application);
+}
+
+
+
+/**
+ * thunar_application_pause_job:
+ * @application : a #ThunarApplication.
+ * @job         : a queued #ThunarJob.
+ * @paused      : whether to keep @job in the queue.
+ *
+ * A paused job is not launched, even if its filesystems are
+ * available, and does not hold back the jobs queued after it.
+ * Jobs that are already running are not affected.
+ **/
+void
+thunar_application_pause_job (ThunarApplication *application,
+                              ThunarJob         *job,
+                              gboolean           paused)
+{
+  ThunarApplicationJob *scheduled;
+  GList                *lp;
+
+  _thunar_return_if_fail (THUNAR_IS_APPLICATION (application));
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
+
+  for (lp = application->scheduled_jobs; lp != NULL; lp = lp->next)
+    {
+      scheduled = lp->data;
+      if (scheduled->job == job && !scheduled->running)
+        {
+          scheduled->paused = paused;
+          thunar_application_queue_schedule (application);
+          break;
+        }
+    }
+}
+
+
+
 ThunarThumbnailCache *
 thunar_application_get_thumbnail_cache (ThunarApplication *application)
 {
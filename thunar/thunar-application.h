@@ -23,6 +23,7 @@
 #ifndef __THUNAR_APPLICATION_H__
 #define __THUNAR_APPLICATION_H__
 
+#include <thunar/thunar-job.h>
 #include <thunar/thunar-window.h>
 #include <thunar/thunar-thumbnail-cache.h>
 
@@ -143,6 +144,14 @@ void                  thunar_application_restore_files             (ThunarApplic
                                                                     GList             *trash_file_list,
                                                                     GClosure          *new_files_closure);
 
+void                  thunar_application_move_job                  (ThunarApplication *application,
+                                                                    ThunarJob         *job,
+                                                                    gboolean           up);
+
+void                  thunar_application_pause_job                 (ThunarApplication *application,
+                                                                    ThunarJob         *job,
+                                                                    gboolean           paused);
+
 ThunarThumbnailCache *thunar_application_get_thumbnail_cache       (ThunarApplication *application);
 
 G_END_DECLS;
@@ -67,6 +67,7 @@ static void thunar_clipboard_manager_get_property       (GObject
                                                          GParamSpec                  *pspec);
 static void thunar_clipboard_manager_file_destroyed     (ThunarFile                  *file,
                                                          ThunarClipboardManager      *manager);
+static void thunar_clipboard_manager_release_files      (ThunarClipboardManager      *manager);
 static void thunar_clipboard_manager_owner_changed      (GtkClipboard                *clipboard,
                                                          GdkEventOwnerChange         *event,
                                                          ThunarClipboardManager      *manager);
@@ -105,6 +106,9 @@ struct _ThunarClipboardManager
 
   gboolean      files_cutted;
   GList        *files;
+
+  /* maps the files to their link in the files list */
+  GHashTable   *files_index;
 };
 
 typedef struct
@@ -179,6 +183,7 @@ static void
 thunar_clipboard_manager_init (ThunarClipboardManager *manager)
 {
   manager->x_special_gnome_copied_files = gdk_atom_intern_static_string ("x-special/gnome-copied-files");
+  manager->files_index = g_hash_table_new (g_direct_hash, g_direct_equal);
 }
 
 
@@ -208,15 +213,10 @@ static void
 thunar_clipboard_manager_finalize (GObject *object)
 {
   ThunarClipboardManager *manager = THUNAR_CLIPBOARD_MANAGER (object);
-  GList                  *lp;
 
   /* release any pending files */
-  for (lp = manager->files; lp != NULL; lp = lp->next)
-    {
-      g_signal_handlers_disconnect_by_func (G_OBJECT (lp->data), thunar_clipboard_manager_file_destroyed, manager);
-      g_object_unref (G_OBJECT (lp->data));
-    }
-  g_list_free (manager->files);
+  thunar_clipboard_manager_release_files (manager);
+  g_hash_table_destroy (manager->files_index);
 
   /* disconnect from the clipboard */
   g_signal_handlers_disconnect_by_func (G_OBJECT (manager->clipboard), thunar_clipboard_manager_owner_changed, manager);
@@ -254,11 +254,17 @@ static void
 thunar_clipboard_manager_file_destroyed (ThunarFile             *file,
                                          ThunarClipboardManager *manager)
 {
+  GList *lp;
+
   _thunar_return_if_fail (THUNAR_IS_CLIPBOARD_MANAGER (manager));
-  _thunar_return_if_fail (g_list_find (manager->files, file) != NULL);
+
+  /* lookup the link of the file in our list */
+  lp = g_hash_table_lookup (manager->files_index, file);
+  _thunar_return_if_fail (lp != NULL);
 
   /* remove the file from our list */
-  manager->files = g_list_remove (manager->files, file);
+  g_hash_table_remove (manager->files_index, file);
+  manager->files = g_list_delete_link (manager->files, lp);
 
   /* disconnect from the file */
   g_signal_handlers_disconnect_by_func (G_OBJECT (file), thunar_clipboard_manager_file_destroyed, manager);
@@ -497,19 +503,29 @@ thunar_clipboard_manager_clear_callback (GtkClipboard *clipboard,
                                          gpointer      user_data)
 {
   ThunarClipboardManager *manager = THUNAR_CLIPBOARD_MANAGER (user_data);
-  GList                  *lp;
 
   _thunar_return_if_fail (GTK_IS_CLIPBOARD (clipboard));
   _thunar_return_if_fail (THUNAR_IS_CLIPBOARD_MANAGER (manager));
   _thunar_return_if_fail (manager->clipboard == clipboard);
 
   /* release the pending files */
+  thunar_clipboard_manager_release_files (manager);
+}
+
+
+
+static void
+thunar_clipboard_manager_release_files (ThunarClipboardManager *manager)
+{
+  GList *lp;
+
   for (lp = manager->files; lp != NULL; lp = lp->next)
     {
       g_signal_handlers_disconnect_by_func (G_OBJECT (lp->data), thunar_clipboard_manager_file_destroyed, manager);
       g_object_unref (G_OBJECT (lp->data));
     }
   g_list_free (manager->files);
+  g_hash_table_remove_all (manager->files_index);
   manager->files = NULL;
 }
 
@@ -524,21 +540,21 @@ thunar_clipboard_manager_transfer_files (ThunarClipboardManager *manager,
   GList      *lp;
 
   /* release any pending files */
-  for (lp = manager->files; lp != NULL; lp = lp->next)
-    {
-      g_signal_handlers_disconnect_by_func (G_OBJECT (lp->data), thunar_clipboard_manager_file_destroyed, manager);
-      g_object_unref (G_OBJECT (lp->data));
-    }
-  g_list_free (manager->files);
+  thunar_clipboard_manager_release_files (manager);
 
   /* remember the transfer operation */
   manager->files_cutted = !copy;
 
   /* setup the new file list */
-  for (lp = g_list_last (files), manager->files = NULL; lp != NULL; lp = lp->prev)
+  for (lp = g_list_last (files); lp != NULL; lp = lp->prev)
     {
+      /* skip files that are listed more than once */
+      if (g_hash_table_lookup (manager->files_index, lp->data) != NULL)
+        continue;
+
       file = THUNAR_FILE (g_object_ref (G_OBJECT (lp->data)));
       manager->files = g_list_prepend (manager->files, file);
+      g_hash_table_insert (manager->files_index, file, manager->files);
       g_signal_connect (G_OBJECT (file), "destroy", G_CALLBACK (thunar_clipboard_manager_file_destroyed), manager);
     }
 
@@ -644,7 +660,7 @@ thunar_clipboard_manager_has_cutted_file (ThunarClipboardManager *manager,
   _thunar_return_val_if_fail (THUNAR_IS_CLIPBOARD_MANAGER (manager), FALSE);
   _thunar_return_val_if_fail (THUNAR_IS_FILE (file), FALSE);
 
-  return (manager->files_cutted && g_list_find (manager->files, file) != NULL);
+  return (manager->files_cutted && g_hash_table_lookup (manager->files_index, file) != NULL);
 }
 
 
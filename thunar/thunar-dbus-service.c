@@ -42,6 +42,7 @@
 #include <thunar/thunar-preferences-dialog.h>
 #include <thunar/thunar-private.h>
 #include <thunar/thunar-properties-dialog.h>
+#include <thunar/thunar-trash-monitor.h>
 #include <thunar/thunar-util.h>
 
 
@@ -77,8 +78,9 @@ static gboolean thunar_dbus_service_transfer_files              (ThunarDBusTrans
                                                                  const gchar            *display,
                                                                  const gchar            *startup_id,
                                                                  GError                **error);
-static void     thunar_dbus_service_trash_bin_changed           (ThunarDBusService      *dbus_service,
-                                                                 ThunarFile             *trash_bin);
+static void     thunar_dbus_service_trash_changed               (ThunarTrashMonitor     *trash_monitor,
+                                                                 GParamSpec             *pspec,
+                                                                 ThunarDBusService      *dbus_service);
 static gboolean thunar_dbus_service_display_chooser_dialog      (ThunarDBusFileManager  *object,
                                                                  GDBusMethodInvocation  *invocation,
                                                                  const gchar            *uri,
@@ -252,7 +254,12 @@ struct _ThunarDBusService
   ThunarDBusThunar                 *thunar;
   ThunarOrgFreedesktopFileManager1 *file_manager_fdo;
 
-  ThunarFile      *trash_bin;
+  ThunarFile         *trash_bin;
+  ThunarTrashMonitor *trash_monitor;
+
+  /* the connection we watch for reads of the trash properties */
+  GDBusConnection    *connection;
+  guint               filter_id;
 };
 
 
@@ -329,6 +336,15 @@ thunar_dbus_service_init (ThunarDBusService *dbus_service)
                             "handle-query-trash", thunar_dbus_service_query_trash,
                             NULL);
 
+  /* publish the trash state, which is kept up to date incrementally */
+  dbus_service->trash_monitor = thunar_trash_monitor_get ();
+  exo_binding_new (G_OBJECT (dbus_service->trash_monitor), "item-count",
+                   G_OBJECT (dbus_service->trash), "item-count");
+  exo_binding_new (G_OBJECT (dbus_service->trash_monitor), "size",
+                   G_OBJECT (dbus_service->trash), "size");
+  g_signal_connect (G_OBJECT (dbus_service->trash_monitor), "notify::item-count",
+                    G_CALLBACK (thunar_dbus_service_trash_changed), dbus_service);
+
   connect_signals_multiple (dbus_service->thunar, dbus_service,
                             "handle-bulk-rename", thunar_dbus_service_bulk_rename,
                             "handle-terminate", thunar_dbus_service_terminate,
@@ -356,6 +372,16 @@ thunar_dbus_service_finalize (GObject *object)
   if (dbus_service->trash_bin)
     g_object_unref (dbus_service->trash_bin);
 
+  if (dbus_service->connection != NULL)
+    {
+      g_dbus_connection_remove_filter (dbus_service->connection, dbus_service->filter_id);
+      g_object_unref (dbus_service->connection);
+    }
+
+  g_signal_handlers_disconnect_by_func (G_OBJECT (dbus_service->trash_monitor),
+                                        thunar_dbus_service_trash_changed, dbus_service);
+  g_object_unref (dbus_service->trash_monitor);
+
   (*G_OBJECT_CLASS (thunar_dbus_service_parent_class)->finalize) (object);
 }
 
@@ -373,17 +399,6 @@ thunar_dbus_service_connect_trash_bin (ThunarDBusService *dbus_service,
       /* try to connect to the trash bin */
       trash_bin_path = thunar_g_file_new_for_trash ();
       dbus_service->trash_bin = thunar_file_get (trash_bin_path, error);
-      if (G_LIKELY (dbus_service->trash_bin != NULL))
-        {
-          /* watch the trash bin for changes */
-          thunar_file_watch (dbus_service->trash_bin);
-
-          /* stay informed about changes to the trash bin */
-          g_signal_connect_swapped (G_OBJECT (dbus_service->trash_bin), "changed",
-                                    G_CALLBACK (thunar_dbus_service_trash_bin_changed),
-                                    dbus_service);
-          thunar_file_reload_idle (dbus_service->trash_bin);
-        }
       g_object_unref (trash_bin_path);
     }
 
@@ -419,12 +434,12 @@ thunar_dbus_service_parse_uri_and_display (ThunarDBusService *dbus_service,
 
 
 static void
-thunar_dbus_service_trash_bin_changed (ThunarDBusService *dbus_service,
-                                       ThunarFile        *trash_bin)
+thunar_dbus_service_trash_changed (ThunarTrashMonitor *trash_monitor,
+                                   GParamSpec         *pspec,
+                                   ThunarDBusService  *dbus_service)
 {
   _thunar_return_if_fail (THUNAR_IS_DBUS_SERVICE (dbus_service));
-  _thunar_return_if_fail (dbus_service->trash_bin == trash_bin);
-  _thunar_return_if_fail (THUNAR_IS_FILE (trash_bin));
+  _thunar_return_if_fail (dbus_service->trash_monitor == trash_monitor);
 
   /* emit the "trash-changed" signal with the new state */
   thunar_dbus_trash_emit_trash_changed (dbus_service->trash);
@@ -890,22 +905,60 @@ thunar_dbus_service_query_trash (ThunarDBusTrash        *object,
                                  GDBusMethodInvocation  *invocation,
                                  ThunarDBusService      *dbus_service)
 {
-  GError *error = NULL;
-  gboolean full = FALSE;
+  gboolean full;
 
-  /* connect to the trash bin on-demand */
-  if (thunar_dbus_service_connect_trash_bin (dbus_service, &error))
+  /* check whether the trash bin is not empty, without scanning it */
+  full = (thunar_trash_monitor_get_item_count (dbus_service->trash_monitor) > 0);
+  thunar_dbus_trash_complete_query_trash (object, invocation, full);
+
+  return TRUE;
+}
+
+
+
+static gboolean
+thunar_dbus_service_measure_trash (gpointer user_data)
+{
+  thunar_trash_monitor_start_measuring (THUNAR_TRASH_MONITOR (user_data));
+  return FALSE;
+}
+
+
+
+static GDBusMessage *
+thunar_dbus_service_filter (GDBusConnection *connection,
+                            GDBusMessage    *message,
+                            gboolean         incoming,
+                            gpointer         user_data)
+{
+  static volatile gint  measuring = 0;
+  const gchar          *interface_name;
+  GVariant             *body;
+
+  /* this runs in the GDBus worker thread */
+  if (!incoming
+      || g_atomic_int_get (&measuring) != 0
+      || g_dbus_message_get_message_type (message) != G_DBUS_MESSAGE_TYPE_METHOD_CALL
+      || g_strcmp0 (g_dbus_message_get_interface (message), "org.freedesktop.DBus.Properties") != 0
+      || g_strcmp0 (g_dbus_message_get_path (message), "/org/xfce/FileManager") != 0)
+    return message;
+
+  /* the trash is only measured once a client reads its properties */
+  body = g_dbus_message_get_body (message);
+  if (body != NULL
+      && (g_variant_is_of_type (body, G_VARIANT_TYPE ("(s)"))
+          || g_variant_is_of_type (body, G_VARIANT_TYPE ("(ss)"))))
     {
-      /* check whether the trash bin is not empty */
-      full = (thunar_file_get_item_count (dbus_service->trash_bin) > 0);
+      g_variant_get_child (body, 0, "&s", &interface_name);
+      if (strcmp (interface_name, "org.xfce.Trash") == 0
+          && g_atomic_int_compare_and_exchange (&measuring, 0, 1))
+        {
+          g_idle_add_full (G_PRIORITY_DEFAULT_IDLE, thunar_dbus_service_measure_trash,
+                           g_object_ref (user_data), g_object_unref);
+        }
     }
 
-  if (error)
-    g_dbus_method_invocation_take_error (invocation, error);
-  else
-    thunar_dbus_trash_complete_query_trash (object, invocation, full);
-
-  return TRUE;
+  return message;
 }
 
 
@@ -1667,6 +1720,15 @@ gboolean thunar_dbus_service_export_on_connection (ThunarDBusService *service,
                                          error))
     goto fail;
 
+  /* start measuring the trash on the first read of its size */
+  if (service->connection == NULL)
+    {
+      service->connection = g_object_ref (connection);
+      service->filter_id = g_dbus_connection_add_filter (connection, thunar_dbus_service_filter,
+                                                         g_object_ref (service->trash_monitor),
+                                                         g_object_unref);
+    }
+
   return TRUE;
 
 fail:
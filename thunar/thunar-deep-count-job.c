@@ -35,6 +35,16 @@
 
 
 
+#if GLIB_CHECK_VERSION (2, 32, 0)
+#define _deep_count_lock(job)   g_mutex_lock (&((job)->lock))
+#define _deep_count_unlock(job) g_mutex_unlock (&((job)->lock))
+#else
+#define _deep_count_lock(job)   g_mutex_lock ((job)->lock)
+#define _deep_count_unlock(job) g_mutex_unlock ((job)->lock)
+#endif
+
+
+
 /* Signal identifiers */
 enum
 {
@@ -46,8 +56,17 @@ enum
 #define DEEP_COUNT_FILE_INFO_NAMESPACE \
   G_FILE_ATTRIBUTE_STANDARD_TYPE "," \
   G_FILE_ATTRIBUTE_STANDARD_SIZE "," \
+  G_FILE_ATTRIBUTE_STANDARD_ALLOCATED_SIZE "," \
   G_FILE_ATTRIBUTE_ID_FILESYSTEM
 
+/* number of directories read concurrently, most of the time is
+ * spent waiting for the file system */
+#define DEEP_COUNT_MAX_THREADS (8)
+
+
+
+typedef struct _ThunarDeepCountTask ThunarDeepCountTask;
+
 static void     thunar_deep_count_job_finalize   (GObject                 *object);
 static gboolean thunar_deep_count_job_execute    (ExoJob                  *job,
                                                   GError                 **error);
@@ -73,14 +92,34 @@ struct _ThunarDeepCountJob
   GList              *files;
   GFileQueryInfoFlags query_flags;
 
-  /* the time of the last "status-update" emission */
-  gint64              last_time;
+  /* the directories being counted, see thunar_deep_count_job_execute() */
+  GThreadPool        *pool;
+  GAsyncQueue        *done;
+  volatile gint       n_tasks;
 
-  /* status information */
+  /* status information, protected by lock */
   guint64             total_size;
+  guint64             allocated_size;
   guint               file_count;
   guint               directory_count;
   guint               unreadable_directory_count;
+  GError             *error;
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  GMutex              lock;
+#else
+  GMutex             *lock;
+#endif
+
+  /* whether the counters are final */
+  gboolean            completed;
+};
+
+/* a directory queued for one of the workers */
+struct _ThunarDeepCountTask
+{
+  GFile   *file;
+  gchar   *fs_id;
+  gboolean toplevel;
 };
 
 
@@ -136,6 +175,12 @@ static void
 thunar_deep_count_job_init (ThunarDeepCountJob *job)
 {
   job->query_flags = G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS;
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  g_mutex_init (&job->lock);
+#else
+  job->lock = g_mutex_new ();
+#endif
 }
 
 
@@ -147,191 +192,253 @@ thunar_deep_count_job_finalize (GObject *object)
 
   g_list_free_full (job->files, g_object_unref);
 
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  g_mutex_clear (&job->lock);
+#else
+  g_mutex_free (job->lock);
+#endif
+
   (*G_OBJECT_CLASS (thunar_deep_count_job_parent_class)->finalize) (object);
 }
 
 
 
+static guint64
+thunar_deep_count_job_get_allocated_size (GFileInfo *info)
+{
+  /* not every backend knows the space used on disk */
+  if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_ALLOCATED_SIZE))
+    return g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_STANDARD_ALLOCATED_SIZE);
+
+  return g_file_info_get_size (info);
+}
+
+
+
 static void
 thunar_deep_count_job_status_update (ThunarDeepCountJob *job)
 {
+  guint64 total_size;
+  guint   file_count;
+  guint   directory_count;
+  guint   unreadable_directory_count;
+
   _thunar_return_if_fail (THUNAR_IS_DEEP_COUNT_JOB (job));
 
+  /* take a consistent snapshot of the counters */
+  _deep_count_lock (job);
+  total_size = job->total_size;
+  file_count = job->file_count;
+  directory_count = job->directory_count;
+  unreadable_directory_count = job->unreadable_directory_count;
+  _deep_count_unlock (job);
+
   exo_job_emit (EXO_JOB (job),
                 deep_count_signals[STATUS_UPDATE],
                 0,
-                job->total_size,
-                job->file_count,
-                job->directory_count,
-                job->unreadable_directory_count);
+                total_size,
+                file_count,
+                directory_count,
+                unreadable_directory_count);
 }
 
 
 
-static gboolean
-thunar_deep_count_job_process (ExoJob       *job,
-                               GFile        *file,
-                               GFileInfo    *file_info,
-                               const gchar  *toplevel_fs_id,
-                               GError      **error)
+static void
+thunar_deep_count_job_task_done (ThunarDeepCountJob *count_job)
 {
-  ThunarDeepCountJob *count_job = THUNAR_DEEP_COUNT_JOB (job);
-  GFileEnumerator    *enumerator;
-  GFileInfo          *child_info;
-  GFileInfo          *info;
-  gboolean            success = TRUE;
-  GFile              *child;
-  gint64              real_time;
-  const gchar        *fs_id;
-  gboolean            toplevel_file = (toplevel_fs_id == NULL);
-
-  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
-  _thunar_return_val_if_fail (G_IS_FILE (file), FALSE);
-  _thunar_return_val_if_fail (file_info == NULL || G_IS_FILE_INFO (file_info), FALSE);
-  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+  /* wake up the job thread once all directories are counted */
+  if (g_atomic_int_dec_and_test (&count_job->n_tasks))
+    g_async_queue_push (count_job->done, count_job);
+}
 
-  /* abort if job was already cancelled */
-  if (exo_job_is_cancelled (job))
-    return FALSE;
 
-  if (file_info != NULL)
-    {
-      /* use the enumerator info */
-      info = g_object_ref (file_info);
-    }
-  else
-    {
-      /* query size and type of the current file */
-      info = g_file_query_info (file,
-                                DEEP_COUNT_FILE_INFO_NAMESPACE,
-                                count_job->query_flags,
-                                exo_job_get_cancellable (job),
-                                error);
-    }
 
-  /* abort on invalid info or cancellation */
-  if (info == NULL)
-    return FALSE;
+static void
+thunar_deep_count_job_push (ThunarDeepCountJob *count_job,
+                            GFile              *file,
+                            const gchar        *fs_id,
+                            gboolean            toplevel)
+{
+  ThunarDeepCountTask *task;
 
-  /* abort on cancellation */
-  if (exo_job_is_cancelled (job))
-    {
-      g_object_unref (info);
-      return FALSE;
-    }
+  task = g_slice_new (ThunarDeepCountTask);
+  task->file = g_object_ref (file);
+  task->fs_id = g_strdup (fs_id);
+  task->toplevel = toplevel;
 
-  /* only check files on the same filesystem so no remote mounts or
-   * dummy filesystems are counted */
-  fs_id = g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_ID_FILESYSTEM);
-  if (fs_id == NULL)
-    fs_id = "";
+  /* any idle worker picks up the directory */
+  g_atomic_int_inc (&count_job->n_tasks);
+  g_thread_pool_push (count_job->pool, task, NULL);
+}
 
-  if (toplevel_fs_id == NULL)
-    {
-      /* first toplevel, so use this id */
-      toplevel_fs_id = fs_id;
-    }
-  else if (strcmp (fs_id, toplevel_fs_id) != 0)
-    {
-      /* release the file info */
-      g_object_unref (info);
 
-      /* other filesystem, continue */
-      return TRUE;
-    }
 
-  /* recurse if we have a directory */
-  if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+static void
+thunar_deep_count_job_count_directory (gpointer data,
+                                       gpointer user_data)
+{
+  ThunarDeepCountTask *task = data;
+  ThunarDeepCountJob  *count_job = THUNAR_DEEP_COUNT_JOB (user_data);
+  GFileEnumerator     *enumerator;
+  GFileInfo           *child_info;
+  GError              *err = NULL;
+  GFile               *child;
+  ExoJob              *job = EXO_JOB (count_job);
+  const gchar         *fs_id;
+  guint64              total_size = 0;
+  guint64              allocated_size = 0;
+  guint                file_count = 0;
+  guint                directory_count = 0;
+  guint                unreadable_directory_count = 0;
+
+  /* this runs in a worker thread, counting into local counters first */
+  if (!exo_job_is_cancelled (job))
     {
       /* try to read from the directory */
-      enumerator = g_file_enumerate_children (file,
+      enumerator = g_file_enumerate_children (task->file,
                                               DEEP_COUNT_FILE_INFO_NAMESPACE ","
                                               G_FILE_ATTRIBUTE_STANDARD_NAME,
                                               count_job->query_flags,
                                               exo_job_get_cancellable (job),
-                                              error);
+                                              &err);
 
-      if (!exo_job_is_cancelled (job))
+      if (enumerator == NULL)
         {
-          if (enumerator == NULL)
+          if (!exo_job_is_cancelled (job))
             {
               /* directory was unreadable */
-              count_job->unreadable_directory_count++;
+              unreadable_directory_count++;
 
-              if (toplevel_file
-                  && g_list_length (count_job->files) < 2)
-                {
-                  /* we only bail out if the job file is unreadable */
-                  success = FALSE;
-                }
-              else
+              /* we only bail out if the job file is unreadable */
+              if (task->toplevel && g_list_length (count_job->files) < 2)
                 {
-                  /* ignore errors from files other than the job file */
-                  g_clear_error (error);
+                  _deep_count_lock (count_job);
+                  if (count_job->error == NULL)
+                    count_job->error = g_error_copy (err);
+                  _deep_count_unlock (count_job);
                 }
             }
-          else
-            {
-              /* directory was readable */
-              count_job->directory_count++;
 
-              while (!exo_job_is_cancelled (job))
-                {
-                  /* query next child info */
-                  child_info = g_file_enumerator_next_file (enumerator,
-                                                            exo_job_get_cancellable (job),
-                                                            error);
+          g_clear_error (&err);
+        }
+      else
+        {
+          /* directory was readable */
+          directory_count++;
 
-                  /* abort on invalid child info (iteration ends) or cancellation */
-                  if (child_info == NULL)
-                    break;
+          while (!exo_job_is_cancelled (job))
+            {
+              /* query next child info */
+              child_info = g_file_enumerator_next_file (enumerator,
+                                                        exo_job_get_cancellable (job),
+                                                        NULL);
+
+              /* abort on invalid child info (iteration ends) */
+              if (child_info == NULL)
+                break;
+
+              /* only check files on the same filesystem so no remote mounts or
+               * dummy filesystems are counted */
+              fs_id = g_file_info_get_attribute_string (child_info, G_FILE_ATTRIBUTE_ID_FILESYSTEM);
+              if (fs_id == NULL)
+                fs_id = "";
+
+              if (strcmp (fs_id, task->fs_id) == 0)
+                {
+                  /* directories take up space on disk too */
+                  allocated_size += thunar_deep_count_job_get_allocated_size (child_info);
 
-                  if (!exo_job_is_cancelled (job))
+                  if (g_file_info_get_file_type (child_info) == G_FILE_TYPE_DIRECTORY)
                     {
-                      /* generate a GFile for the child */
-                      child = g_file_resolve_relative_path (file, g_file_info_get_name (child_info));
-
-                      /* recurse unless the job was cancelled before */
-                      thunar_deep_count_job_process (job, child, child_info, toplevel_fs_id, error);
-
-                      /* free resources */
+                      /* count the subdirectory in parallel */
+                      child = g_file_resolve_relative_path (task->file, g_file_info_get_name (child_info));
+                      thunar_deep_count_job_push (count_job, child, task->fs_id, FALSE);
                       g_object_unref (child);
                     }
-
-                  g_object_unref (child_info);
+                  else
+                    {
+                      /* we have a regular file or at least not a directory */
+                      file_count++;
+                      total_size += g_file_info_get_size (child_info);
+                    }
                 }
-            }
-        }
 
-      /* destroy the enumerator */
-      if (enumerator != NULL)
-        g_object_unref (enumerator);
+              g_object_unref (child_info);
+            }
 
-      /* emit status update whenever we've finished a directory,
-       * but not more than four times per second */
-      real_time = g_get_real_time ();
-      if (real_time >= count_job->last_time)
-        {
-          if (count_job->last_time != 0)
-            thunar_deep_count_job_status_update (count_job);
-          count_job->last_time = real_time + (G_USEC_PER_SEC / 4);
+          g_object_unref (enumerator);
         }
     }
-  else
+
+  /* merge the counters of this directory */
+  _deep_count_lock (count_job);
+  count_job->total_size += total_size;
+  count_job->allocated_size += allocated_size;
+  count_job->file_count += file_count;
+  count_job->directory_count += directory_count;
+  count_job->unreadable_directory_count += unreadable_directory_count;
+  _deep_count_unlock (count_job);
+
+  g_object_unref (task->file);
+  g_free (task->fs_id);
+  g_slice_free (ThunarDeepCountTask, task);
+
+  thunar_deep_count_job_task_done (count_job);
+}
+
+
+
+static gboolean
+thunar_deep_count_job_process (ExoJob       *job,
+                               GFile        *file,
+                               GError      **error)
+{
+  ThunarDeepCountJob *count_job = THUNAR_DEEP_COUNT_JOB (job);
+  GFileInfo          *info;
+  const gchar        *fs_id;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (file), FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  /* abort if job was already cancelled */
+  if (exo_job_is_cancelled (job))
+    return FALSE;
+
+  /* query size and type of the job file */
+  info = g_file_query_info (file,
+                            DEEP_COUNT_FILE_INFO_NAMESPACE,
+                            count_job->query_flags,
+                            exo_job_get_cancellable (job),
+                            error);
+
+  /* abort on invalid info or cancellation */
+  if (info == NULL)
+    return FALSE;
+
+  /* the filesystem the contents are restricted to */
+  fs_id = g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_ID_FILESYSTEM);
+  if (fs_id == NULL)
+    fs_id = "";
+
+  _deep_count_lock (count_job);
+  count_job->allocated_size += thunar_deep_count_job_get_allocated_size (info);
+  if (g_file_info_get_file_type (info) != G_FILE_TYPE_DIRECTORY)
     {
-      /* we have a regular file or at least not a directory */
       count_job->file_count++;
-
-      /* add size of the file to the total size */
       count_job->total_size += g_file_info_get_size (info);
     }
+  _deep_count_unlock (count_job);
+
+  /* let the workers count the directory */
+  if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+    thunar_deep_count_job_push (count_job, file, fs_id, TRUE);
 
   /* destroy the file info */
   g_object_unref (info);
 
-  /* we've succeeded if there was no error when loading information
-   * about the job file itself and the job was not cancelled */
-  return !exo_job_is_cancelled (job) && success;
+  return !exo_job_is_cancelled (job);
 }
 
 
@@ -345,6 +452,10 @@ thunar_deep_count_job_execute (ExoJob  *job,
   GError             *err = NULL;
   GList              *lp;
   GFile              *gfile;
+  gpointer            done;
+#if !GLIB_CHECK_VERSION (2, 32, 0)
+  GTimeVal            end_time;
+#endif
 
   _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
   _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
@@ -355,20 +466,67 @@ thunar_deep_count_job_execute (ExoJob  *job,
 
   /* reset counters */
   count_job->total_size = 0;
+  count_job->allocated_size = 0;
   count_job->file_count = 0;
   count_job->directory_count = 0;
   count_job->unreadable_directory_count = 0;
-  count_job->last_time = 0;
+  count_job->error = NULL;
+  count_job->completed = FALSE;
+
+  /* the extra task is dropped once all job files are queued */
+  count_job->n_tasks = 1;
+  count_job->done = g_async_queue_new ();
+  count_job->pool = g_thread_pool_new (thunar_deep_count_job_count_directory, count_job,
+                                       DEEP_COUNT_MAX_THREADS, FALSE, NULL);
 
   /* count files, directories and compute size of the job files */
   for (lp = count_job->files; lp != NULL; lp = lp->next)
     {
       gfile = thunar_file_get_file (THUNAR_FILE (lp->data));
-      success = thunar_deep_count_job_process (job, gfile, NULL, NULL, &err);
+      success = thunar_deep_count_job_process (job, gfile, &err);
       if (G_UNLIKELY (!success))
         break;
     }
 
+  thunar_deep_count_job_task_done (count_job);
+
+  /* wait for the workers and emit status updates, but not more than
+   * four times per second */
+  for (;;)
+    {
+#if GLIB_CHECK_VERSION (2, 32, 0)
+      done = g_async_queue_timeout_pop (count_job->done, G_USEC_PER_SEC / 4);
+#else
+      g_get_current_time (&end_time);
+      g_time_val_add (&end_time, G_USEC_PER_SEC / 4);
+      done = g_async_queue_timed_pop (count_job->done, &end_time);
+#endif
+
+      if (done != NULL)
+        break;
+
+      if (!exo_job_is_cancelled (job))
+        thunar_deep_count_job_status_update (count_job);
+    }
+
+  /* the workers are all idle at this point */
+  g_thread_pool_free (count_job->pool, FALSE, TRUE);
+  g_async_queue_unref (count_job->done);
+  count_job->pool = NULL;
+  count_job->done = NULL;
+
+  /* an unreadable job file fails the job */
+  if (success && count_job->error != NULL)
+    {
+      success = FALSE;
+      err = count_job->error;
+    }
+  else if (count_job->error != NULL)
+    {
+      g_error_free (count_job->error);
+    }
+  count_job->error = NULL;
+
   if (!success)
     {
       g_assert (err != NULL || exo_job_is_cancelled (job));
@@ -390,6 +548,7 @@ thunar_deep_count_job_execute (ExoJob  *job,
     {
       /* emit final status update at the very end of the computation */
       thunar_deep_count_job_status_update (count_job);
+      count_job->completed = TRUE;
     }
 
   return success;
@@ -413,3 +572,50 @@ thunar_deep_count_job_new (GList               *files,
 
   return job;
 }
+
+
+
+/**
+ * thunar_deep_count_job_get_result:
+ * @job                        : a #ThunarDeepCountJob.
+ * @total_size                 : return location for the total size or %NULL.
+ * @allocated_size             : return location for the space used on disk or %NULL.
+ * @file_count                 : return location for the number of files or %NULL.
+ * @directory_count            : return location for the number of directories or %NULL.
+ * @unreadable_directory_count : return location for the number of unreadable
+ *                               directories or %NULL.
+ *
+ * Returns the final counters of @job, once it is finished. Unlike
+ * @total_size, @allocated_size includes the directories themselves.
+ *
+ * Return value: %TRUE if @job counted all files, %FALSE if it failed,
+ *               was cancelled or is still running.
+ **/
+gboolean
+thunar_deep_count_job_get_result (ThunarDeepCountJob *job,
+                                  guint64            *total_size,
+                                  guint64            *allocated_size,
+                                  guint              *file_count,
+                                  guint              *directory_count,
+                                  guint              *unreadable_directory_count)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_DEEP_COUNT_JOB (job), FALSE);
+
+  if (!job->completed)
+    return FALSE;
+
+  _deep_count_lock (job);
+  if (total_size != NULL)
+    *total_size = job->total_size;
+  if (allocated_size != NULL)
+    *allocated_size = job->allocated_size;
+  if (file_count != NULL)
+    *file_count = job->file_count;
+  if (directory_count != NULL)
+    *directory_count = job->directory_count;
+  if (unreadable_directory_count != NULL)
+    *unreadable_directory_count = job->unreadable_directory_count;
+  _deep_count_unlock (job);
+
+  return TRUE;
+}
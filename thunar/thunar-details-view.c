@@ -282,7 +282,7 @@ G_GNUC_END_IGNORE_DEPRECATIONS
       else
         {
           /* size is right aligned, everything else is left aligned */
-          renderer = (column == THUNAR_COLUMN_SIZE || column == THUNAR_COLUMN_SIZE_IN_BYTES) ? right_aligned_renderer : left_aligned_renderer;
+          renderer = (column == THUNAR_COLUMN_SIZE || column == THUNAR_COLUMN_SIZE_IN_BYTES || column == THUNAR_COLUMN_RECURSIVE_SIZE) ? right_aligned_renderer : left_aligned_renderer;
 
           /* add the renderer */
           gtk_tree_view_column_pack_start (details_view->columns[column], renderer, TRUE);
@@ -98,19 +98,20 @@ thunar_column_get_type (void)
     {
       static const GEnumValue values[] =
       {
-        { THUNAR_COLUMN_DATE_ACCESSED, "THUNAR_COLUMN_DATE_ACCESSED", N_ ("Date Accessed"), },
-        { THUNAR_COLUMN_DATE_MODIFIED, "THUNAR_COLUMN_DATE_MODIFIED", N_ ("Date Modified"), },
-        { THUNAR_COLUMN_GROUP,         "THUNAR_COLUMN_GROUP",         N_ ("Group"),         },
-        { THUNAR_COLUMN_MIME_TYPE,     "THUNAR_COLUMN_MIME_TYPE",     N_ ("MIME Type"),     },
-        { THUNAR_COLUMN_NAME,          "THUNAR_COLUMN_NAME",          N_ ("Name"),          },
-        { THUNAR_COLUMN_OWNER,         "THUNAR_COLUMN_OWNER",         N_ ("Owner"),         },
-        { THUNAR_COLUMN_PERMISSIONS,   "THUNAR_COLUMN_PERMISSIONS",   N_ ("Permissions"),   },
-        { THUNAR_COLUMN_SIZE,          "THUNAR_COLUMN_SIZE",          N_ ("Size"),          },
-        { THUNAR_COLUMN_SIZE_IN_BYTES, "THUNAR_COLUMN_SIZE_IN_BYTES", N_ ("Size in Bytes"), },
-        { THUNAR_COLUMN_TYPE,          "THUNAR_COLUMN_TYPE",          N_ ("Type"),          },
-        { THUNAR_COLUMN_FILE,          "THUNAR_COLUMN_FILE",          N_ ("File"),          },
-        { THUNAR_COLUMN_FILE_NAME,     "THUNAR_COLUMN_FILE_NAME",     N_ ("File Name"),     },
-        { 0,                           NULL,                          NULL,                 },
+        { THUNAR_COLUMN_DATE_ACCESSED,  "THUNAR_COLUMN_DATE_ACCESSED",  N_ ("Date Accessed"),  },
+        { THUNAR_COLUMN_DATE_MODIFIED,  "THUNAR_COLUMN_DATE_MODIFIED",  N_ ("Date Modified"),  },
+        { THUNAR_COLUMN_GROUP,          "THUNAR_COLUMN_GROUP",          N_ ("Group"),          },
+        { THUNAR_COLUMN_MIME_TYPE,      "THUNAR_COLUMN_MIME_TYPE",      N_ ("MIME Type"),      },
+        { THUNAR_COLUMN_NAME,           "THUNAR_COLUMN_NAME",           N_ ("Name"),           },
+        { THUNAR_COLUMN_OWNER,          "THUNAR_COLUMN_OWNER",          N_ ("Owner"),          },
+        { THUNAR_COLUMN_PERMISSIONS,    "THUNAR_COLUMN_PERMISSIONS",    N_ ("Permissions"),    },
+        { THUNAR_COLUMN_SIZE,           "THUNAR_COLUMN_SIZE",           N_ ("Size"),           },
+        { THUNAR_COLUMN_SIZE_IN_BYTES,  "THUNAR_COLUMN_SIZE_IN_BYTES",  N_ ("Size in Bytes"),  },
+        { THUNAR_COLUMN_TYPE,           "THUNAR_COLUMN_TYPE",           N_ ("Type"),           },
+        { THUNAR_COLUMN_RECURSIVE_SIZE, "THUNAR_COLUMN_RECURSIVE_SIZE", N_ ("Size on Disk"),   },
+        { THUNAR_COLUMN_FILE,           "THUNAR_COLUMN_FILE",           N_ ("File"),           },
+        { THUNAR_COLUMN_FILE_NAME,      "THUNAR_COLUMN_FILE_NAME",      N_ ("File Name"),      },
+        { 0,                            NULL,                           NULL,                  },
       };
 
       type = g_enum_register_static (I_("ThunarColumn"), values);
@@ -75,18 +75,19 @@ GType thunar_date_style_get_type (void) G_GNUC_CONST;
 
 /**
  * ThunarColumn:
- * @THUNAR_COLUMN_DATE_ACCESSED : last access time.
- * @THUNAR_COLUMN_DATE_MODIFIED : last modification time.
- * @THUNAR_COLUMN_GROUP         : group's name.
- * @THUNAR_COLUMN_MIME_TYPE     : mime type (e.g. "text/plain").
- * @THUNAR_COLUMN_NAME          : display name.
- * @THUNAR_COLUMN_OWNER         : owner's name.
- * @THUNAR_COLUMN_PERMISSIONS   : permissions bits.
- * @THUNAR_COLUMN_SIZE          : file size.
- * @THUNAR_COLUMN_SIZE_IN_BYTES : file size in bytes.
- * @THUNAR_COLUMN_TYPE          : file type (e.g. 'plain text document').
- * @THUNAR_COLUMN_FILE          : #ThunarFile object.
- * @THUNAR_COLUMN_FILE_NAME     : real file name.
+ * @THUNAR_COLUMN_DATE_ACCESSED  : last access time.
+ * @THUNAR_COLUMN_DATE_MODIFIED  : last modification time.
+ * @THUNAR_COLUMN_GROUP          : group's name.
+ * @THUNAR_COLUMN_MIME_TYPE      : mime type (e.g. "text/plain").
+ * @THUNAR_COLUMN_NAME           : display name.
+ * @THUNAR_COLUMN_OWNER          : owner's name.
+ * @THUNAR_COLUMN_PERMISSIONS    : permissions bits.
+ * @THUNAR_COLUMN_SIZE           : file size.
+ * @THUNAR_COLUMN_SIZE_IN_BYTES  : file size in bytes.
+ * @THUNAR_COLUMN_TYPE           : file type (e.g. 'plain text document').
+ * @THUNAR_COLUMN_RECURSIVE_SIZE : space used on disk, including the contents of directories.
+ * @THUNAR_COLUMN_FILE           : #ThunarFile object.
+ * @THUNAR_COLUMN_FILE_NAME      : real file name.
  *
  * Columns exported by #ThunarListModel using the #GtkTreeModel
  * interface.
@@ -104,6 +105,7 @@ typedef enum
   THUNAR_COLUMN_SIZE,
   THUNAR_COLUMN_SIZE_IN_BYTES,
   THUNAR_COLUMN_TYPE,
+  THUNAR_COLUMN_RECURSIVE_SIZE,
 
   /* special internal columns */
   THUNAR_COLUMN_FILE,
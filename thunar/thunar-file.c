@@ -1199,7 +1199,7 @@ thunar_file_load (ThunarFile   *file,
 
   /* query a new file info */
   file->info = g_file_query_info (file->gfile,
-                                  THUNARX_FILE_INFO_NAMESPACE,
+                                  THUNAR_FILE_INFO_NAMESPACE,
                                   G_FILE_QUERY_INFO_NONE,
                                   cancellable, &err);
 
@@ -1430,7 +1430,7 @@ thunar_file_get_async (GFile            *location,
 
       /* load the file information asynchronously */
       g_file_query_info_async (location,
-                               THUNARX_FILE_INFO_NAMESPACE,
+                               THUNAR_FILE_INFO_NAMESPACE,
                                G_FILE_QUERY_INFO_NONE,
                                G_PRIORITY_DEFAULT,
                                cancellable,
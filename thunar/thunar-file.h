@@ -41,6 +41,13 @@ typedef struct _ThunarFile      ThunarFile;
 #define THUNAR_IS_FILE_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), THUNAR_TYPE_FILE))
 #define THUNAR_FILE_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), THUNAR_TYPE_FILE, ThunarFileClass))
 
+/* the attributes queried for a #ThunarFile: the public namespace of
+ * the extension API, plus what the #ThunarSizeCache needs */
+#define THUNAR_FILE_INFO_NAMESPACE \
+  THUNARX_FILE_INFO_NAMESPACE "," \
+  "standard::allocated-size," \
+  "unix::device,unix::inode"
+
 /**
  * ThunarFileDateType:
  * @THUNAR_FILE_DATE_ACCESSED : date of last access to the file.
@@ -673,7 +673,7 @@ thunar_file_infos_equal (ThunarFile *file,
   gchar      *bname;
 
   attrs = g_file_info_list_attributes (info1, NULL);
-  info2 = g_file_query_info (event_file, THUNARX_FILE_INFO_NAMESPACE,
+  info2 = g_file_query_info (event_file, THUNAR_FILE_INFO_NAMESPACE,
                              G_FILE_QUERY_INFO_NONE, NULL, NULL);
 
   if (info1 != NULL && info2 != NULL)
@@ -26,10 +26,16 @@
 #ifdef HAVE_MEMORY_H
 #include <memory.h>
 #endif
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
 #ifdef HAVE_STRING_H
 #include <string.h>
 #endif
 
+#include <glib/gstdio.h>
+#include <libxfce4util/libxfce4util.h>
+
 #include <thunar/thunar-gobject-extensions.h>
 #include <thunar/thunar-icon-factory.h>
 #include <thunar/thunar-preferences.h>
@@ -38,8 +44,17 @@
 
 
 
-/* the timeout until the sweeper is run (in seconds) */
-#define THUNAR_ICON_FACTORY_SWEEP_TIMEOUT (30)
+/* the timeout until the prewarm list is saved (in seconds) */
+#define THUNAR_ICON_FACTORY_SAVE_TIMEOUT (30)
+
+/* the maximum size of the pixel data held by the icon cache (in bytes) */
+#define THUNAR_ICON_FACTORY_CACHE_BUDGET (16 * 1024 * 1024)
+
+/* the maximum number of icons looked at for eviction per insert */
+#define THUNAR_ICON_FACTORY_EVICT_SCAN (32)
+
+/* the maximum number of icons loaded ahead of the first paint */
+#define THUNAR_ICON_FACTORY_PREWARM_MAX (64)
 
 
 
@@ -51,11 +66,15 @@ enum
   PROP_THUMBNAIL_MODE,
   PROP_THUMBNAIL_DRAW_FRAMES,
   PROP_THUMBNAIL_SIZE,
+  PROP_DISK_CACHE,
+  PROP_CACHE_SIZE,
+  PROP_CACHE_HIT_RATIO,
 };
 
 
 
-typedef struct _ThunarIconKey ThunarIconKey;
+typedef struct _ThunarIconKey       ThunarIconKey;
+typedef struct _ThunarIconDiskEntry ThunarIconDiskEntry;
 
 
 
@@ -73,8 +92,8 @@ static gboolean   thunar_icon_factory_changed               (GSignalInvocationHi
                                                              guint                     n_param_values,
                                                              const GValue             *param_values,
                                                              gpointer                  user_data);
-static gboolean   thunar_icon_factory_sweep_timer           (gpointer                  user_data);
-static void       thunar_icon_factory_sweep_timer_destroy   (gpointer                  user_data);
+static gboolean   thunar_icon_factory_save_timer            (gpointer                  user_data);
+static void       thunar_icon_factory_save_timer_destroy    (gpointer                  user_data);
 static GdkPixbuf *thunar_icon_factory_load_from_file        (ThunarIconFactory        *factory,
                                                              const gchar              *path,
                                                              gint                      size);
@@ -88,6 +107,9 @@ static gboolean   thunar_icon_key_equal                     (gconstpointer
 static void       thunar_icon_key_free                      (gpointer                  data);
 static GdkPixbuf *thunar_icon_factory_load_fallback         (ThunarIconFactory        *factory,
                                                              gint                      size);
+static gboolean   thunar_icon_factory_prewarm               (gpointer                  user_data);
+static void       thunar_icon_factory_save_prewarm_list     (ThunarIconFactory        *factory);
+static void       thunar_icon_disk_entry_free               (gpointer                  data);
 
 
 
@@ -102,7 +124,13 @@ struct _ThunarIconFactory
 
   ThunarPreferences   *preferences;
 
+  /* the icon cache, the most recently used icons are at the head of the
+   * queue and the total size of their pixel data is kept in cache_size */
   GHashTable          *icon_cache;
+  GQueue               icon_lru;
+  gsize                cache_size;
+  guint                cache_hits;
+  guint                cache_misses;
 
   GtkIconTheme        *icon_theme;
 
@@ -112,18 +140,44 @@ struct _ThunarIconFactory
 
   ThunarThumbnailSize  thumbnail_size;
 
-  guint                sweep_timer_id;
+  guint                save_timer_id;
 
   gulong               changed_hook_id;
 
   /* stamp that gets bumped when the theme changes */
   guint                theme_stamp;
+
+  /* the name of the theme when the cache was filled */
+  gchar               *theme_name;
+
+  /* rasterized icons from previous sessions, see thunar_icon_factory_disk_cache_load() */
+  gboolean             disk_cache;
+  gchar               *disk_cache_dir;
+  GSList              *disk_cache_queue;
+  guint                disk_cache_idle_id;
+  guint                disk_cache_purged : 1;
+
+  /* the prewarm list that was last written to disk */
+  gchar               *prewarm_list;
+  guint                prewarm_idle_id;
 };
 
 struct _ThunarIconKey
 {
-  gchar *name;
-  gint   size;
+  gchar     *name;
+  gint       size;
+  guint      hits;
+
+  /* the cached icon, only set on keys owned by the cache */
+  GdkPixbuf *pixbuf;
+  gsize      n_bytes;
+  GList      lru_link;
+};
+
+struct _ThunarIconDiskEntry
+{
+  gchar     *path;
+  GdkPixbuf *pixbuf;
 };
 
 typedef struct
@@ -217,6 +271,48 @@ thunar_icon_factory_class_init (ThunarIconFactoryClass *klass)
                                                       THUNAR_TYPE_THUMBNAIL_SIZE,
                                                       THUNAR_THUMBNAIL_SIZE_NORMAL,
                                                       EXO_PARAM_READWRITE));
+
+  /**
+   * ThunarIconFactory:disk-cache:
+   *
+   * Whether rasterized theme icons are stored in the user's cache
+   * directory, so later sessions don't have to render them again.
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_DISK_CACHE,
+                                   g_param_spec_boolean ("disk-cache",
+                                                         "disk-cache",
+                                                         "disk-cache",
+                                                         FALSE,
+                                                         EXO_PARAM_READWRITE));
+
+  /**
+   * ThunarIconFactory:cache-size:
+   *
+   * The size of the pixel data in the icon cache in bytes,
+   * see thunar_icon_factory_get_cache_stats().
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_CACHE_SIZE,
+                                   g_param_spec_uint64 ("cache-size",
+                                                        "cache-size",
+                                                        "cache-size",
+                                                        0, G_MAXUINT64, 0,
+                                                        EXO_PARAM_READABLE));
+
+  /**
+   * ThunarIconFactory:cache-hit-ratio:
+   *
+   * The ratio of icon lookups answered from the icon cache,
+   * see thunar_icon_factory_get_cache_stats().
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_CACHE_HIT_RATIO,
+                                   g_param_spec_double ("cache-hit-ratio",
+                                                        "cache-hit-ratio",
+                                                        "cache-hit-ratio",
+                                                        0.0, 1.0, 0.0,
+                                                        EXO_PARAM_READABLE));
 }
 
 
@@ -234,9 +330,10 @@ thunar_icon_factory_init (ThunarIconFactory *factory)
   factory->changed_hook_id = g_signal_add_emission_hook (g_signal_lookup ("changed", GTK_TYPE_ICON_THEME),
                                                          0, thunar_icon_factory_changed, factory, NULL);
 
-  /* allocate the hash table for the icon cache */
+  /* allocate the hash table for the icon cache, the keys hold the icons */
   factory->icon_cache = g_hash_table_new_full (thunar_icon_key_hash, thunar_icon_key_equal,
-                                               thunar_icon_key_free, g_object_unref);
+                                               thunar_icon_key_free, NULL);
+  g_queue_init (&factory->icon_lru);
 }
 
 
@@ -248,8 +345,20 @@ thunar_icon_factory_dispose (GObject *object)
 
   _thunar_return_if_fail (THUNAR_IS_ICON_FACTORY (factory));
 
-  if (G_UNLIKELY (factory->sweep_timer_id != 0))
-    g_source_remove (factory->sweep_timer_id);
+  if (G_UNLIKELY (factory->save_timer_id != 0))
+    g_source_remove (factory->save_timer_id);
+
+  if (G_UNLIKELY (factory->prewarm_idle_id != 0))
+    {
+      g_source_remove (factory->prewarm_idle_id);
+      factory->prewarm_idle_id = 0;
+    }
+
+  if (G_UNLIKELY (factory->disk_cache_idle_id != 0))
+    {
+      g_source_remove (factory->disk_cache_idle_id);
+      factory->disk_cache_idle_id = 0;
+    }
 
   (*G_OBJECT_CLASS (thunar_icon_factory_parent_class)->dispose) (object);
 }
@@ -266,6 +375,12 @@ thunar_icon_factory_finalize (GObject *object)
   /* clear the icon cache hash table */
   g_hash_table_destroy (factory->icon_cache);
 
+  /* drop the pending disk cache writes */
+  g_slist_free_full (factory->disk_cache_queue, thunar_icon_disk_entry_free);
+  g_free (factory->disk_cache_dir);
+  g_free (factory->prewarm_list);
+  g_free (factory->theme_name);
+
   /* remove the "changed" emission hook from the GtkIconTheme class */
   g_signal_remove_emission_hook (g_signal_lookup ("changed", GTK_TYPE_ICON_THEME), factory->changed_hook_id);
 
@@ -291,6 +406,8 @@ thunar_icon_factory_get_property (GObject    *object,
                                   GParamSpec *pspec)
 {
   ThunarIconFactory *factory = THUNAR_ICON_FACTORY (object);
+  gdouble            hit_ratio;
+  gsize              n_bytes;
 
   switch (prop_id)
     {
@@ -310,6 +427,20 @@ thunar_icon_factory_get_property (GObject    *object,
       g_value_set_enum (value, factory->thumbnail_size);
       break;
 
+    case PROP_DISK_CACHE:
+      g_value_set_boolean (value, factory->disk_cache);
+      break;
+
+    case PROP_CACHE_SIZE:
+      thunar_icon_factory_get_cache_stats (factory, NULL, &n_bytes, NULL);
+      g_value_set_uint64 (value, n_bytes);
+      break;
+
+    case PROP_CACHE_HIT_RATIO:
+      thunar_icon_factory_get_cache_stats (factory, NULL, NULL, &hit_ratio);
+      g_value_set_double (value, hit_ratio);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -340,6 +471,10 @@ thunar_icon_factory_set_property (GObject      *object,
       factory->thumbnail_size = g_value_get_enum (value);
       break;
 
+    case PROP_DISK_CACHE:
+      factory->disk_cache = g_value_get_boolean (value);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -348,6 +483,74 @@ thunar_icon_factory_set_property (GObject      *object,
 
 
 
+static void
+thunar_icon_factory_cache_remove (ThunarIconFactory *factory,
+                                  ThunarIconKey     *key)
+{
+  g_queue_unlink (&factory->icon_lru, &key->lru_link);
+  factory->cache_size -= key->n_bytes;
+
+  /* releases the key and the icon */
+  g_hash_table_remove (factory->icon_cache, key);
+}
+
+
+
+static void
+thunar_icon_factory_cache_insert (ThunarIconFactory *factory,
+                                  ThunarIconKey     *key)
+{
+  ThunarIconKey *tail;
+  GList         *lp;
+  GList         *lprev;
+  guint          n;
+
+  key->n_bytes = (gsize) gdk_pixbuf_get_rowstride (key->pixbuf) * gdk_pixbuf_get_height (key->pixbuf);
+  key->lru_link.data = key;
+
+  g_hash_table_insert (factory->icon_cache, key, key);
+  g_queue_push_head_link (&factory->icon_lru, &key->lru_link);
+  factory->cache_size += key->n_bytes;
+
+  /* evict the least recently used icons until we're within the budget. Icons
+   * still referenced elsewhere (e.g. by visible rows) would not be freed
+   * anyway, so they are stepped over without touching the recency order.
+   * Only a bounded number of icons is looked at per insert, so the cache
+   * may stay over budget for a while if most icons are in use */
+  for (lp = factory->icon_lru.tail, n = 0;
+       lp != NULL && lp != &key->lru_link
+       && n < THUNAR_ICON_FACTORY_EVICT_SCAN
+       && factory->cache_size > THUNAR_ICON_FACTORY_CACHE_BUDGET;
+       lp = lprev, ++n)
+    {
+      lprev = lp->prev;
+      tail = lp->data;
+      if (G_OBJECT (tail->pixbuf)->ref_count == 1)
+        thunar_icon_factory_cache_remove (factory, tail);
+    }
+}
+
+
+
+static gchar *
+thunar_icon_factory_dup_theme_name (ThunarIconFactory *factory)
+{
+  GtkSettings *settings;
+  gchar       *theme_name = NULL;
+
+  /* we can only know the name of the default theme */
+  if (factory->icon_theme == gtk_icon_theme_get_default ())
+    {
+      settings = gtk_settings_get_default ();
+      if (G_LIKELY (settings != NULL))
+        g_object_get (G_OBJECT (settings), "gtk-icon-theme-name", &theme_name, NULL);
+    }
+
+  return theme_name;
+}
+
+
+
 static gboolean
 thunar_icon_factory_changed (GSignalInvocationHint *ihint,
                              guint                  n_param_values,
@@ -355,12 +558,50 @@ thunar_icon_factory_changed (GSignalInvocationHint *ihint,
                              gpointer               user_data)
 {
   ThunarIconFactory *factory = THUNAR_ICON_FACTORY (user_data);
+  ThunarIconKey     *key;
+  GList             *lp;
+  GList             *lnext;
+  gchar             *theme_name;
 
-  /* drop all items from the icon cache */
-  g_hash_table_remove_all (factory->icon_cache);
+  /* the hook is run for all icon themes */
+  if (n_param_values > 0 && g_value_get_object (&param_values[0]) != factory->icon_theme)
+    return TRUE;
+
+  theme_name = thunar_icon_factory_dup_theme_name (factory);
+  if (theme_name != NULL && g_strcmp0 (theme_name, factory->theme_name) == 0)
+    {
+      /* same theme, so only drop the icons that are not
+       * in use, the visible rows keep theirs */
+      for (lp = factory->icon_lru.head; lp != NULL; lp = lnext)
+        {
+          lnext = lp->next;
+          key = lp->data;
+          if (G_OBJECT (key->pixbuf)->ref_count == 1)
+            thunar_icon_factory_cache_remove (factory, key);
+        }
+
+      g_free (theme_name);
+    }
+  else
+    {
+      /* drop all items from the icon cache */
+      g_hash_table_remove_all (factory->icon_cache);
+      g_queue_init (&factory->icon_lru);
+      factory->cache_size = 0;
 
-  /* bump the stamp so all file icons are reloaded */
-  factory->theme_stamp++;
+      /* bump the stamp so all file icons are reloaded */
+      factory->theme_stamp++;
+
+      g_free (factory->theme_name);
+      factory->theme_name = theme_name;
+    }
+
+  /* the disk cache location depends on the theme */
+  g_slist_free_full (factory->disk_cache_queue, thunar_icon_disk_entry_free);
+  factory->disk_cache_queue = NULL;
+  g_free (factory->disk_cache_dir);
+  factory->disk_cache_dir = NULL;
+  factory->disk_cache_purged = FALSE;
 
   /* keep the emission hook alive */
   return TRUE;
@@ -369,25 +610,149 @@ thunar_icon_factory_changed (GSignalInvocationHint *ihint,
 
 
 static gboolean
-thunar_icon_check_sweep (ThunarIconKey *key,
-                         GdkPixbuf     *pixbuf)
+thunar_icon_factory_save_timer (gpointer user_data)
+{
+  ThunarIconFactory *factory = THUNAR_ICON_FACTORY (user_data);
+
+  _thunar_return_val_if_fail (THUNAR_IS_ICON_FACTORY (factory), FALSE);
+
+THUNAR_THREADS_ENTER
+
+  /* remember the most used icons for the next session */
+  thunar_icon_factory_save_prewarm_list (factory);
+
+THUNAR_THREADS_LEAVE
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_icon_factory_save_timer_destroy (gpointer user_data)
 {
-  return (G_OBJECT (pixbuf)->ref_count == 1);
+  THUNAR_ICON_FACTORY (user_data)->save_timer_id = 0;
+}
+
+
+
+static gint
+thunar_icon_key_compare_hits (gconstpointer a,
+                              gconstpointer b)
+{
+  const ThunarIconKey *a_key = a;
+  const ThunarIconKey *b_key = b;
+
+  /* most used icons first */
+  if (a_key->hits != b_key->hits)
+    return (a_key->hits > b_key->hits) ? -1 : 1;
+
+  return 0;
+}
+
+
+
+static gchar *
+thunar_icon_factory_get_prewarm_path (void)
+{
+  return xfce_resource_save_location (XFCE_RESOURCE_CACHE, "Thunar/icon-prewarm", TRUE);
+}
+
+
+
+static void
+thunar_icon_factory_save_prewarm_list (ThunarIconFactory *factory)
+{
+  ThunarIconKey *key;
+  GString       *list;
+  GList         *keys;
+  GList         *lp;
+  gchar         *path;
+  guint          n;
+
+  /* only the default theme is used at startup */
+  if (factory->icon_theme != gtk_icon_theme_get_default ())
+    return;
+
+  /* sort the cached icons by the number of lookups */
+  keys = g_list_sort (g_hash_table_get_keys (factory->icon_cache), thunar_icon_key_compare_hits);
+
+  /* one "size name" pair per line */
+  list = g_string_new (NULL);
+  for (lp = keys, n = 0; lp != NULL && n < THUNAR_ICON_FACTORY_PREWARM_MAX; lp = lp->next)
+    {
+      key = lp->data;
+
+      /* files are not part of the icon theme */
+      if (G_UNLIKELY (g_path_is_absolute (key->name) || strchr (key->name, '\n') != NULL))
+        continue;
+
+      g_string_append_printf (list, "%d %s\n", key->size, key->name);
+      n++;
+    }
+  g_list_free (keys);
+
+  /* only touch the file if the list changed */
+  if (list->len > 0 && g_strcmp0 (list->str, factory->prewarm_list) != 0)
+    {
+      path = thunar_icon_factory_get_prewarm_path ();
+      if (G_LIKELY (path != NULL))
+        {
+          if (g_file_set_contents (path, list->str, list->len, NULL))
+            {
+              g_free (factory->prewarm_list);
+              factory->prewarm_list = g_strdup (list->str);
+            }
+          g_free (path);
+        }
+    }
+
+  g_string_free (list, TRUE);
 }
 
 
 
 static gboolean
-thunar_icon_factory_sweep_timer (gpointer user_data)
+thunar_icon_factory_prewarm (gpointer user_data)
 {
   ThunarIconFactory *factory = THUNAR_ICON_FACTORY (user_data);
+  GdkPixbuf         *pixbuf;
+  gchar            **lines;
+  gchar             *contents;
+  gchar             *path;
+  gchar             *name;
+  gint               size;
+  guint              n;
 
   _thunar_return_val_if_fail (THUNAR_IS_ICON_FACTORY (factory), FALSE);
 
 THUNAR_THREADS_ENTER
 
-  /* ditch all icons whose ref_count is 1 */
-  g_hash_table_foreach_remove (factory->icon_cache, (GHRFunc) thunar_icon_check_sweep, factory);
+  factory->prewarm_idle_id = 0;
+
+  path = thunar_icon_factory_get_prewarm_path ();
+  if (G_LIKELY (path != NULL) && g_file_get_contents (path, &contents, NULL, NULL))
+    {
+      /* remember the list, so we don't rewrite it needlessly */
+      g_free (factory->prewarm_list);
+      factory->prewarm_list = g_strdup (contents);
+
+      /* load the icons, they stay in the cache until they are evicted */
+      lines = g_strsplit (contents, "\n", THUNAR_ICON_FACTORY_PREWARM_MAX + 1);
+      for (n = 0; n < THUNAR_ICON_FACTORY_PREWARM_MAX && lines[n] != NULL; ++n)
+        {
+          size = strtol (lines[n], &name, 10);
+          if (G_UNLIKELY (size <= 0 || *name != ' ' || *++name == '\0'))
+            continue;
+
+          pixbuf = thunar_icon_factory_lookup_icon (factory, name, size, FALSE);
+          if (G_LIKELY (pixbuf != NULL))
+            g_object_unref (pixbuf);
+        }
+      g_strfreev (lines);
+      g_free (contents);
+    }
+  g_free (path);
 
 THUNAR_THREADS_LEAVE
 
@@ -396,10 +761,325 @@ THUNAR_THREADS_LEAVE
 
 
 
+static gint64
+thunar_icon_factory_get_theme_mtime (gchar      **paths,
+                                     gint         n_paths,
+                                     const gchar *theme_name)
+{
+  GHashTable  *visited;
+  GKeyFile    *key_file;
+  GStatBuf     statb;
+  GQueue       themes = G_QUEUE_INIT;
+  gint64       mtime = 0;
+  gchar      **inherits;
+  gchar       *theme_path;
+  gchar       *name;
+  gboolean     found_index;
+  gint         n, i;
+
+  /* walk the theme and everything it inherits from, icons can be
+   * resolved from any of them, hicolor is always the last fallback */
+  visited = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  g_queue_push_tail (&themes, g_strdup (theme_name));
+  g_queue_push_tail (&themes, g_strdup ("hicolor"));
+
+  while ((name = g_queue_pop_head (&themes)) != NULL)
+    {
+      if (strchr (name, G_DIR_SEPARATOR) != NULL
+          || g_hash_table_lookup_extended (visited, name, NULL, NULL))
+        {
+          g_free (name);
+          continue;
+        }
+      g_hash_table_insert (visited, name, NULL);
+
+      found_index = FALSE;
+      for (n = 0; n < n_paths; ++n)
+        {
+          /* the newest modification time of the theme directories and their
+           * caches, gtk-update-icon-cache touches the latter on every update */
+          theme_path = g_build_filename (paths[n], name, NULL);
+          if (g_stat (theme_path, &statb) == 0)
+            mtime = MAX (mtime, (gint64) statb.st_mtime);
+          g_free (theme_path);
+
+          theme_path = g_build_filename (paths[n], name, "icon-theme.cache", NULL);
+          if (g_stat (theme_path, &statb) == 0)
+            mtime = MAX (mtime, (gint64) statb.st_mtime);
+          g_free (theme_path);
+
+          /* the first index.theme in the search path wins, like in gtk */
+          if (found_index)
+            continue;
+
+          theme_path = g_build_filename (paths[n], name, "index.theme", NULL);
+          key_file = g_key_file_new ();
+          if (g_key_file_load_from_file (key_file, theme_path, G_KEY_FILE_NONE, NULL))
+            {
+              found_index = TRUE;
+              inherits = g_key_file_get_string_list (key_file, "Icon Theme", "Inherits", NULL, NULL);
+              if (inherits != NULL)
+                {
+                  for (i = 0; inherits[i] != NULL; ++i)
+                    g_queue_push_tail (&themes, g_strdup (g_strstrip (inherits[i])));
+                  g_strfreev (inherits);
+                }
+            }
+          g_key_file_free (key_file);
+          g_free (theme_path);
+        }
+    }
+
+  g_hash_table_destroy (visited);
+
+  return mtime;
+}
+
+
+
+static const gchar *
+thunar_icon_factory_get_disk_cache_dir (ThunarIconFactory *factory)
+{
+  GtkSettings  *settings;
+  gint64        mtime;
+  gchar       **paths = NULL;
+  gchar        *theme_name = NULL;
+  gchar        *spec;
+  gint          n_paths;
+
+  /* only the default theme has a name we can key the cache on */
+  if (!factory->disk_cache || factory->icon_theme != gtk_icon_theme_get_default ())
+    return NULL;
+
+  if (G_LIKELY (factory->disk_cache_dir != NULL))
+    return factory->disk_cache_dir;
+
+  settings = gtk_settings_get_default ();
+  if (G_UNLIKELY (settings == NULL))
+    return NULL;
+
+  g_object_get (G_OBJECT (settings), "gtk-icon-theme-name", &theme_name, NULL);
+  if (G_UNLIKELY (exo_str_is_empty (theme_name) || strchr (theme_name, G_DIR_SEPARATOR) != NULL))
+    {
+      g_free (theme_name);
+      return NULL;
+    }
+
+  /* an update of any theme in the inheritance chain starts a new cache */
+  gtk_icon_theme_get_search_path (factory->icon_theme, &paths, &n_paths);
+  mtime = thunar_icon_factory_get_theme_mtime (paths, n_paths, theme_name);
+  g_strfreev (paths);
+
+  /* $XDG_CACHE_HOME/Thunar/icons/<theme>-<mtime>/ */
+  spec = g_strdup_printf ("Thunar/icons/%s-%" G_GINT64_FORMAT "/", theme_name, mtime);
+  factory->disk_cache_dir = xfce_resource_save_location (XFCE_RESOURCE_CACHE, spec, FALSE);
+  g_free (spec);
+  g_free (theme_name);
+
+  return factory->disk_cache_dir;
+}
+
+
+
+static gchar *
+thunar_icon_factory_get_disk_cache_path (ThunarIconFactory *factory,
+                                         const gchar       *name,
+                                         gint               size)
+{
+  const gchar *dir;
+  gchar        size_string[16];
+  gchar       *filename;
+  gchar       *path;
+
+  dir = thunar_icon_factory_get_disk_cache_dir (factory);
+  if (dir == NULL || strchr (name, G_DIR_SEPARATOR) != NULL)
+    return NULL;
+
+  g_snprintf (size_string, sizeof (size_string), "%d", size);
+  filename = g_strconcat (name, ".png", NULL);
+  path = g_build_filename (dir, size_string, filename, NULL);
+  g_free (filename);
+
+  return path;
+}
+
+
+
+static GdkPixbuf *
+thunar_icon_factory_disk_cache_load (ThunarIconFactory *factory,
+                                     const gchar       *name,
+                                     gint               size)
+{
+  GdkPixbuf *pixbuf;
+  gchar     *path;
+
+  path = thunar_icon_factory_get_disk_cache_path (factory, name, size);
+  if (path == NULL)
+    return NULL;
+
+  pixbuf = gdk_pixbuf_new_from_file (path, NULL);
+  g_free (path);
+
+  return pixbuf;
+}
+
+
+
+static void
+thunar_icon_disk_entry_free (gpointer data)
+{
+  ThunarIconDiskEntry *entry = data;
+
+  g_free (entry->path);
+  g_object_unref (entry->pixbuf);
+  g_slice_free (ThunarIconDiskEntry, entry);
+}
+
+
+
+static void
+thunar_icon_factory_disk_cache_remove (const gchar *path)
+{
+  const gchar *name;
+  gchar       *child;
+  GDir        *dir;
+
+  if (!g_file_test (path, G_FILE_TEST_IS_SYMLINK)
+      && g_file_test (path, G_FILE_TEST_IS_DIR))
+    {
+      dir = g_dir_open (path, 0, NULL);
+      if (dir != NULL)
+        {
+          while ((name = g_dir_read_name (dir)) != NULL)
+            {
+              child = g_build_filename (path, name, NULL);
+              thunar_icon_factory_disk_cache_remove (child);
+              g_free (child);
+            }
+          g_dir_close (dir);
+        }
+      g_rmdir (path);
+    }
+  else
+    {
+      g_unlink (path);
+    }
+}
+
+
+
+static void
+thunar_icon_factory_disk_cache_purge (gpointer data,
+                                      gpointer user_data)
+{
+  const gchar *name;
+  gchar       *disk_cache_dir = data;
+  gchar       *parent;
+  gchar       *current;
+  gchar       *path;
+  GDir        *dir;
+
+  /* runs in the purge thread, drop the caches of other
+   * themes or older versions of this theme */
+  current = g_path_get_basename (disk_cache_dir);
+  parent = g_path_get_dirname (disk_cache_dir);
+  dir = g_dir_open (parent, 0, NULL);
+  if (dir != NULL)
+    {
+      while ((name = g_dir_read_name (dir)) != NULL)
+        {
+          if (strcmp (name, current) != 0)
+            {
+              path = g_build_filename (parent, name, NULL);
+              thunar_icon_factory_disk_cache_remove (path);
+              g_free (path);
+            }
+        }
+      g_dir_close (dir);
+    }
+  g_free (parent);
+  g_free (current);
+  g_free (disk_cache_dir);
+}
+
+
+
+static gboolean
+thunar_icon_factory_disk_cache_write (gpointer user_data)
+{
+  ThunarIconFactory   *factory = THUNAR_ICON_FACTORY (user_data);
+  ThunarIconDiskEntry *entry;
+  static GThreadPool  *purge_pool = NULL;
+  gchar               *buffer;
+  gchar               *dirname;
+  gsize                length;
+
+THUNAR_THREADS_ENTER
+
+  /* once per cache location, remove the caches of other themes in a
+   * thread, those are whole trees that take a while to delete */
+  if (G_UNLIKELY (factory->disk_cache_dir != NULL && !factory->disk_cache_purged))
+    {
+      if (G_UNLIKELY (purge_pool == NULL))
+        purge_pool = g_thread_pool_new (thunar_icon_factory_disk_cache_purge, NULL, 1, FALSE, NULL);
+      g_thread_pool_push (purge_pool, g_strdup (factory->disk_cache_dir), NULL);
+      factory->disk_cache_purged = TRUE;
+    }
+
+  if (G_LIKELY (factory->disk_cache_queue != NULL))
+    {
+      /* write one icon per iteration to keep the main loop responsive */
+      entry = factory->disk_cache_queue->data;
+      factory->disk_cache_queue = g_slist_delete_link (factory->disk_cache_queue,
+                                                       factory->disk_cache_queue);
+
+      dirname = g_path_get_dirname (entry->path);
+      if (g_mkdir_with_parents (dirname, 0700) == 0
+          && gdk_pixbuf_save_to_buffer (entry->pixbuf, &buffer, &length, "png", NULL, NULL))
+        {
+          g_file_set_contents (entry->path, buffer, length, NULL);
+          g_free (buffer);
+        }
+      g_free (dirname);
+
+      thunar_icon_disk_entry_free (entry);
+    }
+
+THUNAR_THREADS_LEAVE
+
+  if (factory->disk_cache_queue != NULL)
+    return TRUE;
+
+  factory->disk_cache_idle_id = 0;
+  return FALSE;
+}
+
+
+
 static void
-thunar_icon_factory_sweep_timer_destroy (gpointer user_data)
+thunar_icon_factory_disk_cache_store (ThunarIconFactory *factory,
+                                      const gchar       *name,
+                                      gint               size,
+                                      GdkPixbuf         *pixbuf)
 {
-  THUNAR_ICON_FACTORY (user_data)->sweep_timer_id = 0;
+  ThunarIconDiskEntry *entry;
+  gchar               *path;
+
+  path = thunar_icon_factory_get_disk_cache_path (factory, name, size);
+  if (path == NULL)
+    return;
+
+  /* queue the icon, it is written when the application is idle */
+  entry = g_slice_new (ThunarIconDiskEntry);
+  entry->path = path;
+  entry->pixbuf = g_object_ref (pixbuf);
+  factory->disk_cache_queue = g_slist_prepend (factory->disk_cache_queue, entry);
+
+  if (factory->disk_cache_idle_id == 0)
+    {
+      factory->disk_cache_idle_id = g_idle_add_full (G_PRIORITY_LOW, thunar_icon_factory_disk_cache_write,
+                                                     factory, NULL);
+    }
 }
 
 
@@ -562,8 +1242,23 @@ thunar_icon_factory_lookup_icon (ThunarIconFactory *factory,
   lookup_key.size = size;
 
   /* check if we already have a cached version of the icon */
-  if (!g_hash_table_lookup_extended (factory->icon_cache, &lookup_key, NULL, (gpointer) &pixbuf))
+  key = g_hash_table_lookup (factory->icon_cache, &lookup_key);
+  if (G_LIKELY (key != NULL))
     {
+      /* used to find the most common icons */
+      key->hits++;
+      factory->cache_hits++;
+
+      /* move the icon to the head of the LRU queue */
+      g_queue_unlink (&factory->icon_lru, &key->lru_link);
+      g_queue_push_head_link (&factory->icon_lru, &key->lru_link);
+
+      pixbuf = key->pixbuf;
+    }
+  else
+    {
+      factory->cache_misses++;
+
       /* check if we have to load a file instead of a themed icon */
       if (G_UNLIKELY (g_path_is_absolute (name)))
         {
@@ -576,15 +1271,24 @@ thunar_icon_factory_lookup_icon (ThunarIconFactory *factory,
           if (g_strcmp0 (name, "inode-directory") == 0)
             name = "folder";
 
-          /* check if the icon theme contains an icon of that name */
-          icon_info = gtk_icon_theme_lookup_icon (factory->icon_theme, name, size, GTK_ICON_LOOKUP_FORCE_SIZE);
-          if (G_LIKELY (icon_info != NULL))
+          /* try the rendered icon from a previous session first */
+          pixbuf = thunar_icon_factory_disk_cache_load (factory, name, size);
+          if (pixbuf == NULL)
             {
-              /* try to load the pixbuf from the icon info */
-              pixbuf = gtk_icon_info_load_icon (icon_info, NULL);
+              /* check if the icon theme contains an icon of that name */
+              icon_info = gtk_icon_theme_lookup_icon (factory->icon_theme, name, size, GTK_ICON_LOOKUP_FORCE_SIZE);
+              if (G_LIKELY (icon_info != NULL))
+                {
+                  /* try to load the pixbuf from the icon info */
+                  pixbuf = gtk_icon_info_load_icon (icon_info, NULL);
+
+                  /* cleanup */
+                  g_object_unref (icon_info);
 
-              /* cleanup */
-              g_object_unref (icon_info);
+                  /* store the rendered icon for the next session */
+                  if (G_LIKELY (pixbuf != NULL))
+                    thunar_icon_factory_disk_cache_store (factory, name, size, pixbuf);
+                }
             }
         }
 
@@ -599,20 +1303,27 @@ thunar_icon_factory_lookup_icon (ThunarIconFactory *factory,
         }
 
       /* generate a key for the new cached icon */
-      key = g_slice_new (ThunarIconKey);
+      key = g_slice_new0 (ThunarIconKey);
       key->size = size;
       key->name = g_strdup (name);
+      key->hits = 1;
+      key->pixbuf = pixbuf;
+
+      /* take our reference before the insert may evict other icons */
+      g_object_ref (G_OBJECT (pixbuf));
 
       /* insert the new icon into the cache */
-      g_hash_table_insert (factory->icon_cache, key, pixbuf);
-    }
+      thunar_icon_factory_cache_insert (factory, key);
 
-  /* schedule the sweeper */
-  if (G_UNLIKELY (factory->sweep_timer_id == 0))
-    {
-      factory->sweep_timer_id = g_timeout_add_seconds_full (G_PRIORITY_LOW, THUNAR_ICON_FACTORY_SWEEP_TIMEOUT,
-                                                            thunar_icon_factory_sweep_timer, factory,
-                                                            thunar_icon_factory_sweep_timer_destroy);
+      /* schedule saving the prewarm list */
+      if (G_UNLIKELY (factory->save_timer_id == 0))
+        {
+          factory->save_timer_id = g_timeout_add_seconds_full (G_PRIORITY_LOW, THUNAR_ICON_FACTORY_SAVE_TIMEOUT,
+                                                               thunar_icon_factory_save_timer, factory,
+                                                               thunar_icon_factory_save_timer_destroy);
+        }
+
+      return pixbuf;
     }
 
   return GDK_PIXBUF (g_object_ref (G_OBJECT (pixbuf)));
@@ -659,6 +1370,8 @@ thunar_icon_key_free (gpointer data)
 {
   ThunarIconKey *key = data;
 
+  if (key->pixbuf != NULL)
+    g_object_unref (key->pixbuf);
   g_free (key->name);
   g_slice_free (ThunarIconKey, key);
 }
@@ -749,11 +1462,21 @@ thunar_icon_factory_get_for_icon_theme (GtkIconTheme *icon_theme)
       factory = g_object_new (THUNAR_TYPE_ICON_FACTORY, NULL);
       factory->icon_theme = GTK_ICON_THEME (g_object_ref (G_OBJECT (icon_theme)));
       g_object_set_qdata (G_OBJECT (factory->icon_theme), thunar_icon_factory_quark, factory);
+      factory->theme_name = thunar_icon_factory_dup_theme_name (factory);
 
       /* connect the "show-thumbnails" property to the global preference */
       factory->preferences = thunar_preferences_get ();
       exo_binding_new (G_OBJECT (factory->preferences), "misc-thumbnail-mode",
                        G_OBJECT (factory), "thumbnail-mode");
+      exo_binding_new (G_OBJECT (factory->preferences), "misc-icon-disk-cache",
+                       G_OBJECT (factory), "disk-cache");
+
+      /* load the most common icons of the last session before the first paint */
+      if (icon_theme == gtk_icon_theme_get_default ())
+        {
+          factory->prewarm_idle_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE, thunar_icon_factory_prewarm,
+                                                      factory, NULL);
+        }
     }
   else
     {
@@ -1007,3 +1730,37 @@ thunar_icon_factory_clear_pixmap_cache (ThunarFile *file)
   if (thunar_icon_factory_store_quark != 0)
     g_object_set_qdata (G_OBJECT (file), thunar_icon_factory_store_quark, NULL);
 }
+
+
+/**
+ * thunar_icon_factory_get_cache_stats:
+ * @factory   : a #ThunarIconFactory instance.
+ * @n_icons   : return location for the number of cached icons or %NULL.
+ * @n_bytes   : return location for the size of the cached pixel data or %NULL.
+ * @hit_ratio : return location for the ratio of lookups answered from
+ *              the cache (between 0.0 and 1.0) or %NULL.
+ *
+ * Reports the state of the icon cache of @factory.
+ **/
+void
+thunar_icon_factory_get_cache_stats (ThunarIconFactory *factory,
+                                     guint             *n_icons,
+                                     gsize             *n_bytes,
+                                     gdouble           *hit_ratio)
+{
+  guint n_lookups;
+
+  _thunar_return_if_fail (THUNAR_IS_ICON_FACTORY (factory));
+
+  if (n_icons != NULL)
+    *n_icons = factory->icon_lru.length;
+
+  if (n_bytes != NULL)
+    *n_bytes = factory->cache_size;
+
+  if (hit_ratio != NULL)
+    {
+      n_lookups = factory->cache_hits + factory->cache_misses;
+      *hit_ratio = (n_lookups > 0) ? ((gdouble) factory->cache_hits / n_lookups) : 0.0;
+    }
+}
@@ -56,6 +56,11 @@ GdkPixbuf             *thunar_icon_factory_load_file_icon     (ThunarIconFactory
 
 void                   thunar_icon_factory_clear_pixmap_cache (ThunarFile               *file);
 
+void                   thunar_icon_factory_get_cache_stats    (ThunarIconFactory        *factory,
+                                                               guint                    *n_icons,
+                                                               gsize                    *n_bytes,
+                                                               gdouble                  *hit_ratio);
+
 G_END_DECLS;
 
 #endif /* !__THUNAR_ICON_FACTORY_H__ */
@@ -30,6 +30,14 @@
 
 
 
+/* the maximum number of emblems per icon */
+#define THUNAR_ICON_RENDERER_MAX_EMBLEMS (4)
+
+/* the maximum number of composited icons to keep per renderer */
+#define THUNAR_ICON_RENDERER_CACHE_SIZE (128)
+
+
+
 enum
 {
   PROP_0,
@@ -65,6 +73,40 @@ static void thunar_icon_renderer_render        (GtkCellRenderer         *rendere
                                                 const GdkRectangle      *background_area,
                                                 const GdkRectangle      *cell_area,
                                                 GtkCellRendererState     flags);
+static guint thunar_icon_composite_hash        (gconstpointer            data);
+static gboolean thunar_icon_composite_equal    (gconstpointer            a,
+                                                gconstpointer            b);
+static void thunar_icon_composite_free         (gpointer                 data);
+static void thunar_icon_composite_weak_notify  (gpointer                 data,
+                                                GObject                 *where_the_object_was);
+
+
+
+typedef struct _ThunarIconComposite ThunarIconComposite;
+
+
+
+struct _ThunarIconComposite
+{
+  /* the renderer whose cache holds this composite */
+  ThunarIconRenderer *renderer;
+
+  /* the pixbufs and geometry the surface was composited from, only
+   * watched with weak references, so the icon factory can still
+   * release them and the composite is dropped along with them */
+  GdkPixbuf       *icon;
+  GdkPixbuf       *emblems[THUNAR_ICON_RENDERER_MAX_EMBLEMS];
+  gint             emblem_size;
+  gint             width;
+  gint             height;
+  gint             alpha;
+
+  /* the composited surface of the size of the cell */
+  cairo_surface_t *surface;
+
+  /* link in the renderer's LRU queue */
+  GList            lru_link;
+};
 
 
 
@@ -163,6 +205,13 @@ thunar_icon_renderer_init (ThunarIconRenderer *icon_renderer)
 {
   /* use 1px padding */
   gtk_cell_renderer_set_padding (GTK_CELL_RENDERER (icon_renderer), 1, 1);
+
+  /* setup the composite cache */
+  icon_renderer->composites = g_hash_table_new_full (thunar_icon_composite_hash,
+                                                     thunar_icon_composite_equal,
+                                                     thunar_icon_composite_free,
+                                                     NULL);
+  g_queue_init (&icon_renderer->composite_lru);
 }
 
 
@@ -178,6 +227,9 @@ thunar_icon_renderer_finalize (GObject *object)
   if (G_LIKELY (icon_renderer->file != NULL))
     g_object_unref (G_OBJECT (icon_renderer->file));
 
+  /* release the composited icons */
+  g_hash_table_destroy (icon_renderer->composites);
+
   (*G_OBJECT_CLASS (thunar_icon_renderer_parent_class)->finalize) (object);
 }
 
@@ -368,6 +420,269 @@ thunar_icon_renderer_color_lighten (cairo_t   *cr,
 
 
 
+static guint
+thunar_icon_composite_hash (gconstpointer data)
+{
+  const ThunarIconComposite *composite = data;
+  guint                      hash;
+  guint                      n;
+
+  hash = g_direct_hash (composite->icon);
+  for (n = 0; n < THUNAR_ICON_RENDERER_MAX_EMBLEMS; ++n)
+    hash = (hash << 5) - hash + g_direct_hash (composite->emblems[n]);
+
+  return hash ^ (composite->width << 20) ^ (composite->height << 8) ^ composite->alpha;
+}
+
+
+
+static gboolean
+thunar_icon_composite_equal (gconstpointer a,
+                             gconstpointer b)
+{
+  const ThunarIconComposite *a_composite = a;
+  const ThunarIconComposite *b_composite = b;
+  guint                      n;
+
+  if (a_composite->icon != b_composite->icon
+      || a_composite->emblem_size != b_composite->emblem_size
+      || a_composite->width != b_composite->width
+      || a_composite->height != b_composite->height
+      || a_composite->alpha != b_composite->alpha)
+    return FALSE;
+
+  for (n = 0; n < THUNAR_ICON_RENDERER_MAX_EMBLEMS; ++n)
+    if (a_composite->emblems[n] != b_composite->emblems[n])
+      return FALSE;
+
+  return TRUE;
+}
+
+
+
+static gboolean
+thunar_icon_composite_is_first (const ThunarIconComposite *composite,
+                                guint                      n)
+{
+  guint i;
+
+  /* whether emblems[n] is not the icon and not an earlier emblem, so
+   * every pixbuf is only watched once */
+  if (composite->emblems[n] == NULL || composite->emblems[n] == composite->icon)
+    return FALSE;
+
+  for (i = 0; i < n; ++i)
+    if (composite->emblems[i] == composite->emblems[n])
+      return FALSE;
+
+  return TRUE;
+}
+
+
+
+static void
+thunar_icon_composite_watch (ThunarIconComposite *composite)
+{
+  guint n;
+
+  g_object_weak_ref (G_OBJECT (composite->icon), thunar_icon_composite_weak_notify, composite);
+  for (n = 0; n < THUNAR_ICON_RENDERER_MAX_EMBLEMS; ++n)
+    if (thunar_icon_composite_is_first (composite, n))
+      g_object_weak_ref (G_OBJECT (composite->emblems[n]), thunar_icon_composite_weak_notify, composite);
+}
+
+
+
+static void
+thunar_icon_composite_free (gpointer data)
+{
+  ThunarIconComposite *composite = data;
+  guint                n;
+
+  /* stop watching the pixbufs that are still alive */
+  if (composite->icon != NULL)
+    g_object_weak_unref (G_OBJECT (composite->icon), thunar_icon_composite_weak_notify, composite);
+  for (n = 0; n < THUNAR_ICON_RENDERER_MAX_EMBLEMS; ++n)
+    if (thunar_icon_composite_is_first (composite, n))
+      g_object_weak_unref (G_OBJECT (composite->emblems[n]), thunar_icon_composite_weak_notify, composite);
+
+  if (G_LIKELY (composite->surface != NULL))
+    cairo_surface_destroy (composite->surface);
+
+  g_slice_free (ThunarIconComposite, composite);
+}
+
+
+
+static void
+thunar_icon_composite_weak_notify (gpointer  data,
+                                   GObject  *where_the_object_was)
+{
+  ThunarIconComposite *composite = data;
+  ThunarIconRenderer  *icon_renderer = composite->renderer;
+  guint                n;
+
+  /* take the composite out of the cache while its key is still intact */
+  g_hash_table_steal (icon_renderer->composites, composite);
+  g_queue_unlink (&icon_renderer->composite_lru, &composite->lru_link);
+
+  /* the finalized pixbuf must not be unwatched */
+  if (composite->icon == (GdkPixbuf *) where_the_object_was)
+    composite->icon = NULL;
+  for (n = 0; n < THUNAR_ICON_RENDERER_MAX_EMBLEMS; ++n)
+    if (composite->emblems[n] == (GdkPixbuf *) where_the_object_was)
+      composite->emblems[n] = NULL;
+
+  thunar_icon_composite_free (composite);
+}
+
+
+
+static cairo_surface_t*
+thunar_icon_renderer_compose (const ThunarIconComposite *composite)
+{
+  cairo_surface_t *surface;
+  GdkRectangle     emblem_area;
+  GdkRectangle     icon_area;
+  GdkPixbuf       *emblem;
+  GdkPixbuf       *icon;
+  cairo_t         *cr;
+  guint            n;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, composite->width, composite->height);
+  cr = cairo_create (surface);
+
+  /* determine the real icon size */
+  icon = g_object_ref (G_OBJECT (composite->icon));
+  icon_area.width = gdk_pixbuf_get_width (icon);
+  icon_area.height = gdk_pixbuf_get_height (icon);
+
+  /* scale down the icon on-demand */
+  if (G_UNLIKELY (icon_area.width > composite->width || icon_area.height > composite->height))
+    {
+      /* scale down to fit */
+      g_object_unref (G_OBJECT (icon));
+      icon = exo_gdk_pixbuf_scale_down (composite->icon, TRUE, MAX (1, composite->width), MAX (1, composite->height));
+
+      /* determine the icon dimensions again */
+      icon_area.width = gdk_pixbuf_get_width (icon);
+      icon_area.height = gdk_pixbuf_get_height (icon);
+    }
+
+  icon_area.x = (composite->width - icon_area.width) / 2;
+  icon_area.y = (composite->height - icon_area.height) / 2;
+
+  /* paint the icon, translucent for cutted and hidden files */
+  thunar_gdk_cairo_set_source_pixbuf (cr, icon, icon_area.x, icon_area.y);
+  cairo_paint_with_alpha (cr, composite->alpha / 100.0);
+  g_object_unref (G_OBJECT (icon));
+
+  /* paint the emblems around the icon */
+  for (n = 0; n < THUNAR_ICON_RENDERER_MAX_EMBLEMS && composite->emblems[n] != NULL; ++n)
+    {
+      /* determine the dimensions of the emblem */
+      emblem = g_object_ref (G_OBJECT (composite->emblems[n]));
+      emblem_area.width = gdk_pixbuf_get_width (emblem);
+      emblem_area.height = gdk_pixbuf_get_height (emblem);
+
+      /* shrink insane emblems */
+      if (G_UNLIKELY (MAX (emblem_area.width, emblem_area.height) > composite->emblem_size))
+        {
+          /* scale down the emblem */
+          g_object_unref (G_OBJECT (emblem));
+          emblem = exo_gdk_pixbuf_scale_ratio (composite->emblems[n], composite->emblem_size);
+
+          /* determine the size again */
+          emblem_area.width = gdk_pixbuf_get_width (emblem);
+          emblem_area.height = gdk_pixbuf_get_height (emblem);
+        }
+
+      /* determine a good position for the emblem, depending on the position index */
+      switch (n)
+        {
+        case 0: /* right/bottom */
+          emblem_area.x = MIN (icon_area.x + icon_area.width - emblem_area.width / 2,
+                               composite->width - emblem_area.width);
+          emblem_area.y = MIN (icon_area.y + icon_area.height - emblem_area.height / 2,
+                               composite->height - emblem_area.height);
+          break;
+
+        case 1: /* left/bottom */
+          emblem_area.x = MAX (icon_area.x - emblem_area.width / 2, 0);
+          emblem_area.y = MIN (icon_area.y + icon_area.height - emblem_area.height / 2,
+                               composite->height - emblem_area.height);
+          break;
+
+        case 2: /* left/top */
+          emblem_area.x = MAX (icon_area.x - emblem_area.width / 2, 0);
+          emblem_area.y = MAX (icon_area.y - emblem_area.height / 2, 0);
+          break;
+
+        case 3: /* right/top */
+          emblem_area.x = MIN (icon_area.x + icon_area.width - emblem_area.width / 2,
+                               composite->width - emblem_area.width);
+          emblem_area.y = MAX (icon_area.y - emblem_area.height / 2, 0);
+          break;
+
+        default:
+          _thunar_assert_not_reached ();
+        }
+
+      /* paint the emblem */
+      thunar_gdk_cairo_set_source_pixbuf (cr, emblem, emblem_area.x, emblem_area.y);
+      cairo_paint (cr);
+      g_object_unref (G_OBJECT (emblem));
+    }
+
+  cairo_destroy (cr);
+
+  return surface;
+}
+
+
+
+static ThunarIconComposite*
+thunar_icon_renderer_lookup_composite (ThunarIconRenderer  *icon_renderer,
+                                       ThunarIconComposite *key)
+{
+  ThunarIconComposite *composite;
+  ThunarIconComposite *last;
+
+  /* check if we already composited these pixbufs */
+  composite = g_hash_table_lookup (icon_renderer->composites, key);
+  if (G_LIKELY (composite != NULL))
+    {
+      /* move the composite to the head of the LRU queue */
+      g_queue_unlink (&icon_renderer->composite_lru, &composite->lru_link);
+      g_queue_push_head_link (&icon_renderer->composite_lru, &composite->lru_link);
+    }
+  else
+    {
+      /* drop the least recently used composites if the cache is full */
+      while (g_hash_table_size (icon_renderer->composites) >= THUNAR_ICON_RENDERER_CACHE_SIZE
+             && icon_renderer->composite_lru.tail != NULL)
+        {
+          last = icon_renderer->composite_lru.tail->data;
+          g_queue_unlink (&icon_renderer->composite_lru, &last->lru_link);
+          g_hash_table_remove (icon_renderer->composites, last);
+        }
+
+      composite = g_slice_dup (ThunarIconComposite, key);
+      composite->renderer = icon_renderer;
+      composite->surface = thunar_icon_renderer_compose (composite);
+      composite->lru_link.data = composite;
+      composite->lru_link.prev = composite->lru_link.next = NULL;
+      thunar_icon_composite_watch (composite);
+
+      g_hash_table_insert (icon_renderer->composites, composite, composite);
+      g_queue_push_head_link (&icon_renderer->composite_lru, &composite->lru_link);
+    }
+
+  return composite;
+}
+
+
+
 static void
 thunar_icon_renderer_render (GtkCellRenderer     *renderer,
                              cairo_t             *cr,
@@ -377,30 +692,30 @@ thunar_icon_renderer_render (GtkCellRenderer     *renderer,
                              GtkCellRendererState flags)
 {
   ThunarClipboardManager *clipboard;
+  ThunarIconComposite    *composite;
+  ThunarIconComposite     key = { NULL, };
   ThunarFileIconState     icon_state;
   ThunarIconRenderer     *icon_renderer = THUNAR_ICON_RENDERER (renderer);
   ThunarIconFactory      *icon_factory;
   GtkIconTheme           *icon_theme;
-  GdkRectangle            emblem_area;
   GdkRectangle            icon_area;
   GdkRectangle            clip_area;
   GdkPixbuf              *emblem;
-  GdkPixbuf              *icon;
   GdkPixbuf              *temp;
   GList                  *emblems;
   GList                  *lp;
   gint                    max_emblems;
   gint                    position;
-  gdouble                 alpha;
-  gint                    emblem_size;
-  gboolean                color_selected;
-  gboolean                color_lighten;
+  guint                   n;
   gboolean                is_expanded;
 
   if (G_UNLIKELY (icon_renderer->file == NULL))
     return;
 
-  if (G_UNLIKELY (!gdk_cairo_get_clip_rectangle (cr, &clip_area)))
+  /* check whether the cell is affected by the expose event */
+  if (G_UNLIKELY (!gdk_cairo_get_clip_rectangle (cr, &clip_area)
+      || !gdk_rectangle_intersect (&clip_area, cell_area, NULL)
+      || cell_area->width <= 0 || cell_area->height <= 0))
     return;
 
   g_object_get (renderer, "is-expanded", &is_expanded, NULL);
@@ -415,8 +730,8 @@ thunar_icon_renderer_render (GtkCellRenderer     *renderer,
   /* load the main icon */
   icon_theme = gtk_icon_theme_get_for_screen (gtk_widget_get_screen (widget));
   icon_factory = thunar_icon_factory_get_for_icon_theme (icon_theme);
-  icon = thunar_icon_factory_load_file_icon (icon_factory, icon_renderer->file, icon_state, icon_renderer->size);
-  if (G_UNLIKELY (icon == NULL))
+  key.icon = thunar_icon_factory_load_file_icon (icon_factory, icon_renderer->file, icon_state, icon_renderer->size);
+  if (G_UNLIKELY (key.icon == NULL))
     {
       g_object_unref (G_OBJECT (icon_factory));
       return;
@@ -426,70 +741,26 @@ thunar_icon_renderer_render (GtkCellRenderer     *renderer,
   if (G_UNLIKELY (icon_state == THUNAR_FILE_ICON_STATE_DROP))
     flags |= GTK_CELL_RENDERER_PRELIT;
 
-  /* determine the real icon size */
-  icon_area.width = gdk_pixbuf_get_width (icon);
-  icon_area.height = gdk_pixbuf_get_height (icon);
+  key.width = cell_area->width;
+  key.height = cell_area->height;
 
-  /* scale down the icon on-demand */
-  if (G_UNLIKELY (icon_area.width > cell_area->width || icon_area.height > cell_area->height))
+  /* use a translucent icon to represent cutted and hidden files to the user */
+  clipboard = thunar_clipboard_manager_get_for_display (gtk_widget_get_display (widget));
+  if (thunar_clipboard_manager_has_cutted_file (clipboard, icon_renderer->file))
     {
-      /* scale down to fit */
-      temp = exo_gdk_pixbuf_scale_down (icon, TRUE, MAX (1, cell_area->width), MAX (1, cell_area->height));
-      g_object_unref (G_OBJECT (icon));
-      icon = temp;
-
-      /* determine the icon dimensions again */
-      icon_area.width = gdk_pixbuf_get_width (icon);
-      icon_area.height = gdk_pixbuf_get_height (icon);
+      /* 50% translucent for cutted files */
+      key.alpha = 50;
     }
-
-  icon_area.x = cell_area->x + (cell_area->width - icon_area.width) / 2;
-  icon_area.y = cell_area->y + (cell_area->height - icon_area.height) / 2;
-
-  /* bools for cairo transformations */
-  color_selected = (flags & GTK_CELL_RENDERER_SELECTED) != 0 && icon_renderer->follow_state;
-  color_lighten = (flags & GTK_CELL_RENDERER_PRELIT) != 0 && icon_renderer->follow_state;
-
-  /* check whether the icon is affected by the expose event */
-  if (gdk_rectangle_intersect (&clip_area, &icon_area, NULL))
+  else if (thunar_file_is_hidden (icon_renderer->file))
     {
-      /* use a translucent icon to represent cutted and hidden files to the user */
-      clipboard = thunar_clipboard_manager_get_for_display (gtk_widget_get_display (widget));
-      if (thunar_clipboard_manager_has_cutted_file (clipboard, icon_renderer->file))
-        {
-          /* 50% translucent for cutted files */
-          alpha = 0.50;
-        }
-      else if (thunar_file_is_hidden (icon_renderer->file))
-        {
-          /* 75% translucent for hidden files */
-          alpha = 0.75;
-        }
-      else
-        {
-          alpha = 1.00;
-        }
-      g_object_unref (G_OBJECT (clipboard));
-
-      /* render the invalid parts of the icon */
-      thunar_gdk_cairo_set_source_pixbuf (cr, icon, icon_area.x, icon_area.y);
-      cairo_paint_with_alpha (cr, alpha);
-
-      /* check if we should render an insensitive icon */
-      if (G_UNLIKELY (gtk_widget_get_state_flags (widget) == GTK_STATE_FLAG_INSENSITIVE || !gtk_cell_renderer_get_sensitive (renderer)))
-        thunar_icon_renderer_color_insensitive(cr,widget);
-
-      /* paint the lighten mask */
-      if (color_lighten)
-        thunar_icon_renderer_color_lighten (cr, widget);
-
-      /* paint the selected mask */
-      if (color_selected)
-        thunar_icon_renderer_color_selected (cr, widget);
+      /* 75% translucent for hidden files */
+      key.alpha = 75;
     }
-
-  /* release the file's icon */
-  g_object_unref (G_OBJECT (icon));
+  else
+    {
+      key.alpha = 100;
+    }
+  g_object_unref (G_OBJECT (clipboard));
 
   /* check if we should render emblems as well */
   if (G_LIKELY (icon_renderer->emblems))
@@ -499,92 +770,17 @@ thunar_icon_renderer_render (GtkCellRenderer     *renderer,
       if (G_UNLIKELY (emblems != NULL))
         {
           /* render up to four emblems for sizes from 48 onwards, else up to 2 emblems */
-          max_emblems = (icon_renderer->size < 48) ? 2 : 4;
+          max_emblems = (icon_renderer->size < 48) ? 2 : THUNAR_ICON_RENDERER_MAX_EMBLEMS;
+
+          /* calculate the emblem size */
+          key.emblem_size = MIN ((2 * icon_renderer->size) / 3, 32);
 
-          /* render the emblems */
+          /* collect the emblems we have in the icon theme */
           for (lp = emblems, position = 0; lp != NULL && position < max_emblems; lp = lp->next)
             {
-              /* calculate the emblem size */
-              emblem_size = MIN ((2 * icon_renderer->size) / 3, 32);
-
-              /* check if we have the emblem in the icon theme */
-              emblem = thunar_icon_factory_load_icon (icon_factory, lp->data, emblem_size, FALSE);
-              if (G_UNLIKELY (emblem == NULL))
-                continue;
-
-              /* determine the dimensions of the emblem */
-              emblem_area.width = gdk_pixbuf_get_width (emblem);
-              emblem_area.height = gdk_pixbuf_get_height (emblem);
-
-              /* shrink insane emblems */
-              if (G_UNLIKELY (MAX (emblem_area.width, emblem_area.height) > emblem_size))
-                {
-                  /* scale down the emblem */
-                  temp = exo_gdk_pixbuf_scale_ratio (emblem, emblem_size);
-                  g_object_unref (G_OBJECT (emblem));
-                  emblem = temp;
-
-                  /* determine the size again */
-                  emblem_area.width = gdk_pixbuf_get_width (emblem);
-                  emblem_area.height = gdk_pixbuf_get_height (emblem);
-                }
-
-              /* determine a good position for the emblem, depending on the position index */
-              switch (position)
-                {
-                case 0: /* right/bottom */
-                  emblem_area.x = MIN (icon_area.x + icon_area.width - emblem_area.width / 2,
-                                       cell_area->x + cell_area->width - emblem_area.width);
-                  emblem_area.y = MIN (icon_area.y + icon_area.height - emblem_area.height / 2,
-                                       cell_area->y + cell_area->height -emblem_area.height);
-                  break;
-
-                case 1: /* left/bottom */
-                  emblem_area.x = MAX (icon_area.x - emblem_area.width / 2,
-                                       cell_area->x);
-                  emblem_area.y = MIN (icon_area.y + icon_area.height - emblem_area.height / 2,
-                                       cell_area->y + cell_area->height -emblem_area.height);
-                  break;
-
-                case 2: /* left/top */
-                  emblem_area.x = MAX (icon_area.x - emblem_area.width / 2,
-                                       cell_area->x);
-                  emblem_area.y = MAX (icon_area.y - emblem_area.height / 2,
-                                       cell_area->y);
-                  break;
-
-                case 3: /* right/top */
-                  emblem_area.x = MIN (icon_area.x + icon_area.width - emblem_area.width / 2,
-                                       cell_area->x + cell_area->width - emblem_area.width);
-                  emblem_area.y = MAX (icon_area.y - emblem_area.height / 2,
-                                       cell_area->y);
-                  break;
-
-                default:
-                  _thunar_assert_not_reached ();
-                }
-
-              /* render the emblem */
-              if (gdk_rectangle_intersect (&clip_area, &emblem_area, NULL))
-                {
-                  /* render the invalid parts of the icon */
-                  thunar_gdk_cairo_set_source_pixbuf (cr, emblem, emblem_area.x, emblem_area.y);
-                  cairo_paint (cr);
-
-                  /* paint the lighten mask */
-                  if (color_lighten)
-                    thunar_icon_renderer_color_lighten (cr, widget);
-
-                  /* paint the selected mask */
-                  if (color_selected)
-                    thunar_icon_renderer_color_selected (cr, widget);
-                }
-
-              /* release the emblem */
-              g_object_unref (G_OBJECT (emblem));
-
-              /* advance the position index */
-              ++position;
+              emblem = thunar_icon_factory_load_icon (icon_factory, lp->data, key.emblem_size, FALSE);
+              if (G_LIKELY (emblem != NULL))
+                key.emblems[position++] = emblem;
             }
 
           /* release the emblem name list */
@@ -592,6 +788,60 @@ thunar_icon_renderer_render (GtkCellRenderer     *renderer,
         }
     }
 
+  if (G_LIKELY (key.emblems[0] == NULL && key.alpha == 100))
+    {
+      /* nothing to composite, so paint the icon directly */
+      icon_area.width = gdk_pixbuf_get_width (key.icon);
+      icon_area.height = gdk_pixbuf_get_height (key.icon);
+
+      /* scale down the icon on-demand */
+      if (G_UNLIKELY (icon_area.width > cell_area->width || icon_area.height > cell_area->height))
+        {
+          /* scale down to fit */
+          temp = exo_gdk_pixbuf_scale_down (key.icon, TRUE, MAX (1, cell_area->width), MAX (1, cell_area->height));
+          g_object_unref (G_OBJECT (key.icon));
+          key.icon = temp;
+
+          /* determine the icon dimensions again */
+          icon_area.width = gdk_pixbuf_get_width (key.icon);
+          icon_area.height = gdk_pixbuf_get_height (key.icon);
+        }
+
+      icon_area.x = cell_area->x + (cell_area->width - icon_area.width) / 2;
+      icon_area.y = cell_area->y + (cell_area->height - icon_area.height) / 2;
+
+      thunar_gdk_cairo_set_source_pixbuf (cr, key.icon, icon_area.x, icon_area.y);
+      cairo_paint (cr);
+    }
+  else
+    {
+      /* lookup or create the composited icon */
+      composite = thunar_icon_renderer_lookup_composite (icon_renderer, &key);
+
+      /* render the invalid parts of the icon and its emblems */
+      cairo_set_source_surface (cr, composite->surface, cell_area->x, cell_area->y);
+      cairo_paint (cr);
+    }
+
+  /* release the pixbufs, the composite only watches them, so it
+   * must not be used after this point */
+  g_object_unref (G_OBJECT (key.icon));
+  for (n = 0; n < THUNAR_ICON_RENDERER_MAX_EMBLEMS; ++n)
+    if (key.emblems[n] != NULL)
+      g_object_unref (G_OBJECT (key.emblems[n]));
+
+  /* check if we should render an insensitive icon */
+  if (G_UNLIKELY (gtk_widget_get_state_flags (widget) == GTK_STATE_FLAG_INSENSITIVE || !gtk_cell_renderer_get_sensitive (renderer)))
+    thunar_icon_renderer_color_insensitive (cr, widget);
+
+  /* paint the lighten mask */
+  if ((flags & GTK_CELL_RENDERER_PRELIT) != 0 && icon_renderer->follow_state)
+    thunar_icon_renderer_color_lighten (cr, widget);
+
+  /* paint the selected mask */
+  if ((flags & GTK_CELL_RENDERER_SELECTED) != 0 && icon_renderer->follow_state)
+    thunar_icon_renderer_color_selected (cr, widget);
+
   /* release our reference on the icon factory */
   g_object_unref (G_OBJECT (icon_factory));
 }
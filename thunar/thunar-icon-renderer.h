@@ -49,6 +49,10 @@ struct _ThunarIconRenderer
   gboolean       emblems;
   gboolean       follow_state;
   ThunarIconSize size;
+
+  /* cache of composited icons and emblems */
+  GHashTable    *composites;
+  GQueue         composite_lru;
 };
 
 GType            thunar_icon_renderer_get_type (void) G_GNUC_CONST;
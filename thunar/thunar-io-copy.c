@@ -0,0 +1,1090 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* for copy_file_range() */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_SYS_IOCTL_H
+#include <sys/ioctl.h>
+#endif
+#ifdef HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
+#ifdef HAVE_LINUX_FS_H
+#include <linux/fs.h>
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <glib/gstdio.h>
+
+#include <libxfce4util/libxfce4util.h>
+
+#include <thunar/thunar-io-copy.h>
+#include <thunar/thunar-private.h>
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+
+
+/* number of bytes copied in-kernel before reporting progress */
+#define THUNAR_IO_COPY_CHUNK_SIZE (8 * 1024 * 1024)
+
+/* size of the buffer if sparse files are copied through userspace */
+#define THUNAR_IO_COPY_BUFFER_SIZE (256 * 1024)
+
+/* primes of the XXH64 hash, see thunar_io_copy_hash() */
+#define THUNAR_IO_COPY_PRIME1 G_GUINT64_CONSTANT (11400714785074694791)
+#define THUNAR_IO_COPY_PRIME2 G_GUINT64_CONSTANT (14029467366897019727)
+#define THUNAR_IO_COPY_PRIME3 G_GUINT64_CONSTANT (1609587929392839161)
+#define THUNAR_IO_COPY_PRIME4 G_GUINT64_CONSTANT (9650029242287828579)
+#define THUNAR_IO_COPY_PRIME5 G_GUINT64_CONSTANT (2870177450012600261)
+
+#define THUNAR_IO_COPY_ROTL(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+
+
+typedef enum
+{
+  THUNAR_IO_COPY_RESULT_DONE,
+  THUNAR_IO_COPY_RESULT_UNSUPPORTED,
+  THUNAR_IO_COPY_RESULT_FAILED,
+} ThunarIoCopyResult;
+
+
+
+static ThunarIoCopyResult
+thunar_io_copy_chunks (gint                   source_fd,
+                       gint                   target_fd,
+                       goffset                size,
+                       ThunarIoCopyStrategy   strategy,
+                       GCancellable          *cancellable,
+                       GFileProgressCallback  progress_callback,
+                       gpointer               progress_callback_data,
+                       GError               **error)
+{
+  goffset copied = 0;
+  gssize  n;
+
+  for (;;)
+    {
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+        return THUNAR_IO_COPY_RESULT_FAILED;
+
+      switch (strategy)
+        {
+#ifdef HAVE_COPY_FILE_RANGE
+        case THUNAR_IO_COPY_FILE_RANGE:
+          n = copy_file_range (source_fd, NULL, target_fd, NULL, THUNAR_IO_COPY_CHUNK_SIZE, 0);
+          break;
+#endif
+
+#ifdef HAVE_SENDFILE
+        case THUNAR_IO_COPY_SENDFILE:
+          n = sendfile (target_fd, source_fd, NULL, THUNAR_IO_COPY_CHUNK_SIZE);
+          break;
+#endif
+
+        default:
+          return THUNAR_IO_COPY_RESULT_UNSUPPORTED;
+        }
+
+      if (G_UNLIKELY (n < 0))
+        {
+          if (errno == EINTR)
+            continue;
+
+          /* the kernel or filesystem can't do this, try the next strategy
+           * as long as nothing was copied so far */
+          if (copied == 0
+              && (errno == ENOSYS || errno == EXDEV || errno == EINVAL
+                  || errno == EOPNOTSUPP || errno == EBADF))
+            return THUNAR_IO_COPY_RESULT_UNSUPPORTED;
+
+          g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                       _("Error while copying file: %s"), g_strerror (errno));
+          return THUNAR_IO_COPY_RESULT_FAILED;
+        }
+
+      /* end of the source file */
+      if (n == 0)
+        return THUNAR_IO_COPY_RESULT_DONE;
+
+      copied += n;
+
+      if (progress_callback != NULL)
+        (*progress_callback) (copied, MAX (copied, size), progress_callback_data);
+    }
+}
+
+
+
+static ThunarIoCopyResult
+thunar_io_copy_range (gint          source_fd,
+                      gint          target_fd,
+                      goffset       offset,
+                      goffset       end,
+                      gboolean     *use_file_range,
+                      gchar       **buffer,
+                      GCancellable *cancellable,
+                      GError      **error)
+{
+  gssize n;
+  gssize written;
+  gssize m;
+
+  while (offset < end)
+    {
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+        return THUNAR_IO_COPY_RESULT_FAILED;
+
+#ifdef HAVE_COPY_FILE_RANGE
+      if (*use_file_range)
+        {
+          loff_t source_offset = offset;
+          loff_t target_offset = offset;
+
+          n = copy_file_range (source_fd, &source_offset, target_fd, &target_offset,
+                               MIN (end - offset, THUNAR_IO_COPY_CHUNK_SIZE), 0);
+          if (G_UNLIKELY (n < 0))
+            {
+              if (errno == EINTR)
+                continue;
+
+              /* copy the data through userspace instead */
+              if (errno == ENOSYS || errno == EXDEV || errno == EINVAL
+                  || errno == EOPNOTSUPP || errno == EBADF)
+                {
+                  *use_file_range = FALSE;
+                  continue;
+                }
+
+              goto error;
+            }
+        }
+      else
+#endif
+        {
+          if (*buffer == NULL)
+            *buffer = g_malloc (THUNAR_IO_COPY_BUFFER_SIZE);
+
+          n = pread (source_fd, *buffer, MIN (end - offset, THUNAR_IO_COPY_BUFFER_SIZE), offset);
+          if (G_UNLIKELY (n < 0))
+            {
+              if (errno == EINTR)
+                continue;
+              goto error;
+            }
+
+          for (written = 0; written < n; written += m)
+            {
+              m = pwrite (target_fd, *buffer + written, n - written, offset + written);
+              if (G_UNLIKELY (m < 0))
+                {
+                  if (errno == EINTR)
+                    {
+                      m = 0;
+                      continue;
+                    }
+                  goto error;
+                }
+            }
+        }
+
+      /* the source was truncated meanwhile */
+      if (G_UNLIKELY (n == 0))
+        break;
+
+      offset += n;
+    }
+
+  return THUNAR_IO_COPY_RESULT_DONE;
+
+error:
+  g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+               _("Error while copying file: %s"), g_strerror (errno));
+  return THUNAR_IO_COPY_RESULT_FAILED;
+}
+
+
+
+static ThunarIoCopyResult
+thunar_io_copy_sparse (gint                   source_fd,
+                       gint                   target_fd,
+                       goffset                size,
+                       GCancellable          *cancellable,
+                       GFileProgressCallback  progress_callback,
+                       gpointer               progress_callback_data,
+                       GError               **error)
+{
+#if defined (SEEK_DATA) && defined (SEEK_HOLE)
+  ThunarIoCopyResult result = THUNAR_IO_COPY_RESULT_DONE;
+  gboolean           use_file_range = TRUE;
+  goffset            data_start;
+  goffset            data_end = 0;
+  gchar             *buffer = NULL;
+
+  /* only copy the data regions of the source, the target is a new
+   * file, so everything we skip ends up as a hole */
+  for (;;)
+    {
+      data_start = lseek (source_fd, data_end, SEEK_DATA);
+      if (data_start < 0)
+        {
+          /* only a hole is left until the end of the file */
+          if (errno == ENXIO)
+            break;
+
+          /* the filesystem doesn't know about holes */
+          if (data_end == 0 && (errno == EINVAL || errno == EOPNOTSUPP))
+            {
+              result = THUNAR_IO_COPY_RESULT_UNSUPPORTED;
+              break;
+            }
+
+          g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                       _("Error while copying file: %s"), g_strerror (errno));
+          result = THUNAR_IO_COPY_RESULT_FAILED;
+          break;
+        }
+
+      data_end = lseek (source_fd, data_start, SEEK_HOLE);
+      if (G_UNLIKELY (data_end < 0))
+        {
+          g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                       _("Error while copying file: %s"), g_strerror (errno));
+          result = THUNAR_IO_COPY_RESULT_FAILED;
+          break;
+        }
+
+      result = thunar_io_copy_range (source_fd, target_fd, data_start, data_end,
+                                     &use_file_range, &buffer, cancellable, error);
+      if (result != THUNAR_IO_COPY_RESULT_DONE)
+        break;
+
+      /* progress is reported over the logical size, holes included */
+      if (progress_callback != NULL)
+        (*progress_callback) (MIN (data_end, size), size, progress_callback_data);
+    }
+
+  g_free (buffer);
+
+  /* extend the target over a trailing hole */
+  if (result == THUNAR_IO_COPY_RESULT_DONE)
+    {
+      if (G_UNLIKELY (ftruncate (target_fd, size) < 0))
+        {
+          g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                       _("Error while copying file: %s"), g_strerror (errno));
+          return THUNAR_IO_COPY_RESULT_FAILED;
+        }
+
+      if (progress_callback != NULL)
+        (*progress_callback) (size, size, progress_callback_data);
+    }
+
+  return result;
+#else
+  return THUNAR_IO_COPY_RESULT_UNSUPPORTED;
+#endif
+}
+
+
+
+static gint
+thunar_io_copy_open_source (const gchar *path,
+                            gint         flags,
+                            struct stat *statb)
+{
+  gint fd;
+
+  /* open without blocking, so a FIFO in the tree does not hang the
+   * job, and only continue once the source is known to be regular */
+#ifdef O_NONBLOCK
+  fd = g_open (path, flags | O_NONBLOCK, 0);
+#else
+  fd = g_open (path, flags, 0);
+#endif
+  if (fd < 0)
+    return -1;
+
+  if (fstat (fd, statb) < 0 || !S_ISREG (statb->st_mode))
+    {
+      close (fd);
+      return -1;
+    }
+
+#ifdef O_NONBLOCK
+  /* regular files never block, but don't leave the flag around */
+  fcntl (fd, F_SETFL, fcntl (fd, F_GETFL) & ~O_NONBLOCK);
+#endif
+
+  return fd;
+}
+
+
+
+static ThunarIoCopyResult
+thunar_io_copy_native (GFile                 *source_file,
+                       GFile                 *target_file,
+                       GFileCopyFlags         flags,
+                       gboolean               keep_partial,
+                       GCancellable          *cancellable,
+                       GFileProgressCallback  progress_callback,
+                       gpointer               progress_callback_data,
+                       ThunarIoCopyStrategy  *strategy_return,
+                       GError               **error)
+{
+  ThunarIoCopyStrategy strategy;
+  ThunarIoCopyResult   result = THUNAR_IO_COPY_RESULT_UNSUPPORTED;
+  struct stat          statb;
+  gchar               *source_path;
+  gchar               *target_path;
+  gint                 source_fd = -1;
+  gint                 target_fd = -1;
+  gint                 source_flags = O_RDONLY | O_CLOEXEC;
+  gboolean             created = FALSE;
+  gboolean             sparse;
+
+  /* conflicts, backups and replacing are left to gio */
+  if ((flags & (G_FILE_COPY_OVERWRITE | G_FILE_COPY_BACKUP)) != 0)
+    return THUNAR_IO_COPY_RESULT_UNSUPPORTED;
+
+  source_path = g_file_get_path (source_file);
+  target_path = g_file_get_path (target_file);
+  if (source_path == NULL || target_path == NULL)
+    goto out;
+
+#ifdef O_NOFOLLOW
+  if ((flags & G_FILE_COPY_NOFOLLOW_SYMLINKS) != 0)
+    source_flags |= O_NOFOLLOW;
+#endif
+
+  /* only regular files are copied natively, gio reports the
+   * errors for everything else */
+  source_fd = thunar_io_copy_open_source (source_path, source_flags, &statb);
+  if (source_fd < 0)
+    goto out;
+
+  /* never replace anything, gio reports the conflict */
+  target_fd = g_open (target_path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+  if (target_fd < 0)
+    goto out;
+  created = TRUE;
+
+  /* preserve the holes if less blocks are allocated than the size requires */
+  sparse = (goffset) statb.st_blocks * 512 < (goffset) statb.st_size;
+
+  for (strategy = THUNAR_IO_COPY_CLONE; strategy <= THUNAR_IO_COPY_SENDFILE; ++strategy)
+    {
+      if (strategy == THUNAR_IO_COPY_CLONE)
+        {
+#if defined (HAVE_SYS_IOCTL_H) && defined (FICLONE)
+          /* share the extents of the source on copy-on-write filesystems */
+          if (ioctl (target_fd, FICLONE, source_fd) == 0)
+            {
+              if (progress_callback != NULL)
+                (*progress_callback) (statb.st_size, statb.st_size, progress_callback_data);
+
+              result = THUNAR_IO_COPY_RESULT_DONE;
+            }
+#endif
+        }
+      else if (strategy == THUNAR_IO_COPY_SPARSE)
+        {
+          if (sparse)
+            {
+              result = thunar_io_copy_sparse (source_fd, target_fd, statb.st_size,
+                                              cancellable, progress_callback,
+                                              progress_callback_data, error);
+            }
+        }
+      else
+        {
+          result = thunar_io_copy_chunks (source_fd, target_fd, statb.st_size, strategy,
+                                          cancellable, progress_callback,
+                                          progress_callback_data, error);
+        }
+
+      if (result != THUNAR_IO_COPY_RESULT_UNSUPPORTED)
+        break;
+    }
+
+  if (result == THUNAR_IO_COPY_RESULT_DONE)
+    {
+      if (G_UNLIKELY (close (target_fd) < 0))
+        {
+          g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                       _("Error while copying file: %s"), g_strerror (errno));
+          result = THUNAR_IO_COPY_RESULT_FAILED;
+        }
+      target_fd = -1;
+
+      *strategy_return = strategy;
+    }
+
+out:
+  if (target_fd >= 0)
+    close (target_fd);
+  if (source_fd >= 0)
+    close (source_fd);
+
+  /* don't leave a partial target behind, unless the caller
+   * wants to resume the cancelled copy later on */
+  if (result != THUNAR_IO_COPY_RESULT_DONE && created
+      && !(keep_partial && g_cancellable_is_cancelled (cancellable)))
+    g_unlink (target_path);
+
+  g_free (source_path);
+  g_free (target_path);
+
+  return result;
+}
+
+
+
+static guint64
+thunar_io_copy_hash (const gchar *data,
+                     gsize        length,
+                     guint64      seed)
+{
+  const gchar *end = data + length;
+  guint64      hash;
+  guint64      word;
+
+  /* a single lane variant of XXH64, the data is mixed in 64 bit
+   * words, the remaining bytes one at a time */
+  hash = seed + THUNAR_IO_COPY_PRIME5 + length;
+
+  for (; data + 8 <= end; data += 8)
+    {
+      memcpy (&word, data, 8);
+      word *= THUNAR_IO_COPY_PRIME2;
+      word = THUNAR_IO_COPY_ROTL (word, 31);
+      word *= THUNAR_IO_COPY_PRIME1;
+
+      hash ^= word;
+      hash = THUNAR_IO_COPY_ROTL (hash, 27) * THUNAR_IO_COPY_PRIME1 + THUNAR_IO_COPY_PRIME4;
+    }
+
+  for (; data < end; ++data)
+    {
+      hash ^= (guchar) *data * THUNAR_IO_COPY_PRIME5;
+      hash = THUNAR_IO_COPY_ROTL (hash, 11) * THUNAR_IO_COPY_PRIME1;
+    }
+
+  /* avalanche */
+  hash ^= hash >> 33;
+  hash *= THUNAR_IO_COPY_PRIME2;
+  hash ^= hash >> 29;
+  hash *= THUNAR_IO_COPY_PRIME3;
+  hash ^= hash >> 32;
+
+  return hash;
+}
+
+
+
+static gssize
+thunar_io_copy_read (gint    fd,
+                     gchar  *buffer,
+                     gsize   size,
+                     goffset offset)
+{
+  gsize  done;
+  gssize n;
+
+  /* fill the whole buffer unless the end of the file is reached, so
+   * the source and target are hashed in exactly the same blocks */
+  for (done = 0; done < size; done += n)
+    {
+      n = pread (fd, buffer + done, size - done, offset + done);
+      if (G_UNLIKELY (n < 0))
+        {
+          if (errno == EINTR)
+            {
+              n = 0;
+              continue;
+            }
+          return -1;
+        }
+
+      if (n == 0)
+        break;
+    }
+
+  return done;
+}
+
+
+
+static ThunarIoCopyResult
+thunar_io_copy_verified (GFile                 *source_file,
+                         GFile                 *target_file,
+                         GFileCopyFlags         flags,
+                         gboolean               keep_partial,
+                         GCancellable          *cancellable,
+                         GFileProgressCallback  progress_callback,
+                         gpointer               progress_callback_data,
+                         GError               **error)
+{
+  ThunarIoCopyResult result = THUNAR_IO_COPY_RESULT_UNSUPPORTED;
+  struct stat        statb;
+  guint64            source_hash = 0;
+  guint64            target_hash = 0;
+  goffset            source_size;
+  goffset            offset;
+  gssize             n;
+  gssize             m;
+  gssize             written;
+  gchar             *source_path;
+  gchar             *target_path;
+  gchar             *buffer = NULL;
+  gint               source_fd = -1;
+  gint               target_fd = -1;
+  gint               source_flags = O_RDONLY | O_CLOEXEC;
+  gboolean           created = FALSE;
+
+  /* conflicts, backups and replacing are left to gio */
+  if ((flags & (G_FILE_COPY_OVERWRITE | G_FILE_COPY_BACKUP)) != 0)
+    return THUNAR_IO_COPY_RESULT_UNSUPPORTED;
+
+  source_path = g_file_get_path (source_file);
+  target_path = g_file_get_path (target_file);
+  if (source_path == NULL || target_path == NULL)
+    goto out;
+
+#ifdef O_NOFOLLOW
+  if ((flags & G_FILE_COPY_NOFOLLOW_SYMLINKS) != 0)
+    source_flags |= O_NOFOLLOW;
+#endif
+
+  source_fd = thunar_io_copy_open_source (source_path, source_flags, &statb);
+  if (source_fd < 0)
+    goto out;
+
+  /* the target is read back below, so it is opened for reading too */
+  target_fd = g_open (target_path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+  if (target_fd < 0)
+    goto out;
+  created = TRUE;
+
+  buffer = g_malloc (THUNAR_IO_COPY_BUFFER_SIZE);
+
+  /* hash the source data while it passes through the buffer */
+  for (offset = 0;; offset += n)
+    {
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+        {
+          result = THUNAR_IO_COPY_RESULT_FAILED;
+          goto out;
+        }
+
+      n = thunar_io_copy_read (source_fd, buffer, THUNAR_IO_COPY_BUFFER_SIZE, offset);
+      if (G_UNLIKELY (n < 0))
+        goto error;
+      if (n == 0)
+        break;
+
+      source_hash = thunar_io_copy_hash (buffer, n, source_hash);
+
+      for (written = 0; written < n; written += m)
+        {
+          m = pwrite (target_fd, buffer + written, n - written, offset + written);
+          if (G_UNLIKELY (m < 0))
+            {
+              if (errno == EINTR)
+                {
+                  m = 0;
+                  continue;
+                }
+              goto error;
+            }
+        }
+
+      if (progress_callback != NULL)
+        (*progress_callback) (offset + n, MAX (offset + n, statb.st_size), progress_callback_data);
+    }
+  source_size = offset;
+
+  /* write the target to the disk and drop it from the page cache,
+   * so it is really read back from the disk below */
+#ifdef HAVE_FDATASYNC
+  if (G_UNLIKELY (fdatasync (target_fd) < 0))
+    goto error;
+#else
+  if (G_UNLIKELY (fsync (target_fd) < 0))
+    goto error;
+#endif
+#if defined (HAVE_POSIX_FADVISE) && defined (POSIX_FADV_DONTNEED)
+  posix_fadvise (target_fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+
+  /* only the target is read again, the source was hashed during the copy */
+  for (offset = 0;; offset += n)
+    {
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+        {
+          result = THUNAR_IO_COPY_RESULT_FAILED;
+          goto out;
+        }
+
+      n = thunar_io_copy_read (target_fd, buffer, THUNAR_IO_COPY_BUFFER_SIZE, offset);
+      if (G_UNLIKELY (n < 0))
+        goto error;
+      if (n == 0)
+        break;
+
+      target_hash = thunar_io_copy_hash (buffer, n, target_hash);
+    }
+
+  if (G_UNLIKELY (offset != source_size || target_hash != source_hash))
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                           _("The copied data does not match the source file"));
+      result = THUNAR_IO_COPY_RESULT_FAILED;
+      goto out;
+    }
+
+  if (G_UNLIKELY (close (target_fd) < 0))
+    {
+      target_fd = -1;
+      goto error;
+    }
+  target_fd = -1;
+
+  result = THUNAR_IO_COPY_RESULT_DONE;
+  goto out;
+
+error:
+  g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+               _("Error while copying file: %s"), g_strerror (errno));
+  result = THUNAR_IO_COPY_RESULT_FAILED;
+
+out:
+  if (target_fd >= 0)
+    close (target_fd);
+  if (source_fd >= 0)
+    close (source_fd);
+
+  /* don't leave a partial or corrupt target behind, unless the
+   * caller wants to resume the cancelled copy later on */
+  if (result != THUNAR_IO_COPY_RESULT_DONE && created
+      && !(keep_partial && g_cancellable_is_cancelled (cancellable)))
+    g_unlink (target_path);
+
+  g_free (buffer);
+  g_free (source_path);
+  g_free (target_path);
+
+  return result;
+}
+
+
+
+/**
+ * thunar_io_copy_file:
+ * @source_file            : the #GFile to copy.
+ * @target_file            : the destination #GFile.
+ * @flags                  : #GFileCopyFlags as for g_file_copy().
+ * @keep_partial           : whether to keep a partial target if the copy is cancelled.
+ * @cancellable            : a #GCancellable or %NULL.
+ * @progress_callback      : the progress callback or %NULL.
+ * @progress_callback_data : user data for @progress_callback.
+ * @strategy_return        : return location for the #ThunarIoCopyStrategy or %NULL.
+ * @error                  : return location for errors or %NULL.
+ *
+ * Works like g_file_copy(), but copies regular local files without
+ * moving the data through userspace if possible: the target is either
+ * a reflink of the source (FICLONE) or the data is copied in-kernel
+ * using copy_file_range() or sendfile(). Sparse files only have their
+ * data regions copied, so the holes are preserved in the target.
+ * Everything else, including replacing existing targets, is handed over
+ * to g_file_copy().
+ *
+ * If @keep_partial is %TRUE and the native copy is cancelled, the
+ * partial target is kept, so it can be completed with
+ * thunar_io_copy_resume_file().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise.
+ **/
+gboolean
+thunar_io_copy_file (GFile                 *source_file,
+                     GFile                 *target_file,
+                     GFileCopyFlags         flags,
+                     gboolean               keep_partial,
+                     GCancellable          *cancellable,
+                     GFileProgressCallback  progress_callback,
+                     gpointer               progress_callback_data,
+                     ThunarIoCopyStrategy  *strategy_return,
+                     GError               **error)
+{
+  ThunarIoCopyStrategy strategy = THUNAR_IO_COPY_GIO;
+  ThunarIoCopyResult   result;
+  gboolean             succeed;
+
+  _thunar_return_val_if_fail (G_IS_FILE (source_file), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (target_file), FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  result = thunar_io_copy_native (source_file, target_file, flags, keep_partial, cancellable,
+                                  progress_callback, progress_callback_data,
+                                  &strategy, error);
+
+  if (result == THUNAR_IO_COPY_RESULT_DONE)
+    {
+      /* copy the same attributes g_file_copy() would copy, failing
+       * to do so is not a hard error (same as in gio) */
+      g_file_copy_attributes (source_file, target_file, flags, cancellable, NULL);
+      succeed = TRUE;
+    }
+  else if (result == THUNAR_IO_COPY_RESULT_FAILED)
+    {
+      succeed = FALSE;
+    }
+  else
+    {
+      /* use the generic gio implementation */
+      strategy = THUNAR_IO_COPY_GIO;
+      succeed = g_file_copy (source_file, target_file, flags, cancellable,
+                             progress_callback, progress_callback_data, error);
+    }
+
+  if (strategy_return != NULL)
+    *strategy_return = strategy;
+
+  return succeed;
+}
+
+
+
+/**
+ * thunar_io_copy_file_verified:
+ * @source_file            : the #GFile to copy.
+ * @target_file            : the destination #GFile.
+ * @flags                  : #GFileCopyFlags as for g_file_copy().
+ * @keep_partial           : whether to keep a partial target if the copy is cancelled.
+ * @cancellable            : a #GCancellable or %NULL.
+ * @progress_callback      : the progress callback or %NULL.
+ * @progress_callback_data : user data for @progress_callback.
+ * @strategy_return        : return location for the #ThunarIoCopyStrategy or %NULL.
+ * @error                  : return location for errors or %NULL.
+ *
+ * Works like thunar_io_copy_file(), but makes sure the data arrived
+ * in the target. For regular local files the data is hashed while it
+ * is copied through userspace, then the target is flushed, dropped
+ * from the page cache and read back once to compare the hashes. Other
+ * files are compared with the source after copying them.
+ *
+ * If the data does not match, the target is removed and an error
+ * is returned.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise.
+ **/
+gboolean
+thunar_io_copy_file_verified (GFile                 *source_file,
+                              GFile                 *target_file,
+                              GFileCopyFlags         flags,
+                              gboolean               keep_partial,
+                              GCancellable          *cancellable,
+                              GFileProgressCallback  progress_callback,
+                              gpointer               progress_callback_data,
+                              ThunarIoCopyStrategy  *strategy_return,
+                              GError               **error)
+{
+  ThunarIoCopyStrategy strategy = THUNAR_IO_COPY_VERIFIED;
+  ThunarIoCopyResult   result;
+  GFileQueryInfoFlags  query_flags = G_FILE_QUERY_INFO_NONE;
+  gboolean             succeed;
+  GError              *err = NULL;
+
+  _thunar_return_val_if_fail (G_IS_FILE (source_file), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (target_file), FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  result = thunar_io_copy_verified (source_file, target_file, flags, keep_partial, cancellable,
+                                    progress_callback, progress_callback_data, error);
+
+  if (result == THUNAR_IO_COPY_RESULT_DONE)
+    {
+      g_file_copy_attributes (source_file, target_file, flags, cancellable, NULL);
+      succeed = TRUE;
+    }
+  else if (result == THUNAR_IO_COPY_RESULT_FAILED)
+    {
+      succeed = FALSE;
+    }
+  else
+    {
+      succeed = thunar_io_copy_file (source_file, target_file, flags, keep_partial, cancellable,
+                                     progress_callback, progress_callback_data,
+                                     &strategy, error);
+
+      if ((flags & G_FILE_COPY_NOFOLLOW_SYMLINKS) != 0)
+        query_flags = G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS;
+
+      /* only the data of regular files can be compared */
+      if (succeed && g_file_query_file_type (source_file, query_flags, cancellable) == G_FILE_TYPE_REGULAR
+          && !thunar_io_copy_compare_files (source_file, target_file, cancellable, &err))
+        {
+          if (err == NULL)
+            {
+              g_set_error_literal (&err, G_IO_ERROR, G_IO_ERROR_FAILED,
+                                   _("The copied data does not match the source file"));
+            }
+          g_propagate_error (error, err);
+
+          g_file_delete (target_file, NULL, NULL);
+          succeed = FALSE;
+        }
+    }
+
+  if (strategy_return != NULL)
+    *strategy_return = strategy;
+
+  return succeed;
+}
+
+
+
+/**
+ * thunar_io_copy_strategy_get_name:
+ * @strategy : a #ThunarIoCopyStrategy.
+ *
+ * Returns a short, untranslated name for @strategy, suitable
+ * for the final status message of a transfer job.
+ *
+ * Return value: the name of @strategy.
+ **/
+const gchar *
+thunar_io_copy_strategy_get_name (ThunarIoCopyStrategy strategy)
+{
+  static const gchar *names[] = { "gio", "clone", "sparse", "copy_file_range", "sendfile", "verified" };
+
+  _thunar_return_val_if_fail (strategy < THUNAR_IO_COPY_N_STRATEGIES, NULL);
+
+  return names[strategy];
+}
+
+
+
+/**
+ * thunar_io_copy_compare_files:
+ * @file1       : a #GFile.
+ * @file2       : another #GFile.
+ * @cancellable : a #GCancellable or %NULL.
+ * @error       : return location for errors or %NULL.
+ *
+ * Compares the contents of @file1 and @file2, stopping at the
+ * first difference.
+ *
+ * Return value: %TRUE if both files have the same contents, %FALSE
+ *               if they differ or on error.
+ **/
+gboolean
+thunar_io_copy_compare_files (GFile         *file1,
+                              GFile         *file2,
+                              GCancellable  *cancellable,
+                              GError       **error)
+{
+  GInputStream *stream1;
+  GInputStream *stream2 = NULL;
+  gboolean      equal = FALSE;
+  gchar        *buffer1;
+  gchar        *buffer2;
+  gsize         n1;
+  gsize         n2;
+
+  _thunar_return_val_if_fail (G_IS_FILE (file1), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (file2), FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  stream1 = G_INPUT_STREAM (g_file_read (file1, cancellable, error));
+  if (stream1 != NULL)
+    stream2 = G_INPUT_STREAM (g_file_read (file2, cancellable, error));
+  if (stream2 == NULL)
+    {
+      if (stream1 != NULL)
+        g_object_unref (stream1);
+      return FALSE;
+    }
+
+  buffer1 = g_malloc (THUNAR_IO_COPY_BUFFER_SIZE);
+  buffer2 = g_malloc (THUNAR_IO_COPY_BUFFER_SIZE);
+
+  for (;;)
+    {
+      if (!g_input_stream_read_all (stream1, buffer1, THUNAR_IO_COPY_BUFFER_SIZE, &n1, cancellable, error)
+          || !g_input_stream_read_all (stream2, buffer2, THUNAR_IO_COPY_BUFFER_SIZE, &n2, cancellable, error))
+        break;
+
+      if (n1 != n2 || memcmp (buffer1, buffer2, n1) != 0)
+        break;
+
+      /* both files ended at the same position */
+      if (n1 < THUNAR_IO_COPY_BUFFER_SIZE)
+        {
+          equal = TRUE;
+          break;
+        }
+    }
+
+  g_free (buffer1);
+  g_free (buffer2);
+
+  g_object_unref (stream1);
+  g_object_unref (stream2);
+
+  return equal;
+}
+
+
+
+/**
+ * thunar_io_copy_resume_file:
+ * @source_file            : the #GFile to copy.
+ * @target_file            : the partial copy of @source_file.
+ * @cancellable            : a #GCancellable or %NULL.
+ * @progress_callback      : the progress callback or %NULL.
+ * @progress_callback_data : user data for @progress_callback.
+ * @error                  : return location for errors or %NULL.
+ *
+ * Continues an interrupted copy of @source_file to @target_file by
+ * appending the missing data to @target_file. The tail of the data
+ * that is already there is verified against @source_file first.
+ *
+ * If the copy cannot be resumed, e.g. because the files are not local
+ * or the partial copy does not match the source, %FALSE is returned
+ * without setting @error and the caller has to copy the file from
+ * scratch. If appending the data fails or @cancellable is cancelled,
+ * %FALSE is returned and @error is set.
+ *
+ * Return value: %TRUE if the copy was completed, %FALSE otherwise.
+ **/
+gboolean
+thunar_io_copy_resume_file (GFile                 *source_file,
+                            GFile                 *target_file,
+                            GCancellable          *cancellable,
+                            GFileProgressCallback  progress_callback,
+                            gpointer               progress_callback_data,
+                            GError               **error)
+{
+  ThunarIoCopyResult result = THUNAR_IO_COPY_RESULT_UNSUPPORTED;
+  struct stat        source_statb;
+  struct stat        target_statb;
+  gboolean           use_file_range = TRUE;
+  goffset            offset;
+  goffset            end;
+  gssize             tail;
+  gchar             *source_path;
+  gchar             *target_path;
+  gchar             *buffer = NULL;
+  gint               source_fd = -1;
+  gint               target_fd = -1;
+
+  _thunar_return_val_if_fail (G_IS_FILE (source_file), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (target_file), FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  source_path = g_file_get_path (source_file);
+  target_path = g_file_get_path (target_file);
+  if (source_path == NULL || target_path == NULL)
+    goto out;
+
+  source_fd = g_open (source_path, O_RDONLY | O_CLOEXEC, 0);
+  target_fd = g_open (target_path, O_RDWR | O_CLOEXEC, 0);
+  if (source_fd < 0 || target_fd < 0
+      || fstat (source_fd, &source_statb) < 0 || fstat (target_fd, &target_statb) < 0
+      || !S_ISREG (source_statb.st_mode) || !S_ISREG (target_statb.st_mode)
+      || target_statb.st_size > source_statb.st_size)
+    goto out;
+
+  /* make sure the data we append to belongs to the source */
+  offset = target_statb.st_size;
+  tail = MIN (offset, THUNAR_IO_COPY_BUFFER_SIZE / 2);
+  buffer = g_malloc (THUNAR_IO_COPY_BUFFER_SIZE);
+  if (tail > 0
+      && (pread (source_fd, buffer, tail, offset - tail) != tail
+          || pread (target_fd, buffer + tail, tail, offset - tail) != tail
+          || memcmp (buffer, buffer + tail, tail) != 0))
+    goto out;
+
+  /* append the missing data in chunks, reporting the progress */
+  for (result = THUNAR_IO_COPY_RESULT_DONE;
+       result == THUNAR_IO_COPY_RESULT_DONE && offset < source_statb.st_size;
+       offset = end)
+    {
+      end = MIN (offset + THUNAR_IO_COPY_CHUNK_SIZE, source_statb.st_size);
+      result = thunar_io_copy_range (source_fd, target_fd, offset, end,
+                                     &use_file_range, &buffer, cancellable, error);
+
+      if (result == THUNAR_IO_COPY_RESULT_DONE && progress_callback != NULL)
+        (*progress_callback) (end, source_statb.st_size, progress_callback_data);
+    }
+
+  if (result == THUNAR_IO_COPY_RESULT_DONE)
+    {
+      if (G_UNLIKELY (close (target_fd) < 0))
+        {
+          g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                       _("Error while copying file: %s"), g_strerror (errno));
+          result = THUNAR_IO_COPY_RESULT_FAILED;
+        }
+      target_fd = -1;
+    }
+
+out:
+  if (target_fd >= 0)
+    close (target_fd);
+  if (source_fd >= 0)
+    close (source_fd);
+
+  /* same attributes as for a regular copy */
+  if (result == THUNAR_IO_COPY_RESULT_DONE)
+    g_file_copy_attributes (source_file, target_file, G_FILE_COPY_NOFOLLOW_SYMLINKS, cancellable, NULL);
+
+  g_free (buffer);
+  g_free (source_path);
+  g_free (target_path);
+
+  return (result == THUNAR_IO_COPY_RESULT_DONE);
+}
@@ -0,0 +1,84 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __THUNAR_IO_COPY_H__
+#define __THUNAR_IO_COPY_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/**
+ * ThunarIoCopyStrategy:
+ * @THUNAR_IO_COPY_GIO        : the data was copied by g_file_copy().
+ * @THUNAR_IO_COPY_CLONE      : the target is a reflink of the source.
+ * @THUNAR_IO_COPY_SPARSE     : only the data regions of a sparse file were copied.
+ * @THUNAR_IO_COPY_FILE_RANGE : the data was copied in-kernel using copy_file_range().
+ * @THUNAR_IO_COPY_SENDFILE   : the data was copied in-kernel using sendfile().
+ * @THUNAR_IO_COPY_VERIFIED   : the data was hashed while copying and read back.
+ *
+ * The way thunar_io_copy_file() or thunar_io_copy_file_verified() copied the data of a file.
+ **/
+typedef enum
+{
+  THUNAR_IO_COPY_GIO,
+  THUNAR_IO_COPY_CLONE,
+  THUNAR_IO_COPY_SPARSE,
+  THUNAR_IO_COPY_FILE_RANGE,
+  THUNAR_IO_COPY_SENDFILE,
+  THUNAR_IO_COPY_VERIFIED,
+  THUNAR_IO_COPY_N_STRATEGIES,
+} ThunarIoCopyStrategy;
+
+gboolean     thunar_io_copy_file              (GFile                 *source_file,
+                                               GFile                 *target_file,
+                                               GFileCopyFlags         flags,
+                                               gboolean               keep_partial,
+                                               GCancellable          *cancellable,
+                                               GFileProgressCallback  progress_callback,
+                                               gpointer               progress_callback_data,
+                                               ThunarIoCopyStrategy  *strategy_return,
+                                               GError               **error);
+
+gboolean     thunar_io_copy_file_verified     (GFile                 *source_file,
+                                               GFile                 *target_file,
+                                               GFileCopyFlags         flags,
+                                               gboolean               keep_partial,
+                                               GCancellable          *cancellable,
+                                               GFileProgressCallback  progress_callback,
+                                               gpointer               progress_callback_data,
+                                               ThunarIoCopyStrategy  *strategy_return,
+                                               GError               **error);
+
+const gchar *thunar_io_copy_strategy_get_name (ThunarIoCopyStrategy   strategy);
+
+gboolean     thunar_io_copy_resume_file       (GFile                 *source_file,
+                                               GFile                 *target_file,
+                                               GCancellable          *cancellable,
+                                               GFileProgressCallback  progress_callback,
+                                               gpointer               progress_callback_data,
+                                               GError               **error);
+
+gboolean     thunar_io_copy_compare_files     (GFile                 *file1,
+                                               GFile                 *file2,
+                                               GCancellable          *cancellable,
+                                               GError               **error);
+
+G_END_DECLS
+
+#endif /* !__THUNAR_IO_COPY_H__ */
@@ -0,0 +1,513 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* for fdopendir() and the *at() functions */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_DIRENT_H
+#include <dirent.h>
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <glib/gstdio.h>
+
+#include <exo/exo.h>
+#include <libxfce4util/libxfce4util.h>
+
+#include <thunar/thunar-io-delete.h>
+#include <thunar/thunar-private.h>
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+
+
+/* number of threads deleting subtrees concurrently */
+#define THUNAR_IO_DELETE_MAX_THREADS (8)
+
+/* minimum time between two progress messages in microseconds */
+#define THUNAR_IO_DELETE_UPDATE_INTERVAL (100 * 1000)
+
+
+
+typedef struct _ThunarIoDeleteDir   ThunarIoDeleteDir;
+typedef struct _ThunarIoDeleteEvent ThunarIoDeleteEvent;
+typedef struct _ThunarIoDelete      ThunarIoDelete;
+
+
+
+/* a directory of the tree, it is removed once its own scan, the
+ * subdirectories and the failed entries in it are all done; the
+ * device and inode tell whether the path still leads to the directory
+ * seen by the parent's scan when a worker opens it later */
+struct _ThunarIoDeleteDir
+{
+  ThunarIoDeleteDir *parent;
+  gchar             *path;
+  dev_t              dev;
+  ino_t              ino;
+  volatile gint      pending;
+  guint              skip : 1;
+};
+
+/* sent from the workers to the job thread, which owns the user
+ * interaction; an event without path tells that all work is done */
+struct _ThunarIoDeleteEvent
+{
+  ThunarIoDeleteDir *dir;
+  gchar             *path;
+  gint               errnum;
+  guint              is_dir : 1;
+  guint              fatal : 1;
+};
+
+struct _ThunarIoDelete
+{
+  ThunarJob            *job;
+  GCancellable         *cancellable;
+  ThunarThumbnailCache *thumbnail_cache;
+  GThreadPool          *pool;
+  GAsyncQueue          *events;
+
+  /* directories queued or being scanned plus unresolved events */
+  volatile gint         n_tasks;
+  volatile gint         n_deleted;
+
+  /* set when a directory could not be read */
+  volatile gint         stop;
+};
+
+
+
+static gboolean
+thunar_io_delete_is_stopped (ThunarIoDelete *engine)
+{
+  return g_atomic_int_get (&engine->stop) != 0
+      || g_cancellable_is_cancelled (engine->cancellable);
+}
+
+
+
+static void
+thunar_io_delete_push (ThunarIoDelete    *engine,
+                       ThunarIoDeleteDir *parent,
+                       gchar             *path,
+                       const struct stat *statb)
+{
+  ThunarIoDeleteDir *dir;
+
+  dir = g_slice_new (ThunarIoDeleteDir);
+  dir->parent = parent;
+  dir->path = path;
+  dir->dev = statb->st_dev;
+  dir->ino = statb->st_ino;
+  dir->pending = 1;
+  dir->skip = FALSE;
+
+  /* the parent waits for the subdirectory to be removed */
+  if (parent != NULL)
+    g_atomic_int_inc (&parent->pending);
+
+  g_atomic_int_inc (&engine->n_tasks);
+  g_thread_pool_push (engine->pool, dir, NULL);
+}
+
+
+
+static void
+thunar_io_delete_task_done (ThunarIoDelete *engine)
+{
+  ThunarIoDeleteEvent *event;
+
+  /* wake up the job thread once nothing is left */
+  if (g_atomic_int_dec_and_test (&engine->n_tasks))
+    {
+      event = g_slice_new0 (ThunarIoDeleteEvent);
+      g_async_queue_push (engine->events, event);
+    }
+}
+
+
+
+static void
+thunar_io_delete_fail (ThunarIoDelete    *engine,
+                       ThunarIoDeleteDir *dir,
+                       gchar             *path,
+                       gint               errnum,
+                       gboolean           is_dir,
+                       gboolean           fatal)
+{
+  ThunarIoDeleteEvent *event;
+
+  /* stop the other workers right away, nothing is removed anymore */
+  if (fatal)
+    g_atomic_int_set (&engine->stop, 1);
+
+  /* keep the directory until the user decided about the entry */
+  if (dir != NULL)
+    g_atomic_int_inc (&dir->pending);
+
+  event = g_slice_new0 (ThunarIoDeleteEvent);
+  event->dir = dir;
+  event->path = path;
+  event->errnum = errnum;
+  event->is_dir = is_dir;
+  event->fatal = fatal;
+
+  g_atomic_int_inc (&engine->n_tasks);
+  g_async_queue_push (engine->events, event);
+}
+
+
+
+static void
+thunar_io_delete_deleted (ThunarIoDelete *engine,
+                          const gchar    *path)
+{
+  GFile *file;
+
+  g_atomic_int_inc (&engine->n_deleted);
+
+  /* notify the thumbnail cache that the corresponding thumbnail can also
+   * be deleted now */
+  if (engine->thumbnail_cache != NULL)
+    {
+      file = g_file_new_for_path (path);
+      thunar_thumbnail_cache_delete_file (engine->thumbnail_cache, file);
+      g_object_unref (file);
+    }
+}
+
+
+
+static void
+thunar_io_delete_release (ThunarIoDelete    *engine,
+                          ThunarIoDeleteDir *dir)
+{
+  ThunarIoDeleteDir *parent;
+
+  /* remove the directories that became empty, bottom up */
+  for (; dir != NULL; dir = parent)
+    {
+      if (!g_atomic_int_dec_and_test (&dir->pending))
+        break;
+
+      parent = dir->parent;
+
+      if (dir->skip || thunar_io_delete_is_stopped (engine))
+        g_free (dir->path);
+      else if (g_rmdir (dir->path) == 0)
+        {
+          thunar_io_delete_deleted (engine, dir->path);
+          g_free (dir->path);
+        }
+      else
+        thunar_io_delete_fail (engine, parent, dir->path, errno, TRUE, FALSE);
+
+      g_slice_free (ThunarIoDeleteDir, dir);
+    }
+}
+
+
+
+static void
+thunar_io_delete_scan (gpointer data,
+                       gpointer user_data)
+{
+  ThunarIoDeleteDir *dir = data;
+  ThunarIoDelete    *engine = user_data;
+  struct dirent     *d;
+  struct stat        statb;
+  gboolean           is_dir;
+  gchar             *path;
+  DIR               *dp = NULL;
+  gint               errnum;
+  gint               fd;
+
+  /* this runs in a worker thread, see thunar_io_delete_tree() */
+  if (!thunar_io_delete_is_stopped (engine))
+    {
+      fd = open (dir->path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+      if (G_LIKELY (fd >= 0))
+        {
+          /* the parent was closed meanwhile, so a directory on the way
+           * may have been replaced by a symlink; leave the directory
+           * alone if we ended up somewhere else */
+          if (fstat (fd, &statb) != 0
+              || statb.st_dev != dir->dev
+              || statb.st_ino != dir->ino)
+            {
+              close (fd);
+              dir->skip = TRUE;
+            }
+          else
+            {
+              dp = fdopendir (fd);
+              if (G_UNLIKELY (dp == NULL))
+                {
+                  errnum = errno;
+                  close (fd);
+                  errno = errnum;
+                }
+            }
+        }
+
+      if (G_UNLIKELY (dp == NULL && !dir->skip))
+        thunar_io_delete_fail (engine, NULL, g_strdup (dir->path), errno, TRUE, TRUE);
+    }
+
+  while (dp != NULL && !thunar_io_delete_is_stopped (engine))
+    {
+      d = readdir (dp);
+      if (d == NULL)
+        break;
+
+      /* skip the special entries */
+      if (d->d_name[0] == '.'
+          && (d->d_name[1] == '\0' || (d->d_name[1] == '.' && d->d_name[2] == '\0')))
+        continue;
+
+      /* not every file system fills in the type, and directories
+       * are stat'ed anyway to remember their device and inode */
+#ifdef DT_DIR
+      if (d->d_type != DT_UNKNOWN && d->d_type != DT_DIR)
+        is_dir = FALSE;
+      else
+#endif
+        is_dir = (fstatat (dirfd (dp), d->d_name, &statb, AT_SYMLINK_NOFOLLOW) == 0
+                  && S_ISDIR (statb.st_mode));
+
+      path = g_build_filename (dir->path, d->d_name, NULL);
+
+      if (is_dir)
+        {
+          /* let any idle worker take the subtree */
+          thunar_io_delete_push (engine, dir, path, &statb);
+        }
+      else if (unlinkat (dirfd (dp), d->d_name, 0) == 0)
+        {
+          thunar_io_delete_deleted (engine, path);
+          g_free (path);
+        }
+      else
+        {
+          thunar_io_delete_fail (engine, dir, path, errno, FALSE, FALSE);
+        }
+    }
+
+  if (dp != NULL)
+    closedir (dp);
+
+  /* drop the reference of the scan, which removes the directory
+   * if all of its subdirectories are already gone */
+  thunar_io_delete_release (engine, dir);
+  thunar_io_delete_task_done (engine);
+}
+
+
+
+static void
+thunar_io_delete_handle_event (ThunarIoDelete       *engine,
+                               ThunarIoDeleteEvent  *event,
+                               GError              **error)
+{
+  ThunarJobResponse response;
+  gchar            *display_name;
+  gint              errnum = event->errnum;
+
+  display_name = g_filename_display_name (event->path);
+
+  if (event->fatal)
+    {
+      /* remember the first directory we failed to read */
+      if (*error == NULL)
+        {
+          g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errnum),
+                       _("Failed to open directory \"%s\": %s"),
+                       display_name, g_strerror (errnum));
+        }
+    }
+  else
+    {
+      while (!thunar_io_delete_is_stopped (engine))
+        {
+          /* ask the user whether he wants to skip this file */
+          response = thunar_job_ask_skip (engine->job,
+                                          _("Could not delete file \"%s\": %s"),
+                                          display_name, g_strerror (errnum));
+
+          /* check whether to retry */
+          if (response != THUNAR_JOB_RESPONSE_RETRY)
+            break;
+
+          if ((event->is_dir ? g_rmdir (event->path) : g_unlink (event->path)) == 0)
+            {
+              thunar_io_delete_deleted (engine, event->path);
+              break;
+            }
+
+          errnum = errno;
+        }
+    }
+
+  g_free (display_name);
+
+  /* the directory of the entry may be removed now */
+  thunar_io_delete_release (engine, event->dir);
+  thunar_io_delete_task_done (engine);
+}
+
+
+
+/**
+ * thunar_io_delete_tree:
+ * @job             : the #ThunarJob deleting the files.
+ * @file            : a local directory.
+ * @thumbnail_cache : a #ThunarThumbnailCache or %NULL.
+ * @error           : return location for errors or %NULL.
+ *
+ * Deletes @file and everything in it. The subdirectories are read by
+ * a pool of worker threads, which remove the files relative to the
+ * directory file descriptor as soon as they are found, so no list of
+ * the tree is ever built. Symlinks are removed, never followed.
+ *
+ * Files that cannot be removed are reported to the job thread, which
+ * asks the user to skip or retry them. If a directory cannot be read
+ * the deletion stops and @error is set.
+ *
+ * If @file is not a local directory, %G_IO_ERROR_NOT_SUPPORTED is
+ * returned and nothing is deleted.
+ *
+ * Return value: %TRUE if the tree was processed, %FALSE otherwise.
+ **/
+gboolean
+thunar_io_delete_tree (ThunarJob            *job,
+                       GFile                *file,
+                       ThunarThumbnailCache *thumbnail_cache,
+                       GError              **error)
+{
+  ThunarIoDeleteEvent *event;
+  ThunarIoDelete       engine;
+  struct stat          statb;
+  GError              *err = NULL;
+  gchar               *path;
+  guint                n_deleted;
+#if !GLIB_CHECK_VERSION (2, 32, 0)
+  GTimeVal             end_time;
+#endif
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (file), FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  /* only local directories are handled here */
+  path = g_file_get_path (file);
+  if (path == NULL || g_lstat (path, &statb) != 0 || !S_ISDIR (statb.st_mode))
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                           _("Operation not supported"));
+      g_free (path);
+      return FALSE;
+    }
+
+  engine.job = job;
+  engine.cancellable = exo_job_get_cancellable (EXO_JOB (job));
+  engine.thumbnail_cache = thumbnail_cache;
+  engine.events = g_async_queue_new ();
+  engine.n_tasks = 0;
+  engine.n_deleted = 0;
+  engine.stop = 0;
+  engine.pool = g_thread_pool_new (thunar_io_delete_scan, &engine,
+                                   THUNAR_IO_DELETE_MAX_THREADS,
+                                   FALSE, NULL);
+
+  thunar_io_delete_push (&engine, NULL, path, &statb);
+
+  for (;;)
+    {
+#if GLIB_CHECK_VERSION (2, 32, 0)
+      event = g_async_queue_timeout_pop (engine.events, THUNAR_IO_DELETE_UPDATE_INTERVAL);
+#else
+      g_get_current_time (&end_time);
+      g_time_val_add (&end_time, THUNAR_IO_DELETE_UPDATE_INTERVAL);
+      event = g_async_queue_timed_pop (engine.events, &end_time);
+#endif
+
+      if (event != NULL)
+        {
+          /* all directories are done */
+          if (event->path == NULL)
+            {
+              g_slice_free (ThunarIoDeleteEvent, event);
+              break;
+            }
+
+          thunar_io_delete_handle_event (&engine, event, &err);
+          g_free (event->path);
+          g_slice_free (ThunarIoDeleteEvent, event);
+        }
+
+      /* tell the user that we're still busy */
+      n_deleted = g_atomic_int_get (&engine.n_deleted);
+      if (n_deleted > 0)
+        {
+          exo_job_info_message (EXO_JOB (job),
+                                ngettext ("%u file deleted", "%u files deleted", n_deleted),
+                                n_deleted);
+        }
+    }
+
+  /* the workers are all idle at this point */
+  g_thread_pool_free (engine.pool, FALSE, TRUE);
+  g_async_queue_unref (engine.events);
+
+  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+    {
+      g_clear_error (&err);
+      return FALSE;
+    }
+
+  if (G_UNLIKELY (err != NULL))
+    {
+      g_propagate_error (error, err);
+      return FALSE;
+    }
+
+  return TRUE;
+}
@@ -32,6 +32,74 @@
 
 
 
+/**
+ * thunar_io_jobs_util_duplicate_name:
+ * @display_name : the display name of the source file.
+ * @is_directory : whether the source file is a directory.
+ * @copy         : the operation type (copy or link).
+ * @n            : the @n<!---->th copy/link to create the name for.
+ *
+ * Determines the name of the @n<!---->th copy/link of/to the file
+ * called @display_name, see thunar_io_jobs_util_next_duplicate_file()
+ * for the naming scheme.
+ *
+ * The caller is responsible to free the returned string using
+ * g_free() when no longer needed.
+ *
+ * Return value: the name of the @n<!---->th copy or link.
+ **/
+gchar *
+thunar_io_jobs_util_duplicate_name (const gchar *display_name,
+                                    gboolean     is_directory,
+                                    gboolean     copy,
+                                    guint        n)
+{
+  gchar       *duplicate_name;
+  gchar       *file_basename;
+  const gchar *dot = NULL;
+
+  _thunar_return_val_if_fail (display_name != NULL, NULL);
+  _thunar_return_val_if_fail (0 < n, NULL);
+
+  if (copy)
+    {
+      /* get file extension if file is not a directory */
+      if (!is_directory)
+        dot = thunar_util_str_get_extension (display_name);
+
+      if (dot != NULL)
+        {
+          file_basename = g_strndup (display_name, dot - display_name);
+          /* I18N: put " (copy #) between basename and extension */
+          duplicate_name = g_strdup_printf (_("%s (copy %u)%s"), file_basename, n, dot);
+          g_free(file_basename);
+        }
+      else
+        {
+          /* I18N: put " (copy #)" after filename (for files without extension) */
+          duplicate_name = g_strdup_printf (_("%s (copy %u)"), display_name, n);
+        }
+    }
+  else
+    {
+      /* create name for link */
+      if (n == 1)
+        {
+          /* I18N: name for first link to basename */
+          duplicate_name = g_strdup_printf (_("link to %s"), display_name);
+        }
+      else
+        {
+          /* I18N: name for nth link to basename */
+          duplicate_name = g_strdup_printf (_("link %u to %s"), n, display_name);
+        }
+    }
+
+  return duplicate_name;
+}
+
+
+
 /**
  * thunar_io_jobs_util_next_duplicate_file:
  * @job   : a #ThunarJob.
@@ -64,10 +132,7 @@ thunar_io_jobs_util_next_duplicate_file (ThunarJob *job,
   GError      *err = NULL;
   GFile       *duplicate_file = NULL;
   GFile       *parent_file = NULL;
-  const gchar *old_display_name;
   gchar       *display_name;
-  gchar       *file_basename;
-  gchar       *dot = NULL;
 
   _thunar_return_val_if_fail (THUNAR_IS_JOB (job), NULL);
   _thunar_return_val_if_fail (G_IS_FILE (file), NULL);
@@ -92,40 +157,9 @@ thunar_io_jobs_util_next_duplicate_file (ThunarJob *job,
       return NULL;
     }
 
-  old_display_name = g_file_info_get_display_name (info);
-  if (copy)
-    {
-      /* get file extension if file is not a directory */
-      if (g_file_info_get_file_type (info) != G_FILE_TYPE_DIRECTORY)
-        dot = thunar_util_str_get_extension (old_display_name);
-
-      if (dot != NULL)
-        {
-          file_basename = g_strndup (old_display_name, dot - old_display_name);
-          /* I18N: put " (copy #) between basename and extension */
-          display_name = g_strdup_printf (_("%s (copy %u)%s"), file_basename, n, dot);
-          g_free(file_basename);
-        }
-      else
-        {
-          /* I18N: put " (copy #)" after filename (for files without extension) */
-          display_name = g_strdup_printf (_("%s (copy %u)"), old_display_name, n);
-        }
-    }
-  else
-    {
-      /* create name for link */
-      if (n == 1)
-        {
-          /* I18N: name for first link to basename */
-          display_name = g_strdup_printf (_("link to %s"), old_display_name);
-        }
-      else
-        {
-          /* I18N: name for nth link to basename */
-          display_name = g_strdup_printf (_("link %u to %s"), n, old_display_name);
-        }
-    }
+  display_name = thunar_io_jobs_util_duplicate_name (g_file_info_get_display_name (info),
+                                                     g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY,
+                                                     copy, n);
 
   /* create the GFile for the copy/link */
   parent_file = g_file_get_parent (file);
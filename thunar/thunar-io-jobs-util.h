@@ -25,6 +25,11 @@
 
 G_BEGIN_DECLS
 
+gchar *thunar_io_jobs_util_duplicate_name      (const gchar *display_name,
+                                                gboolean     is_directory,
+                                                gboolean     copy,
+                                                guint        n) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
+
 GFile *thunar_io_jobs_util_next_duplicate_file (ThunarJob *job,
                                                 GFile     *file,
                                                 gboolean   copy,
@@ -27,7 +27,10 @@
 #include <thunar/thunar-application.h>
 #include <thunar/thunar-enum-types.h>
 #include <thunar/thunar-gio-extensions.h>
+#include <thunar/thunar-io-delete.h>
+#include <thunar/thunar-io-permissions.h>
 #include <thunar/thunar-io-scan-directory.h>
+#include <thunar/thunar-io-trash.h>
 #include <thunar/thunar-io-jobs.h>
 #include <thunar/thunar-io-jobs-util.h>
 #include <thunar/thunar-job.h>
@@ -38,6 +41,19 @@
 
 
 
+static void
+_tij_collect_file (ThunarJob *job,
+                   GFile     *file,
+                   GFileInfo *info,
+                   gpointer   user_data)
+{
+  GList **file_list = user_data;
+
+  *file_list = thunar_g_file_list_prepend (*file_list, file);
+}
+
+
+
 static GList *
 _tij_collect_nofollow (ThunarJob *job,
                        GList     *base_file_list,
@@ -45,30 +61,33 @@ _tij_collect_nofollow (ThunarJob *job,
                        GError   **error)
 {
   GError *err = NULL;
-  GList  *child_file_list = NULL;
   GList  *file_list = NULL;
   GList  *lp;
 
-  /* recursively collect the files */
+  /* recursively collect the files, the children of each
+   * base file are collected before the base file itself */
   for (lp = base_file_list;
        err == NULL && lp != NULL && !exo_job_is_cancelled (EXO_JOB (job));
        lp = lp->next)
     {
       /* try to scan the directory */
-      child_file_list = thunar_io_scan_directory (job, lp->data,
-                                                  G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
-                                                  TRUE, unlinking, FALSE, &err);
-
-      /* prepend the new files to the existing list */
-      file_list = thunar_g_file_list_prepend (file_list, lp->data);
-      file_list = g_list_concat (child_file_list, file_list);
+      if (thunar_io_scan_directory_foreach (job, lp->data,
+                                            G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                            G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                                            G_FILE_ATTRIBUTE_STANDARD_NAME,
+                                            TRUE, unlinking,
+                                            _tij_collect_file, &file_list,
+                                            &err))
+        {
+          file_list = thunar_g_file_list_prepend (file_list, lp->data);
+        }
     }
 
   /* check if we failed */
   if (err != NULL || exo_job_is_cancelled (EXO_JOB (job)))
     {
       if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
-        g_error_free (err);
+        g_clear_error (&err);
       else
         g_propagate_error (error, err);
 
@@ -78,7 +97,26 @@ _tij_collect_nofollow (ThunarJob *job,
       return NULL;
     }
 
-  return file_list;
+  /* the files were prepended, restore the order they were found in */
+  return g_list_reverse (file_list);
+}
+
+
+
+static GList *
+_tij_collect_other (ThunarJob *job,
+                    GList     *base_file_list,
+                    gboolean   recursive,
+                    GError   **error)
+{
+  /* nothing left or failed already */
+  if (base_file_list == NULL || (error != NULL && *error != NULL))
+    return NULL;
+
+  if (recursive)
+    return _tij_collect_nofollow (job, base_file_list, FALSE, error);
+  else
+    return thunar_g_file_list_copy (base_file_list);
 }
 
 
@@ -109,7 +147,7 @@ _thunar_io_jobs_create (ThunarJob  *job,
   template_file = g_value_get_object (&g_array_index (param_values, GValue, 1));
 
   /* we know the total amount of files to be processed */
-  thunar_job_set_total_files (THUNAR_JOB (job), file_list);
+  thunar_job_set_total_files (THUNAR_JOB (job), g_list_length (file_list));
 
   /* check if we need to open the template */
   if (template_file != NULL)
@@ -131,7 +169,7 @@ _thunar_io_jobs_create (ThunarJob  *job,
       g_assert (G_IS_FILE (lp->data));
 
       /* update progress information */
-      thunar_job_processing_file (THUNAR_JOB (job), lp);
+      thunar_job_processing_file (THUNAR_JOB (job), lp->data);
 
 again:
       /* try to create the file */
@@ -253,9 +291,9 @@ ThunarJob *
 thunar_io_jobs_create_files (GList *file_list,
                              GFile *template_file)
 {
-  return thunar_simple_job_launch (_thunar_io_jobs_create, 2,
-                                   THUNAR_TYPE_G_FILE_LIST, file_list,
-                                   G_TYPE_FILE, template_file);
+  return thunar_simple_job_new (_thunar_io_jobs_create, 2,
+                                THUNAR_TYPE_G_FILE_LIST, file_list,
+                                G_TYPE_FILE, template_file);
 }
 
 
@@ -281,7 +319,7 @@ _thunar_io_jobs_mkdir (ThunarJob  *job,
   file_list = g_value_get_boxed (&g_array_index (param_values, GValue, 0));
 
   /* we know the total list of files to process */
-  thunar_job_set_total_files (THUNAR_JOB (job), file_list);
+  thunar_job_set_total_files (THUNAR_JOB (job), g_list_length (file_list));
 
   for (lp = file_list;
        err == NULL && lp != NULL && !exo_job_is_cancelled (EXO_JOB (job));
@@ -290,7 +328,7 @@ _thunar_io_jobs_mkdir (ThunarJob  *job,
       g_assert (G_IS_FILE (lp->data));
 
       /* update progress information */
-      thunar_job_processing_file (THUNAR_JOB (job), lp);
+      thunar_job_processing_file (THUNAR_JOB (job), lp->data);
 
 again:
       /* try to create the directory */
@@ -390,46 +428,37 @@ again:
 ThunarJob *
 thunar_io_jobs_make_directories (GList *file_list)
 {
-  return thunar_simple_job_launch (_thunar_io_jobs_mkdir, 1,
-                                   THUNAR_TYPE_G_FILE_LIST, file_list);
+  return thunar_simple_job_new (_thunar_io_jobs_mkdir, 1,
+                                THUNAR_TYPE_G_FILE_LIST, file_list);
 }
 
 
 
 static gboolean
-_thunar_io_jobs_unlink (ThunarJob  *job,
-                        GArray     *param_values,
-                        GError    **error)
+_tij_unlink_nofollow (ThunarJob            *job,
+                      GList                *base_file_list,
+                      ThunarThumbnailCache *thumbnail_cache,
+                      GError              **error)
 {
-  ThunarThumbnailCache *thumbnail_cache;
-  ThunarApplication    *application;
-  ThunarJobResponse     response;
-  GFileInfo            *info;
-  GError               *err = NULL;
-  GList                *file_list;
-  GList                *lp;
-  gchar                *base_name;
-  gchar                *display_name;
-
-  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
-  _thunar_return_val_if_fail (param_values != NULL, FALSE);
-  _thunar_return_val_if_fail (param_values->len == 1, FALSE);
-  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
-
-  /* get the file list */
-  file_list = g_value_get_boxed (&g_array_index (param_values, GValue, 0));
+  ThunarJobResponse response;
+  GFileInfo        *info;
+  GError           *err = NULL;
+  GList            *file_list;
+  GList            *lp;
+  gchar            *base_name;
+  gchar            *display_name;
 
   /* tell the user that we're preparing to unlink the files */
   exo_job_info_message (EXO_JOB (job), _("Preparing..."));
 
   /* recursively collect files for removal, not following any symlinks */
-  file_list = _tij_collect_nofollow (job, file_list, TRUE, &err);
+  file_list = _tij_collect_nofollow (job, base_file_list, TRUE, &err);
 
   /* free the file list and fail if there was an error or the job was cancelled */
   if (err != NULL || exo_job_is_cancelled (EXO_JOB (job)))
     {
       if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
-        g_error_free (err);
+        g_clear_error (&err);
       else
         g_propagate_error (error, err);
 
@@ -438,12 +467,7 @@ _thunar_io_jobs_unlink (ThunarJob  *job,
     }
 
   /* we know the total list of files to process */
-  thunar_job_set_total_files (THUNAR_JOB (job), file_list);
-
-  /* take a reference on the thumbnail cache */
-  application = thunar_application_get ();
-  thumbnail_cache = thunar_application_get_thumbnail_cache (application);
-  g_object_unref (application);
+  thunar_job_set_total_files (THUNAR_JOB (job), g_list_length (file_list));
 
   /* remove all the files */
   for (lp = file_list; lp != NULL && !exo_job_is_cancelled (EXO_JOB (job)); lp = lp->next)
@@ -455,7 +479,7 @@ _thunar_io_jobs_unlink (ThunarJob  *job,
         continue;
 
       /* update progress information */
-      thunar_job_processing_file (THUNAR_JOB (job), lp);
+      thunar_job_processing_file (THUNAR_JOB (job), lp->data);
 
 again:
       /* try to delete the file */
@@ -465,6 +489,12 @@ again:
            * be deleted now */
           thunar_thumbnail_cache_delete_file (thumbnail_cache, lp->data);
         }
+      else if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+        {
+          /* nothing to ask about, the file is gone already, e.g. an
+           * entry GVfs still lists after we emptied the trash */
+          g_clear_error (&err);
+        }
       else
         {
           /* query the file info for the display name */
@@ -509,9 +539,6 @@ again:
         }
     }
 
-  /* release the thumbnail cache */
-  g_object_unref (thumbnail_cache);
-
   /* release the file list */
   thunar_g_file_list_free (file_list);
 
@@ -523,11 +550,148 @@ again:
 
 
 
+static gboolean
+_thunar_io_jobs_unlink (ThunarJob  *job,
+                        GArray     *param_values,
+                        GError    **error)
+{
+  ThunarThumbnailCache *thumbnail_cache;
+  ThunarApplication    *application;
+  gboolean              succeed;
+  GError               *err = NULL;
+  GList                *file_list;
+  GList                *other_list = NULL;
+  GList                *lp;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
+  _thunar_return_val_if_fail (param_values != NULL, FALSE);
+  _thunar_return_val_if_fail (param_values->len == 1, FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  /* get the file list */
+  file_list = g_value_get_boxed (&g_array_index (param_values, GValue, 0));
+
+  /* take a reference on the thumbnail cache */
+  application = thunar_application_get ();
+  thumbnail_cache = thunar_application_get_thumbnail_cache (application);
+  g_object_unref (application);
+
+  /* delete local directory trees while they are scanned, everything
+   * else is collected and deleted through GIO below */
+  for (lp = file_list;
+       err == NULL && lp != NULL && !exo_job_is_cancelled (EXO_JOB (job));
+       lp = lp->next)
+    {
+      if (g_file_is_native (lp->data)
+          && !thunar_g_file_is_root (lp->data)
+          && thunar_io_delete_tree (job, lp->data, thumbnail_cache, &err))
+        continue;
+
+      if (err == NULL || g_error_matches (err, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+        {
+          g_clear_error (&err);
+          other_list = thunar_g_file_list_prepend (other_list, lp->data);
+        }
+    }
+  other_list = g_list_reverse (other_list);
+
+  if (err != NULL)
+    {
+      if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+        g_error_free (err);
+      else
+        g_propagate_error (error, err);
+
+      succeed = FALSE;
+    }
+  else if (other_list != NULL)
+    {
+      succeed = _tij_unlink_nofollow (job, other_list, thumbnail_cache, error);
+    }
+  else
+    {
+      succeed = !exo_job_set_error_if_cancelled (EXO_JOB (job), error);
+    }
+
+  /* release the thumbnail cache */
+  g_object_unref (thumbnail_cache);
+
+  thunar_g_file_list_free (other_list);
+
+  return succeed;
+}
+
+
+
 ThunarJob *
 thunar_io_jobs_unlink_files (GList *file_list)
 {
-  return thunar_simple_job_launch (_thunar_io_jobs_unlink, 1,
-                                   THUNAR_TYPE_G_FILE_LIST, file_list);
+  return thunar_simple_job_new (_thunar_io_jobs_unlink, 1,
+                                THUNAR_TYPE_G_FILE_LIST, file_list);
+}
+
+
+
+static gboolean
+_thunar_io_jobs_empty_trash (ThunarJob  *job,
+                             GArray     *param_values,
+                             GError    **error)
+{
+  ThunarThumbnailCache *thumbnail_cache;
+  ThunarApplication    *application;
+  GFileInfo            *info;
+  gboolean              succeed;
+  gboolean              complete;
+  GList                 file_list;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  /* take a reference on the thumbnail cache */
+  application = thunar_application_get ();
+  thumbnail_cache = thunar_application_get_thumbnail_cache (application);
+  g_object_unref (application);
+
+  /* empty the local trash directories directly */
+  succeed = thunar_io_trash_empty (job, thumbnail_cache, &complete, error);
+
+  /* GVfs only learns about the removed files later, so only ask it
+   * when there are trash directories we could not handle ourselves */
+  if (succeed && !complete)
+    {
+      /* fake a path list with only the trash root (the root
+       * folder itself will never be unlinked, so this is safe) */
+      file_list.data = thunar_g_file_new_for_trash ();
+      file_list.next = NULL;
+      file_list.prev = NULL;
+
+      /* let GVfs remove whatever is left in those trashes */
+      info = g_file_query_info (file_list.data, G_FILE_ATTRIBUTE_TRASH_ITEM_COUNT,
+                                G_FILE_QUERY_INFO_NONE,
+                                exo_job_get_cancellable (EXO_JOB (job)),
+                                NULL);
+      if (info != NULL)
+        {
+          if (g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TRASH_ITEM_COUNT) > 0)
+            succeed = _tij_unlink_nofollow (job, &file_list, thumbnail_cache, error);
+          g_object_unref (info);
+        }
+
+      g_object_unref (file_list.data);
+    }
+
+  /* release the thumbnail cache */
+  g_object_unref (thumbnail_cache);
+
+  return succeed;
+}
+
+
+
+ThunarJob *
+thunar_io_jobs_empty_trash (void)
+{
+  return thunar_simple_job_new (_thunar_io_jobs_empty_trash, 0);
 }
 
 
@@ -545,7 +709,7 @@ thunar_io_jobs_move_files (GList *source_file_list,
   job = thunar_transfer_job_new (source_file_list, target_file_list,
                                  THUNAR_TRANSFER_JOB_MOVE);
 
-  return THUNAR_JOB (exo_job_launch (EXO_JOB (job)));
+  return THUNAR_JOB (job);
 }
 
 
@@ -563,7 +727,7 @@ thunar_io_jobs_copy_files (GList *source_file_list,
   job = thunar_transfer_job_new (source_file_list, target_file_list,
                                  THUNAR_TRANSFER_JOB_COPY);
 
-  return THUNAR_JOB (exo_job_launch (EXO_JOB (job)));
+  return THUNAR_JOB (job);
 }
 
 
@@ -718,7 +882,7 @@ _thunar_io_jobs_link (ThunarJob  *job,
   target_file_list = g_value_get_boxed (&g_array_index (param_values, GValue, 1));
 
   /* we know the total list of paths to process */
-  thunar_job_set_total_files (THUNAR_JOB (job), source_file_list);
+  thunar_job_set_total_files (THUNAR_JOB (job), g_list_length (source_file_list));
 
   /* take a reference on the thumbnail cache */
   application = thunar_application_get ();
@@ -734,7 +898,7 @@ _thunar_io_jobs_link (ThunarJob  *job,
       _thunar_assert (G_IS_FILE (tp->data));
 
       /* update progress information */
-      thunar_job_processing_file (THUNAR_JOB (job), sp);
+      thunar_job_processing_file (THUNAR_JOB (job), sp->data);
 
       /* try to create the symbolic link */
       real_target_file = _thunar_io_jobs_link_file (job, sp->data, tp->data, &err);
@@ -785,9 +949,9 @@ thunar_io_jobs_link_files (GList *source_file_list,
   _thunar_return_val_if_fail (target_file_list != NULL, NULL);
   _thunar_return_val_if_fail (g_list_length (source_file_list) == g_list_length (target_file_list), NULL);
 
-  return thunar_simple_job_launch (_thunar_io_jobs_link, 2,
-                                   THUNAR_TYPE_G_FILE_LIST, source_file_list,
-                                   THUNAR_TYPE_G_FILE_LIST, target_file_list);
+  return thunar_simple_job_new (_thunar_io_jobs_link, 2,
+                                THUNAR_TYPE_G_FILE_LIST, source_file_list,
+                                THUNAR_TYPE_G_FILE_LIST, target_file_list);
 }
 
 
@@ -801,6 +965,7 @@ _thunar_io_jobs_trash (ThunarJob  *job,
   ThunarApplication    *application;
   GError               *err = NULL;
   GList                *file_list;
+  GList                *other_list = NULL;
   GList                *lp;
 
   _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
@@ -813,15 +978,25 @@ _thunar_io_jobs_trash (ThunarJob  *job,
   if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
     return FALSE;
 
+  /* we know the total list of files to process */
+  thunar_job_set_total_files (THUNAR_JOB (job), g_list_length (file_list));
+
   /* take a reference on the thumbnail cache */
   application = thunar_application_get ();
   thumbnail_cache = thunar_application_get_thumbnail_cache (application);
   g_object_unref (application);
 
-  for (lp = file_list; err == NULL && lp != NULL; lp = lp->next)
+  /* move local files into the trash directly */
+  thunar_io_trash_files (job, file_list, thumbnail_cache, &other_list, &err);
+
+  /* trash the remaining files through GIO */
+  for (lp = other_list; err == NULL && lp != NULL; lp = lp->next)
     {
       _thunar_assert (G_IS_FILE (lp->data));
 
+      /* update progress information */
+      thunar_job_processing_file (THUNAR_JOB (job), lp->data);
+
       /* trash the file or folder */
       g_file_trash (lp->data, exo_job_get_cancellable (EXO_JOB (job)), &err);
 
@@ -829,6 +1004,8 @@ _thunar_io_jobs_trash (ThunarJob  *job,
       thunar_thumbnail_cache_cleanup_file (thumbnail_cache, lp->data);
     }
 
+  thunar_g_file_list_free (other_list);
+
   /* release the thumbnail cache */
   g_object_unref (thumbnail_cache);
 
@@ -850,8 +1027,8 @@ thunar_io_jobs_trash_files (GList *file_list)
 {
   _thunar_return_val_if_fail (file_list != NULL, NULL);
 
-  return thunar_simple_job_launch (_thunar_io_jobs_trash, 1,
-                                   THUNAR_TYPE_G_FILE_LIST, file_list);
+  return thunar_simple_job_new (_thunar_io_jobs_trash, 1,
+                                THUNAR_TYPE_G_FILE_LIST, file_list);
 }
 
 
@@ -869,7 +1046,7 @@ thunar_io_jobs_restore_files (GList *source_file_list,
   job = thunar_transfer_job_new (source_file_list, target_file_list,
                                  THUNAR_TRANSFER_JOB_MOVE);
 
-  return THUNAR_JOB (exo_job_launch (EXO_JOB (job)));
+  return THUNAR_JOB (job);
 }
 
 
@@ -885,7 +1062,9 @@ _thunar_io_jobs_chown (ThunarJob  *job,
   gboolean          recursive;
   GError           *err = NULL;
   GList            *file_list;
+  GList            *other_list = NULL;
   GList            *lp;
+  guint             n_local;
   gint              uid;
   gint              gid;
 
@@ -901,11 +1080,24 @@ _thunar_io_jobs_chown (ThunarJob  *job,
 
   _thunar_assert ((uid >= 0 || gid >= 0) && !(uid >= 0 && gid >= 0));
 
+  /* the local files are counted once each, without their contents */
+  n_local = g_list_length (file_list);
+  thunar_job_set_total_files (THUNAR_JOB (job), n_local);
+
+  /* change the local files in place, the others are handled below */
+  for (lp = file_list; lp != NULL && err == NULL; lp = lp->next)
+    if (!thunar_io_chown_tree (job, lp->data, uid, gid, recursive, &err)
+        && g_error_matches (err, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+      {
+        g_clear_error (&err);
+        other_list = g_list_prepend (other_list, lp->data);
+        n_local -= 1;
+      }
+
   /* collect the files for the chown operation */
-  if (recursive)
-    file_list = _tij_collect_nofollow (job, file_list, FALSE, &err);
-  else
-    file_list = thunar_g_file_list_copy (file_list);
+  other_list = g_list_reverse (other_list);
+  file_list = _tij_collect_other (job, other_list, recursive, &err);
+  g_list_free (other_list);
 
   if (err != NULL)
     {
@@ -914,13 +1106,13 @@ _thunar_io_jobs_chown (ThunarJob  *job,
     }
 
   /* we know the total list of files to process */
-  thunar_job_set_total_files (THUNAR_JOB (job), file_list);
+  thunar_job_set_total_files (THUNAR_JOB (job), n_local + g_list_length (file_list));
 
   /* change the ownership of all files */
   for (lp = file_list; lp != NULL && err == NULL; lp = lp->next)
     {
       /* update progress information */
-      thunar_job_processing_file (THUNAR_JOB (job), lp);
+      thunar_job_processing_file (THUNAR_JOB (job), lp->data);
 
       /* try to query information about the file */
       info = g_file_query_info (lp->data,
@@ -1021,7 +1213,9 @@ _thunar_io_jobs_chmod (ThunarJob  *job,
   gboolean          recursive;
   GError           *err = NULL;
   GList            *file_list;
+  GList            *other_list = NULL;
   GList            *lp;
+  guint             n_local;
   ThunarFileMode    dir_mask;
   ThunarFileMode    dir_mode;
   ThunarFileMode    file_mask;
@@ -1043,11 +1237,25 @@ _thunar_io_jobs_chmod (ThunarJob  *job,
   file_mode = g_value_get_flags (&g_array_index (param_values, GValue, 4));
   recursive = g_value_get_boolean (&g_array_index (param_values, GValue, 5));
 
-  /* collect the files for the chown operation */
-  if (recursive)
-    file_list = _tij_collect_nofollow (job, file_list, FALSE, &err);
-  else
-    file_list = thunar_g_file_list_copy (file_list);
+  /* the local files are counted once each, without their contents */
+  n_local = g_list_length (file_list);
+  thunar_job_set_total_files (THUNAR_JOB (job), n_local);
+
+  /* change the local files in place, the others are handled below */
+  for (lp = file_list; lp != NULL && err == NULL; lp = lp->next)
+    if (!thunar_io_chmod_tree (job, lp->data, dir_mask, dir_mode,
+                               file_mask, file_mode, recursive, &err)
+        && g_error_matches (err, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+      {
+        g_clear_error (&err);
+        other_list = g_list_prepend (other_list, lp->data);
+        n_local -= 1;
+      }
+
+  /* collect the files for the chmod operation */
+  other_list = g_list_reverse (other_list);
+  file_list = _tij_collect_other (job, other_list, recursive, &err);
+  g_list_free (other_list);
 
   if (err != NULL)
     {
@@ -1056,13 +1264,13 @@ _thunar_io_jobs_chmod (ThunarJob  *job,
     }
 
   /* we know the total list of files to process */
-  thunar_job_set_total_files (THUNAR_JOB (job), file_list);
+  thunar_job_set_total_files (THUNAR_JOB (job), n_local + g_list_length (file_list));
 
   /* change the ownership of all files */
   for (lp = file_list; lp != NULL && err == NULL; lp = lp->next)
     {
       /* update progress information */
-      thunar_job_processing_file (THUNAR_JOB (job), lp);
+      thunar_job_processing_file (THUNAR_JOB (job), lp->data);
 
       /* try to query information about the file */
       info = g_file_query_info (lp->data,
@@ -26,10 +26,13 @@
 
 G_BEGIN_DECLS
 
+/* the jobs for these file operations are returned without being
+ * launched, ThunarApplication schedules them per filesystem */
 ThunarJob *thunar_io_jobs_create_files     (GList         *file_list,
                                             GFile         *template_file) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
 ThunarJob *thunar_io_jobs_make_directories (GList         *file_list) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
 ThunarJob *thunar_io_jobs_unlink_files     (GList         *file_list) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
+ThunarJob *thunar_io_jobs_empty_trash      (void) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
 ThunarJob *thunar_io_jobs_move_files       (GList         *source_file_list,
                                             GList         *target_file_list) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
 ThunarJob *thunar_io_jobs_copy_files       (GList         *source_file_list,
@@ -39,6 +42,8 @@ ThunarJob *thunar_io_jobs_link_files       (GList         *source_file_list,
 ThunarJob *thunar_io_jobs_trash_files      (GList         *file_list) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
 ThunarJob *thunar_io_jobs_restore_files    (GList         *source_file_list,
                                             GList         *target_file_list) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
+
+/* these jobs are launched right away */
 ThunarJob *thunar_io_jobs_change_group     (GList         *files,
                                             guint32        gid,
                                             gboolean       recursive) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
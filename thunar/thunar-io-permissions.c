@@ -0,0 +1,765 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* for fdopendir() and the *at() functions */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_DIRENT_H
+#include <dirent.h>
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <glib/gstdio.h>
+
+#include <exo/exo.h>
+#include <libxfce4util/libxfce4util.h>
+
+#include <thunar/thunar-io-permissions.h>
+#include <thunar/thunar-private.h>
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+
+
+/* number of threads walking subtrees concurrently */
+#define THUNAR_IO_PERMISSIONS_MAX_THREADS (8)
+
+/* minimum time between two progress messages in microseconds */
+#define THUNAR_IO_PERMISSIONS_UPDATE_INTERVAL (100 * 1000)
+
+
+
+typedef struct _ThunarIoPermissionsDir   ThunarIoPermissionsDir;
+typedef struct _ThunarIoPermissionsEvent ThunarIoPermissionsEvent;
+typedef struct _ThunarIoPermissions      ThunarIoPermissions;
+
+
+
+/* a directory queued for the workers; the device and inode tell
+ * whether the path still leads to the directory seen by the parent's
+ * walk when a worker opens it later */
+struct _ThunarIoPermissionsDir
+{
+  gchar *path;
+  dev_t  dev;
+  ino_t  ino;
+};
+
+/* sent from the workers to the job thread, which owns the user
+ * interaction; an event without path tells that all work is done.
+ * The entry is found again as @name in @dirfd, a copy of the parent
+ * directory's descriptor, or by its @path if no copy could be made */
+struct _ThunarIoPermissionsEvent
+{
+  gchar       *path;
+  const gchar *name;
+  gint         dirfd;
+  struct stat  statb;
+  gint         errnum;
+  mode_t       mode;
+  guint        deferred : 1;
+  guint        fatal : 1;
+};
+
+struct _ThunarIoPermissions
+{
+  ThunarJob    *job;
+  GCancellable *cancellable;
+  GThreadPool  *pool;
+  GAsyncQueue  *events;
+
+  /* the requested change */
+  gboolean      change_mode;
+  gint          uid;
+  gint          gid;
+  mode_t        dir_mask;
+  mode_t        dir_mode;
+  mode_t        file_mask;
+  mode_t        file_mode;
+
+  /* directories queued or being walked plus unresolved events */
+  volatile gint n_tasks;
+  volatile gint n_processed;
+
+  /* set when a directory could not be read */
+  volatile gint stop;
+};
+
+
+
+static gboolean
+thunar_io_permissions_is_stopped (ThunarIoPermissions *engine)
+{
+  return g_atomic_int_get (&engine->stop) != 0
+      || g_cancellable_is_cancelled (engine->cancellable);
+}
+
+
+
+static void
+thunar_io_permissions_push (ThunarIoPermissions *engine,
+                            gchar               *path,
+                            const struct stat   *statb)
+{
+  ThunarIoPermissionsDir *dir;
+
+  dir = g_slice_new (ThunarIoPermissionsDir);
+  dir->path = path;
+  dir->dev = statb->st_dev;
+  dir->ino = statb->st_ino;
+
+  g_atomic_int_inc (&engine->n_tasks);
+  g_thread_pool_push (engine->pool, dir, NULL);
+}
+
+
+
+static void
+thunar_io_permissions_task_done (ThunarIoPermissions *engine)
+{
+  ThunarIoPermissionsEvent *event;
+
+  /* wake up the job thread once nothing is left */
+  if (g_atomic_int_dec_and_test (&engine->n_tasks))
+    {
+      event = g_slice_new0 (ThunarIoPermissionsEvent);
+      g_async_queue_push (engine->events, event);
+    }
+}
+
+
+
+static void
+thunar_io_permissions_send (ThunarIoPermissions *engine,
+                            gint                 dirfd,
+                            gchar               *path,
+                            const struct stat   *statb,
+                            gint                 errnum,
+                            mode_t               mode,
+                            gboolean             deferred,
+                            gboolean             fatal)
+{
+  ThunarIoPermissionsEvent *event;
+
+  /* stop the other workers right away */
+  if (fatal)
+    g_atomic_int_set (&engine->stop, 1);
+
+  event = g_slice_new0 (ThunarIoPermissionsEvent);
+  event->path = path;
+  event->name = path;
+  event->dirfd = AT_FDCWD;
+
+  /* keep the parent open after the worker closed its descriptor,
+   * the path is only used if we ran out of descriptors */
+  if (dirfd != AT_FDCWD)
+    {
+#ifdef F_DUPFD_CLOEXEC
+      event->dirfd = fcntl (dirfd, F_DUPFD_CLOEXEC, 0);
+#else
+      event->dirfd = dup (dirfd);
+#endif
+      if (G_LIKELY (event->dirfd >= 0))
+        event->name = strrchr (path, G_DIR_SEPARATOR) + 1;
+      else
+        event->dirfd = AT_FDCWD;
+    }
+
+  if (statb != NULL)
+    event->statb = *statb;
+
+  event->errnum = errnum;
+  event->mode = mode;
+  event->deferred = deferred;
+  event->fatal = fatal;
+
+  g_atomic_int_inc (&engine->n_tasks);
+  g_async_queue_push (engine->events, event);
+}
+
+
+
+static gboolean
+thunar_io_permissions_needs_change (ThunarIoPermissions *engine,
+                                    const struct stat   *statb,
+                                    mode_t              *mode_return)
+{
+  mode_t mode;
+
+  if (engine->change_mode)
+    {
+      /* symlinks have no permissions of their own */
+      if (S_ISLNK (statb->st_mode))
+        return FALSE;
+
+      if (S_ISDIR (statb->st_mode))
+        mode = ((statb->st_mode & ~engine->dir_mask) | engine->dir_mode) & 07777;
+      else
+        mode = ((statb->st_mode & ~engine->file_mask) | engine->file_mode) & 07777;
+
+      *mode_return = mode;
+      return (mode != (statb->st_mode & 07777));
+    }
+
+  return ((engine->uid >= 0 && statb->st_uid != (uid_t) engine->uid)
+          || (engine->gid >= 0 && statb->st_gid != (gid_t) engine->gid));
+}
+
+
+
+static void
+thunar_io_permissions_event_free (ThunarIoPermissionsEvent *event)
+{
+  if (event->dirfd >= 0)
+    close (event->dirfd);
+
+  g_free (event->path);
+  g_slice_free (ThunarIoPermissionsEvent, event);
+}
+
+
+
+static gboolean
+thunar_io_permissions_is_same (gint               dirfd,
+                               const gchar       *name,
+                               const struct stat *statb)
+{
+  struct stat current;
+
+  if (fstatat (dirfd, name, &current, AT_SYMLINK_NOFOLLOW) != 0)
+    return FALSE;
+
+  if (current.st_dev != statb->st_dev || current.st_ino != statb->st_ino)
+    {
+      errno = ENOENT;
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+
+static gint
+thunar_io_permissions_change (ThunarIoPermissions *engine,
+                              gint                 dirfd,
+                              const gchar         *name,
+                              const struct stat   *statb,
+                              mode_t               mode)
+{
+  struct stat fd_statb;
+  uid_t       uid = (engine->uid >= 0) ? (uid_t) engine->uid : (uid_t) -1;
+  gid_t       gid = (engine->gid >= 0) ? (gid_t) engine->gid : (gid_t) -1;
+  gint        errnum;
+  gint        result;
+  gint        fd;
+
+  /* change files and directories through a descriptor, so neither a
+   * symlink nor another file that replaced the entry since it was
+   * looked at is changed; this fails with ENOENT in that case */
+  if (S_ISREG (statb->st_mode) || S_ISDIR (statb->st_mode))
+    {
+      fd = openat (dirfd, name, O_RDONLY | O_NOFOLLOW | O_NONBLOCK | O_NOCTTY | O_CLOEXEC);
+      if (G_LIKELY (fd >= 0))
+        {
+          if (fstat (fd, &fd_statb) != 0
+              || fd_statb.st_dev != statb->st_dev
+              || fd_statb.st_ino != statb->st_ino)
+            {
+              close (fd);
+              errno = ENOENT;
+              return -1;
+            }
+
+          if (engine->change_mode)
+            result = fchmod (fd, mode);
+          else
+            result = fchown (fd, uid, gid);
+
+          errnum = errno;
+          close (fd);
+          errno = errnum;
+
+          return result;
+        }
+
+      /* a symlink took the place of the entry */
+      if (errno == ELOOP)
+        errno = ENOENT;
+
+      /* without read permission the entry is changed by name below */
+      if (errno != EACCES)
+        return -1;
+    }
+
+  if (!engine->change_mode)
+    return fchownat (dirfd, name, uid, gid, AT_SYMLINK_NOFOLLOW);
+
+  /* older C libraries can't chmod without following symlinks, so
+   * make sure the entry is still the one we looked at instead */
+  result = fchmodat (dirfd, name, mode, AT_SYMLINK_NOFOLLOW);
+  if (result != 0 && errno == ENOTSUP && thunar_io_permissions_is_same (dirfd, name, statb))
+    result = fchmodat (dirfd, name, mode, 0);
+
+  return result;
+}
+
+
+
+static void
+thunar_io_permissions_process (ThunarIoPermissions *engine,
+                               gint                 dirfd,
+                               const gchar         *name,
+                               gchar               *path,
+                               const struct stat   *statb,
+                               gboolean             recursive)
+{
+  mode_t mode = 0;
+
+  if (thunar_io_permissions_needs_change (engine, statb, &mode))
+    {
+      /* a directory the owner can no longer read is changed after
+       * everything in it is done */
+      if (engine->change_mode && recursive && S_ISDIR (statb->st_mode)
+          && (mode & (S_IRUSR | S_IXUSR)) != (S_IRUSR | S_IXUSR))
+        thunar_io_permissions_send (engine, dirfd, g_strdup (path), statb, 0, mode, TRUE, FALSE);
+      else if (thunar_io_permissions_change (engine, dirfd, name, statb, mode) != 0
+               && errno != ENOENT)
+        thunar_io_permissions_send (engine, dirfd, g_strdup (path), statb, errno, 0, FALSE, FALSE);
+    }
+
+  g_atomic_int_inc (&engine->n_processed);
+
+  if (recursive && S_ISDIR (statb->st_mode))
+    thunar_io_permissions_push (engine, path, statb);
+  else
+    g_free (path);
+}
+
+
+
+static void
+thunar_io_permissions_walk (gpointer data,
+                            gpointer user_data)
+{
+  ThunarIoPermissionsDir *dir = data;
+  ThunarIoPermissions    *engine = user_data;
+  struct dirent          *d;
+  struct stat             statb;
+  gchar                  *dir_path = dir->path;
+  gchar                  *path;
+  DIR                    *dp = NULL;
+  gboolean                moved = FALSE;
+  gint                    errnum;
+  gint                    fd;
+
+  /* this runs in a worker thread, see thunar_io_permissions_tree() */
+  if (!thunar_io_permissions_is_stopped (engine))
+    {
+      fd = open (dir_path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+      if (G_LIKELY (fd >= 0))
+        {
+          /* the parent was closed meanwhile, so a directory on the way
+           * may have been replaced by a symlink; leave the directory
+           * alone if we ended up somewhere else */
+          if (fstat (fd, &statb) != 0
+              || statb.st_dev != dir->dev
+              || statb.st_ino != dir->ino)
+            {
+              close (fd);
+              moved = TRUE;
+            }
+          else
+            {
+              dp = fdopendir (fd);
+              if (G_UNLIKELY (dp == NULL))
+                {
+                  errnum = errno;
+                  close (fd);
+                  errno = errnum;
+                }
+            }
+        }
+
+      if (G_UNLIKELY (dp == NULL && !moved))
+        thunar_io_permissions_send (engine, AT_FDCWD, g_strdup (dir_path), NULL, errno, 0, FALSE, TRUE);
+    }
+
+  while (dp != NULL && !thunar_io_permissions_is_stopped (engine))
+    {
+      d = readdir (dp);
+      if (d == NULL)
+        break;
+
+      /* skip the special entries */
+      if (d->d_name[0] == '.'
+          && (d->d_name[1] == '\0' || (d->d_name[1] == '.' && d->d_name[2] == '\0')))
+        continue;
+
+#ifdef DT_LNK
+      /* no need to look at symlinks when changing the mode */
+      if (engine->change_mode && d->d_type == DT_LNK)
+        {
+          g_atomic_int_inc (&engine->n_processed);
+          continue;
+        }
+#endif
+
+      path = g_build_filename (dir_path, d->d_name, NULL);
+
+      /* entries deleted meanwhile are skipped */
+      if (fstatat (dirfd (dp), d->d_name, &statb, AT_SYMLINK_NOFOLLOW) == 0)
+        thunar_io_permissions_process (engine, dirfd (dp), d->d_name, path, &statb, TRUE);
+      else if (errno == ENOENT)
+        g_free (path);
+      else
+        thunar_io_permissions_send (engine, dirfd (dp), path, NULL, errno, 0, FALSE, FALSE);
+    }
+
+  if (dp != NULL)
+    closedir (dp);
+
+  g_free (dir_path);
+  g_slice_free (ThunarIoPermissionsDir, dir);
+
+  thunar_io_permissions_task_done (engine);
+}
+
+
+
+static void
+thunar_io_permissions_ask (ThunarIoPermissions      *engine,
+                           ThunarIoPermissionsEvent *event)
+{
+  ThunarJobResponse response;
+  const gchar      *message;
+  struct stat       statb;
+  mode_t            mode = 0;
+  gchar            *display_name;
+  gint              errnum = event->errnum;
+
+  if (engine->change_mode)
+    message = _("Failed to change the permissions of \"%s\": %s");
+  else if (engine->uid >= 0)
+    message = _("Failed to change the owner of \"%s\": %s");
+  else
+    message = _("Failed to change the group of \"%s\": %s");
+
+  display_name = g_filename_display_name (event->path);
+
+  while (!thunar_io_permissions_is_stopped (engine))
+    {
+      /* ask the user whether to skip/retry this file */
+      response = thunar_job_ask_skip (engine->job, message, display_name, g_strerror (errnum));
+
+      /* check whether to retry */
+      if (response != THUNAR_JOB_RESPONSE_RETRY)
+        break;
+
+      if (fstatat (event->dirfd, event->name, &statb, AT_SYMLINK_NOFOLLOW) == 0
+          && (!thunar_io_permissions_needs_change (engine, &statb, &mode)
+              || thunar_io_permissions_change (engine, event->dirfd, event->name, &statb, mode) == 0))
+        break;
+
+      /* the file was deleted meanwhile */
+      if (errno == ENOENT)
+        break;
+
+      errnum = errno;
+    }
+
+  g_free (display_name);
+}
+
+
+
+static gint
+thunar_io_permissions_compare_depth (gconstpointer a,
+                                     gconstpointer b)
+{
+  const ThunarIoPermissionsEvent *event_a = a;
+  const ThunarIoPermissionsEvent *event_b = b;
+
+  /* children have longer paths than their parents */
+  return (gint) strlen (event_b->path) - (gint) strlen (event_a->path);
+}
+
+
+
+static gboolean
+thunar_io_permissions_tree (ThunarIoPermissions  *engine,
+                            GFile                *file,
+                            gboolean              recursive,
+                            GError              **error)
+{
+  ThunarIoPermissionsEvent *event;
+  struct stat               statb;
+  GError                   *err = NULL;
+  GSList                   *deferred = NULL;
+  GSList                   *lp;
+  gchar                    *display_name;
+  gchar                    *path;
+  guint                     n_processed;
+#if !GLIB_CHECK_VERSION (2, 32, 0)
+  GTimeVal                  end_time;
+#endif
+
+  /* only local files are handled here */
+  path = g_file_get_path (file);
+  if (path == NULL || g_lstat (path, &statb) != 0)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                           _("Operation not supported"));
+      g_free (path);
+      return FALSE;
+    }
+
+  /* update progress information */
+  thunar_job_processing_file (engine->job, file);
+
+  engine->cancellable = exo_job_get_cancellable (EXO_JOB (engine->job));
+  engine->events = g_async_queue_new ();
+  engine->n_tasks = 1;
+  engine->n_processed = 0;
+  engine->stop = 0;
+  engine->pool = g_thread_pool_new (thunar_io_permissions_walk, engine,
+                                    THUNAR_IO_PERMISSIONS_MAX_THREADS,
+                                    FALSE, NULL);
+
+  /* the base file is processed like the entries of a directory, the
+   * extra task keeps the workers from finishing before it is queued */
+  thunar_io_permissions_process (engine, AT_FDCWD, path, path, &statb, recursive);
+  thunar_io_permissions_task_done (engine);
+
+  for (;;)
+    {
+#if GLIB_CHECK_VERSION (2, 32, 0)
+      event = g_async_queue_timeout_pop (engine->events, THUNAR_IO_PERMISSIONS_UPDATE_INTERVAL);
+#else
+      g_get_current_time (&end_time);
+      g_time_val_add (&end_time, THUNAR_IO_PERMISSIONS_UPDATE_INTERVAL);
+      event = g_async_queue_timed_pop (engine->events, &end_time);
+#endif
+
+      if (event != NULL)
+        {
+          /* all directories are done */
+          if (event->path == NULL)
+            {
+              g_slice_free (ThunarIoPermissionsEvent, event);
+              break;
+            }
+
+          if (event->deferred)
+            {
+              deferred = g_slist_prepend (deferred, event);
+              thunar_io_permissions_task_done (engine);
+              continue;
+            }
+
+          if (event->fatal)
+            {
+              /* remember the first directory we failed to read */
+              if (err == NULL)
+                {
+                  display_name = g_filename_display_name (event->path);
+                  g_set_error (&err, G_IO_ERROR, g_io_error_from_errno (event->errnum),
+                               _("Failed to open directory \"%s\": %s"),
+                               display_name, g_strerror (event->errnum));
+                  g_free (display_name);
+                }
+            }
+          else
+            {
+              thunar_io_permissions_ask (engine, event);
+            }
+
+          thunar_io_permissions_event_free (event);
+          thunar_io_permissions_task_done (engine);
+        }
+
+      /* tell the user that we're still busy */
+      n_processed = g_atomic_int_get (&engine->n_processed);
+      if (recursive && n_processed > 0)
+        {
+          exo_job_info_message (EXO_JOB (engine->job),
+                                ngettext ("%u file processed", "%u files processed", n_processed),
+                                n_processed);
+        }
+    }
+
+  /* the workers are all idle at this point */
+  g_thread_pool_free (engine->pool, FALSE, TRUE);
+  g_async_queue_unref (engine->events);
+
+  /* close the directories that were kept readable, deepest first */
+  deferred = g_slist_sort (deferred, thunar_io_permissions_compare_depth);
+  for (lp = deferred; lp != NULL; lp = lp->next)
+    {
+      event = lp->data;
+
+      if (!thunar_io_permissions_is_stopped (engine)
+          && thunar_io_permissions_change (engine, event->dirfd, event->name,
+                                           &event->statb, event->mode) != 0
+          && errno != ENOENT)
+        {
+          event->errnum = errno;
+          thunar_io_permissions_ask (engine, event);
+        }
+
+      thunar_io_permissions_event_free (event);
+    }
+  g_slist_free (deferred);
+
+  if (exo_job_set_error_if_cancelled (EXO_JOB (engine->job), error))
+    {
+      g_clear_error (&err);
+      return FALSE;
+    }
+
+  if (G_UNLIKELY (err != NULL))
+    {
+      g_propagate_error (error, err);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+
+/**
+ * thunar_io_chown_tree:
+ * @job       : the #ThunarJob changing the files.
+ * @file      : a local file.
+ * @uid       : the new owner or -1.
+ * @gid       : the new group or -1.
+ * @recursive : whether to change the contents of directories too.
+ * @error     : return location for errors or %NULL.
+ *
+ * Changes the owner or the group of @file and, if @recursive is
+ * %TRUE, of everything in it. Directories are walked by a pool of
+ * worker threads, which change the entries relative to the directory
+ * file descriptor as soon as they are found, and only if the owner
+ * or group actually differs. Symlinks are changed, never followed.
+ * Entries that were deleted or replaced since they were found are
+ * skipped.
+ *
+ * Files that cannot be changed are reported to the job thread, which
+ * asks the user to skip or retry them. If a directory cannot be read
+ * the operation stops and @error is set.
+ *
+ * If @file is not a local file, %G_IO_ERROR_NOT_SUPPORTED is returned
+ * and nothing is changed.
+ *
+ * Return value: %TRUE if the tree was processed, %FALSE otherwise.
+ **/
+gboolean
+thunar_io_chown_tree (ThunarJob *job,
+                      GFile     *file,
+                      gint       uid,
+                      gint       gid,
+                      gboolean   recursive,
+                      GError   **error)
+{
+  ThunarIoPermissions engine;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (file), FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  memset (&engine, 0, sizeof (engine));
+  engine.job = job;
+  engine.change_mode = FALSE;
+  engine.uid = uid;
+  engine.gid = gid;
+
+  return thunar_io_permissions_tree (&engine, file, recursive, error);
+}
+
+
+
+/**
+ * thunar_io_chmod_tree:
+ * @job       : the #ThunarJob changing the files.
+ * @file      : a local file.
+ * @dir_mask  : the bits to change for directories.
+ * @dir_mode  : the new bits for directories.
+ * @file_mask : the bits to change for the other files.
+ * @file_mode : the new bits for the other files.
+ * @recursive : whether to change the contents of directories too.
+ * @error     : return location for errors or %NULL.
+ *
+ * Like thunar_io_chown_tree(), but changes the permissions. Symlinks
+ * are skipped, they have no permissions of their own. Directories
+ * that would no longer be readable by their owner are changed after
+ * everything in them is done.
+ *
+ * Return value: %TRUE if the tree was processed, %FALSE otherwise.
+ **/
+gboolean
+thunar_io_chmod_tree (ThunarJob      *job,
+                      GFile          *file,
+                      ThunarFileMode  dir_mask,
+                      ThunarFileMode  dir_mode,
+                      ThunarFileMode  file_mask,
+                      ThunarFileMode  file_mode,
+                      gboolean        recursive,
+                      GError        **error)
+{
+  ThunarIoPermissions engine;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (file), FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  memset (&engine, 0, sizeof (engine));
+  engine.job = job;
+  engine.change_mode = TRUE;
+  engine.dir_mask = dir_mask;
+  engine.dir_mode = dir_mode;
+  engine.file_mask = file_mask;
+  engine.file_mode = file_mode;
+
+  return thunar_io_permissions_tree (&engine, file, recursive, error);
+}
@@ -33,33 +33,116 @@
 
 
 
-GList *
-thunar_io_scan_directory (ThunarJob          *job,
-                          GFile              *file,
-                          GFileQueryInfoFlags flags,
-                          gboolean            recursively,
-                          gboolean            unlinking,
-                          gboolean            return_thunar_files,
-                          GError            **error)
+/* minimum time between two progress messages in microseconds */
+#define THUNAR_IO_SCAN_UPDATE_INTERVAL (100 * 1000)
+
+
+
+/* a directory that is currently enumerated */
+typedef struct
 {
-  GFileEnumerator *enumerator;
+  GFile           *file;
   GFileInfo       *info;
-  GFileType        type;
-  GError          *err = NULL;
-  GFile           *child_file;
-  GList           *child_files = NULL;
-  GList           *files = NULL;
-  const gchar     *namespace;
-  ThunarFile      *thunar_file;
-  gboolean         is_mounted;
+  GFileEnumerator *enumerator;
+} ThunarIoScanFrame;
+
+
+
+typedef struct
+{
+  GList    *files;
+  gboolean  return_thunar_files;
+} ThunarIoScanCollector;
+
+
+
+static void
+thunar_io_scan_frame_free (ThunarIoScanFrame *frame)
+{
+  g_object_unref (frame->file);
+  if (frame->info != NULL)
+    g_object_unref (frame->info);
+  g_object_unref (frame->enumerator);
+  g_slice_free (ThunarIoScanFrame, frame);
+}
+
 
-  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), NULL);
-  _thunar_return_val_if_fail (G_IS_FILE (file), NULL);
-  _thunar_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+static void
+thunar_io_scan_directory_collect (ThunarJob *job,
+                                  GFile     *file,
+                                  GFileInfo *info,
+                                  gpointer   user_data)
+{
+  ThunarIoScanCollector *collector = user_data;
+  ThunarFile            *thunar_file;
+
+  if (collector->return_thunar_files)
+    {
+      thunar_file = thunar_file_get_with_info (file, info, FALSE);
+      collector->files = g_list_prepend (collector->files, thunar_file);
+    }
+  else
+    {
+      collector->files = g_list_prepend (collector->files, g_object_ref (file));
+    }
+}
+
+
+
+/**
+ * thunar_io_scan_directory_foreach:
+ * @job         : a #ThunarJob.
+ * @file        : the directory to scan.
+ * @flags       : #GFileQueryInfoFlags for the enumeration.
+ * @attributes  : the attributes to query for the children.
+ * @recursively : whether to descend into child directories.
+ * @unlinking   : whether the files are scanned to delete them.
+ * @func        : function to call for every file found.
+ * @user_data   : user data for @func.
+ * @error       : return location for errors or %NULL.
+ *
+ * Calls @func for every file below @file, but not for @file itself.
+ * The contents of a directory are always reported before the
+ * directory, so the files can be deleted in the order they arrive.
+ * The tree is traversed with an explicit stack, so the depth of the
+ * tree is only limited by the number of open directories.
+ *
+ * @attributes must include the file type if @recursively is %TRUE.
+ *
+ * Return value: %FALSE if the scan failed or the job was cancelled.
+ **/
+gboolean
+thunar_io_scan_directory_foreach (ThunarJob                *job,
+                                  GFile                    *file,
+                                  GFileQueryInfoFlags       flags,
+                                  const gchar              *attributes,
+                                  gboolean                  recursively,
+                                  gboolean                  unlinking,
+                                  ThunarIoScanDirectoryFunc func,
+                                  gpointer                  user_data,
+                                  GError                  **error)
+{
+  ThunarIoScanFrame *frame;
+  GFileEnumerator   *enumerator;
+  GFileInfo         *info;
+  GFileType          type;
+  GError            *err = NULL;
+  GFile             *child_file;
+  GSList            *stack;
+  gint64             last_update_time = 0;
+  gint64             now;
+  guint              n_files = 0;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (file), FALSE);
+  _thunar_return_val_if_fail (attributes != NULL, FALSE);
+  _thunar_return_val_if_fail (func != NULL, FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
   /* abort if the job was cancelled */
   if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
-    return NULL;
+    return FALSE;
 
   /* don't recurse when we are scanning prior to unlinking and the current
    * file/dir is in the trash. In GVfs, only the top-level directories in
@@ -70,7 +153,7 @@ thunar_io_scan_directory (ThunarJob          *job,
       && thunar_g_file_is_trashed (file)
       && !thunar_g_file_is_root (file))
     {
-      return NULL;
+      return TRUE;
     }
 
   /* query the file type */
@@ -78,105 +161,156 @@ thunar_io_scan_directory (ThunarJob          *job,
 
   /* abort if the job was cancelled */
   if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
-    return NULL;
+    return FALSE;
 
   /* ignore non-directory nodes */
   if (type != G_FILE_TYPE_DIRECTORY)
-    return NULL;
-
-  /* determine the namespace */
-  if (return_thunar_files)
-    namespace = THUNARX_FILE_INFO_NAMESPACE;
-  else
-    namespace = G_FILE_ATTRIBUTE_STANDARD_TYPE ","
-                G_FILE_ATTRIBUTE_STANDARD_NAME;
+    return TRUE;
 
   /* try to read from the direectory */
-  enumerator = g_file_enumerate_children (file, namespace,
+  enumerator = g_file_enumerate_children (file, attributes,
                                           flags, exo_job_get_cancellable (EXO_JOB (job)),
-                                          &err);
+                                          error);
+  if (enumerator == NULL)
+    return FALSE;
 
-  /* abort if there was an error or the job was cancelled */
-  if (err != NULL)
-    {
-      g_propagate_error (error, err);
-      return NULL;
-    }
+  frame = g_slice_new0 (ThunarIoScanFrame);
+  frame->file = g_object_ref (file);
+  frame->enumerator = enumerator;
+  stack = g_slist_prepend (NULL, frame);
 
-  /* iterate over children one by one */
-  while (!exo_job_is_cancelled (EXO_JOB (job)))
+  while (stack != NULL && !exo_job_set_error_if_cancelled (EXO_JOB (job), &err))
     {
-      /* query info of the child */
-      info = g_file_enumerator_next_file (enumerator,
+      frame = stack->data;
+
+      /* query info of the next child */
+      info = g_file_enumerator_next_file (frame->enumerator,
                                           exo_job_get_cancellable (EXO_JOB (job)),
                                           &err);
-
-      if (G_UNLIKELY (info == NULL))
+      if (G_UNLIKELY (err != NULL))
         break;
 
-      is_mounted = TRUE;
-      if (err != NULL)
+      if (info == NULL)
         {
-          if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_NOT_MOUNTED))
-            {
-              is_mounted = FALSE;
-              g_clear_error (&err);
-            }
-          else
-            {
-              /* break on errors */
-              break;
-            }
+          /* the directory is done, report it after its contents */
+          stack = g_slist_delete_link (stack, stack);
+          if (frame->info != NULL)
+            (*func) (job, frame->file, frame->info, user_data);
+          thunar_io_scan_frame_free (frame);
+          continue;
         }
 
       /* create GFile for the child */
-      child_file = g_file_get_child (file, g_file_info_get_name (info));
+      child_file = g_file_get_child (frame->file, g_file_info_get_name (info));
 
-      if (return_thunar_files)
+      /* descend into child directories, see above for the trash */
+      if (recursively
+          && g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY
+          && !(unlinking && thunar_g_file_is_trashed (child_file)))
         {
-          /* Prepend the ThunarFile */
-          thunar_file = thunar_file_get_with_info (child_file, info, !is_mounted);
-          files = thunar_g_file_list_prepend (files, thunar_file);
-          g_object_unref (G_OBJECT (thunar_file));
+          enumerator = g_file_enumerate_children (child_file, attributes,
+                                                  flags, exo_job_get_cancellable (EXO_JOB (job)),
+                                                  &err);
+          if (G_UNLIKELY (enumerator == NULL))
+            {
+              g_object_unref (child_file);
+              g_object_unref (info);
+              break;
+            }
+
+          /* the child is reported once its contents are */
+          frame = g_slice_new0 (ThunarIoScanFrame);
+          frame->file = child_file;
+          frame->info = info;
+          frame->enumerator = enumerator;
+          stack = g_slist_prepend (stack, frame);
         }
       else
         {
-          /* Prepend the GFile */
-          files = thunar_g_file_list_prepend (files, child_file);
+          (*func) (job, child_file, info, user_data);
+
+          g_object_unref (child_file);
+          g_object_unref (info);
         }
 
-      /* if the child is a directory and we need to recurse ... just do so */
-      if (recursively
-          && is_mounted
-          && g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+      /* tell the user that we're still busy with large trees */
+      n_files++;
+      now = g_get_monotonic_time ();
+      if (recursively && now - last_update_time >= THUNAR_IO_SCAN_UPDATE_INTERVAL)
         {
-          child_files = thunar_io_scan_directory (job, child_file, flags, recursively,
-                                                  unlinking, return_thunar_files, &err);
-
-          /* prepend children to the file list to make sure they're
-           * processed first (required for unlinking) */
-          files = g_list_concat (child_files, files);
+          last_update_time = now;
+          exo_job_info_message (EXO_JOB (job),
+                                ngettext ("Collecting files... %u file found",
+                                          "Collecting files... %u files found",
+                                          n_files),
+                                n_files);
         }
-
-      g_object_unref (child_file);
-      g_object_unref (info);
     }
 
-  /* release the enumerator */
-  g_object_unref (enumerator);
+  /* release the directories we did not finish */
+  g_slist_free_full (stack, (GDestroyNotify) thunar_io_scan_frame_free);
 
   if (G_UNLIKELY (err != NULL))
     {
       g_propagate_error (error, err);
-      thunar_g_file_list_free (files);
-      return NULL;
+      return FALSE;
     }
-  else if (exo_job_set_error_if_cancelled (EXO_JOB (job), &err))
+
+  return TRUE;
+}
+
+
+
+/**
+ * thunar_io_scan_directory:
+ * @job                 : a #ThunarJob.
+ * @file                : the directory to scan.
+ * @flags               : #GFileQueryInfoFlags for the enumeration.
+ * @recursively         : whether to descend into child directories.
+ * @unlinking           : whether the files are scanned to delete them.
+ * @return_thunar_files : whether to return #ThunarFile<!---->s instead
+ *                        of #GFile<!---->s.
+ * @error               : return location for errors or %NULL.
+ *
+ * Collects the files below @file, see thunar_io_scan_directory_foreach().
+ * The contents of a directory always come before the directory in the
+ * returned list.
+ *
+ * Return value: the list of files, free with thunar_g_file_list_free().
+ **/
+GList *
+thunar_io_scan_directory (ThunarJob          *job,
+                          GFile              *file,
+                          GFileQueryInfoFlags flags,
+                          gboolean            recursively,
+                          gboolean            unlinking,
+                          gboolean            return_thunar_files,
+                          GError            **error)
+{
+  ThunarIoScanCollector collector;
+  const gchar          *namespace;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), NULL);
+  _thunar_return_val_if_fail (G_IS_FILE (file), NULL);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  /* determine the namespace */
+  if (return_thunar_files)
+    namespace = THUNAR_FILE_INFO_NAMESPACE;
+  else
+    namespace = G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                G_FILE_ATTRIBUTE_STANDARD_NAME;
+
+  collector.files = NULL;
+  collector.return_thunar_files = return_thunar_files;
+
+  if (!thunar_io_scan_directory_foreach (job, file, flags, namespace, recursively, unlinking,
+                                         thunar_io_scan_directory_collect, &collector, error))
     {
-      g_propagate_error (error, err);
-      thunar_g_file_list_free (files);
+      thunar_g_file_list_free (collector.files);
       return NULL;
     }
 
-  return files;
+  /* the files were prepended, restore the order they were found in */
+  return g_list_reverse (collector.files);
 }
@@ -28,13 +28,37 @@
 
 G_BEGIN_DECLS
 
-GList *thunar_io_scan_directory (ThunarJob          *job,
-                                 GFile              *file,
-                                 GFileQueryInfoFlags flags,
-                                 gboolean            recursively,
-                                 gboolean            unlinking,
-                                 gboolean            return_thunar_files,
-                                 GError            **error);
+/**
+ * ThunarIoScanDirectoryFunc:
+ * @job       : the #ThunarJob scanning the directory.
+ * @file      : a #GFile that was found.
+ * @info      : the #GFileInfo of @file.
+ * @user_data : the user data passed to thunar_io_scan_directory_foreach().
+ *
+ * Called for every file found by thunar_io_scan_directory_foreach().
+ **/
+typedef void (*ThunarIoScanDirectoryFunc) (ThunarJob *job,
+                                           GFile     *file,
+                                           GFileInfo *info,
+                                           gpointer   user_data);
+
+GList   *thunar_io_scan_directory         (ThunarJob                *job,
+                                           GFile                    *file,
+                                           GFileQueryInfoFlags       flags,
+                                           gboolean                  recursively,
+                                           gboolean                  unlinking,
+                                           gboolean                  return_thunar_files,
+                                           GError                  **error);
+
+gboolean thunar_io_scan_directory_foreach (ThunarJob                *job,
+                                           GFile                    *file,
+                                           GFileQueryInfoFlags       flags,
+                                           const gchar              *attributes,
+                                           gboolean                  recursively,
+                                           gboolean                  unlinking,
+                                           ThunarIoScanDirectoryFunc func,
+                                           gpointer                  user_data,
+                                           GError                  **error);
 
 G_END_DECLS
 
@@ -0,0 +1,1092 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* for the *at() functions */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_DIRENT_H
+#include <dirent.h>
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <glib/gstdio.h>
+
+#ifdef HAVE_GIO_UNIX
+#include <gio/gunixmounts.h>
+#endif
+
+#include <exo/exo.h>
+#include <libxfce4util/libxfce4util.h>
+
+#include <thunar/thunar-gio-extensions.h>
+#include <thunar/thunar-io-delete.h>
+#include <thunar/thunar-io-trash.h>
+#include <thunar/thunar-private.h>
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+
+
+/* number of volumes trashed to concurrently */
+#define THUNAR_IO_TRASH_MAX_THREADS (8)
+
+/* number of .trashinfo files written before the files are moved */
+#define THUNAR_IO_TRASH_BATCH_SIZE (64)
+
+/* number of trashed files handed to the thumbnail cache at once */
+#define THUNAR_IO_TRASH_CLEANUP_SIZE (500)
+
+
+
+typedef struct _ThunarIoTrashDir   ThunarIoTrashDir;
+typedef struct _ThunarIoTrashEvent ThunarIoTrashEvent;
+typedef struct _ThunarIoTrash      ThunarIoTrash;
+
+typedef enum
+{
+  THUNAR_IO_TRASH_EVENT_TRASHED,
+  THUNAR_IO_TRASH_EVENT_OTHER,
+  THUNAR_IO_TRASH_EVENT_FAILED,
+  THUNAR_IO_TRASH_EVENT_DONE,
+} ThunarIoTrashEventType;
+
+
+
+/* the trash directory of a single device */
+struct _ThunarIoTrashDir
+{
+  dev_t  device;
+
+  /* the mount point for volume trashes, NULL for the home trash */
+  gchar *topdir;
+
+  /* the trash directory, NULL if it cannot be used */
+  gchar *path;
+
+  /* the files to trash in this directory */
+  GList *files;
+};
+
+struct _ThunarIoTrashEvent
+{
+  ThunarIoTrashEventType type;
+  GFile                 *file;
+  GError                *error;
+};
+
+struct _ThunarIoTrash
+{
+  GCancellable  *cancellable;
+  GAsyncQueue   *events;
+
+  /* set once a file could not be trashed */
+  volatile gint  stop;
+};
+
+
+
+static gboolean
+thunar_io_trash_is_stopped (ThunarIoTrash *engine)
+{
+  return g_atomic_int_get (&engine->stop) != 0
+      || g_cancellable_is_cancelled (engine->cancellable);
+}
+
+
+
+static void
+thunar_io_trash_push_event (ThunarIoTrash          *engine,
+                            ThunarIoTrashEventType  type,
+                            GFile                  *file,
+                            GError                 *error)
+{
+  ThunarIoTrashEvent *event;
+
+  event = g_slice_new (ThunarIoTrashEvent);
+  event->type = type;
+  event->file = file != NULL ? g_object_ref (file) : NULL;
+  event->error = error;
+
+  g_async_queue_push (engine->events, event);
+}
+
+
+
+static gboolean
+thunar_io_trash_check_dir (const gchar *path)
+{
+  struct stat statb;
+
+  if (g_lstat (path, &statb) != 0)
+    {
+      if (errno != ENOENT)
+        return FALSE;
+
+      /* the directory does not exist yet, so nobody can have put a
+       * symlink in its place */
+      if (g_mkdir (path, 0700) != 0 && errno != EEXIST)
+        return FALSE;
+
+      if (g_lstat (path, &statb) != 0)
+        return FALSE;
+    }
+
+  /* never write into a directory someone else controls */
+  return S_ISDIR (statb.st_mode) && statb.st_uid == getuid ();
+}
+
+
+
+static gboolean
+thunar_io_trash_ensure_dir (const gchar *path)
+{
+  gboolean succeed;
+  gchar   *dir;
+  guint    n;
+
+  /* check the trash itself before anything is created inside it */
+  succeed = thunar_io_trash_check_dir (path);
+
+  for (n = 0; succeed && n < 2; ++n)
+    {
+      dir = g_build_filename (path, n == 0 ? "files" : "info", NULL);
+      succeed = thunar_io_trash_check_dir (dir);
+      g_free (dir);
+    }
+
+  return succeed;
+}
+
+
+
+static ThunarIoTrashDir *
+thunar_io_trash_dir_new_home (void)
+{
+  ThunarIoTrashDir *dir;
+  struct stat       statb;
+  gchar            *path;
+
+  dir = g_slice_new0 (ThunarIoTrashDir);
+
+  /* the data directory may not exist on a fresh account */
+  g_mkdir_with_parents (g_get_user_data_dir (), 0700);
+
+  path = g_build_filename (g_get_user_data_dir (), "Trash", NULL);
+  if (thunar_io_trash_ensure_dir (path) && g_stat (path, &statb) == 0)
+    {
+      dir->device = statb.st_dev;
+      dir->path = path;
+    }
+  else
+    {
+      /* files on this device are left to GIO, which reports the problem */
+      if (g_stat (g_get_user_data_dir (), &statb) == 0)
+        dir->device = statb.st_dev;
+      g_free (path);
+    }
+
+  return dir;
+}
+
+
+
+static ThunarIoTrashDir *
+thunar_io_trash_dir_new_volume (const gchar *path,
+                                dev_t        device)
+{
+  ThunarIoTrashDir *dir;
+  struct stat       statb;
+  gchar            *parent;
+  gchar            *trash_path;
+  gchar            *uid;
+  gboolean          system_internal = TRUE;
+#ifdef HAVE_GIO_UNIX
+  GUnixMountEntry  *mount;
+#endif
+
+  dir = g_slice_new0 (ThunarIoTrashDir);
+  dir->device = device;
+
+  /* walk up to the mount point of the volume */
+  dir->topdir = g_strdup (path);
+  for (;;)
+    {
+      parent = g_path_get_dirname (dir->topdir);
+      if (strcmp (parent, dir->topdir) == 0
+          || g_lstat (parent, &statb) != 0
+          || statb.st_dev != device)
+        {
+          g_free (parent);
+          break;
+        }
+
+      g_free (dir->topdir);
+      dir->topdir = parent;
+    }
+
+  /* like GIO, never create a trash on system internal mounts such as
+   * / or /boot; the files are left to GIO, which reports the problem.
+   * Without gio-unix we cannot tell them apart, so all volumes are */
+#ifdef HAVE_GIO_UNIX
+  mount = g_unix_mount_at (dir->topdir, NULL);
+  system_internal = (mount != NULL && g_unix_mount_is_system_internal (mount));
+  if (mount != NULL)
+    g_unix_mount_free (mount);
+#endif
+
+  if (system_internal)
+    return dir;
+
+  uid = g_strdup_printf ("%lu", (gulong) getuid ());
+
+  /* prefer the shared $topdir/.Trash if the administrator set it up
+   * correctly, which means a sticky directory that is no symlink */
+  trash_path = g_build_filename (dir->topdir, ".Trash", NULL);
+  if (g_lstat (trash_path, &statb) == 0
+      && S_ISDIR (statb.st_mode)
+      && (statb.st_mode & S_ISVTX) != 0)
+    {
+      dir->path = g_build_filename (trash_path, uid, NULL);
+      if (!thunar_io_trash_ensure_dir (dir->path))
+        {
+          g_free (dir->path);
+          dir->path = NULL;
+        }
+    }
+  g_free (trash_path);
+
+  /* fall back to $topdir/.Trash-$uid */
+  if (dir->path == NULL)
+    {
+      trash_path = g_strconcat (".Trash-", uid, NULL);
+      dir->path = g_build_filename (dir->topdir, trash_path, NULL);
+      g_free (trash_path);
+
+      if (!thunar_io_trash_ensure_dir (dir->path))
+        {
+          g_free (dir->path);
+          dir->path = NULL;
+        }
+    }
+
+  g_free (uid);
+
+  return dir;
+}
+
+
+
+static void
+thunar_io_trash_dir_free (ThunarIoTrashDir *dir)
+{
+  g_list_free_full (dir->files, g_object_unref);
+  g_free (dir->topdir);
+  g_free (dir->path);
+  g_slice_free (ThunarIoTrashDir, dir);
+}
+
+
+
+static gboolean
+thunar_io_trash_write_all (gint         fd,
+                           const gchar *data,
+                           gsize        size)
+{
+  gssize n;
+
+  while (size > 0)
+    {
+      n = write (fd, data, size);
+      if (G_UNLIKELY (n < 0))
+        {
+          if (errno == EINTR)
+            continue;
+          return FALSE;
+        }
+
+      data += n;
+      size -= n;
+    }
+
+  return TRUE;
+}
+
+
+
+static gchar *
+thunar_io_trash_write_info (ThunarIoTrashDir *dir,
+                            gint              info_fd,
+                            gint              files_fd,
+                            const gchar      *path,
+                            const gchar      *date,
+                            GError          **error)
+{
+  struct stat  statb;
+  const gchar *original_path = path;
+  gboolean     succeed;
+  gchar       *base_name;
+  gchar       *escaped;
+  gchar       *contents;
+  gchar       *info_name;
+  gchar       *name = NULL;
+  gint         errnum;
+  gint         fd;
+  guint        n;
+
+  /* volume trashes store the path relative to the mount point */
+  if (dir->topdir != NULL)
+    {
+      original_path += strlen (dir->topdir);
+      while (*original_path == G_DIR_SEPARATOR)
+        ++original_path;
+    }
+
+  escaped = g_uri_escape_string (original_path, "/", FALSE);
+  contents = g_strdup_printf ("[Trash Info]\nPath=%s\nDeletionDate=%s\n", escaped, date);
+  g_free (escaped);
+
+  base_name = g_path_get_basename (path);
+
+  for (n = 1; name == NULL; ++n)
+    {
+      if (n == 1)
+        name = g_strdup (base_name);
+      else
+        name = g_strdup_printf ("%s.%u", base_name, n);
+
+      /* reserve the name by creating the info file */
+      info_name = g_strconcat (name, ".trashinfo", NULL);
+      fd = openat (info_fd, info_name, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+      if (G_UNLIKELY (fd < 0))
+        {
+          errnum = errno;
+          g_free (info_name);
+          g_free (name);
+          name = NULL;
+
+          if (errnum == EEXIST)
+            continue;
+
+          /* leave long names to GIO, which knows how to shorten them */
+          if (errnum == ENAMETOOLONG)
+            {
+              g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                                   g_strerror (errnum));
+            }
+          else
+            {
+              g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errnum),
+                           _("Failed to create the trash information file: %s"),
+                           g_strerror (errnum));
+            }
+          break;
+        }
+
+      /* skip names that are still taken by a stale trashed file */
+      if (fstatat (files_fd, name, &statb, AT_SYMLINK_NOFOLLOW) == 0)
+        {
+          close (fd);
+          unlinkat (info_fd, info_name, 0);
+          g_free (info_name);
+          g_free (name);
+          name = NULL;
+          continue;
+        }
+
+      succeed = thunar_io_trash_write_all (fd, contents, strlen (contents));
+      errnum = errno;
+      if (close (fd) != 0 && succeed)
+        {
+          succeed = FALSE;
+          errnum = errno;
+        }
+
+      if (G_UNLIKELY (!succeed))
+        {
+          unlinkat (info_fd, info_name, 0);
+          g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errnum),
+                       _("Failed to create the trash information file: %s"),
+                       g_strerror (errnum));
+          g_free (name);
+          name = NULL;
+        }
+
+      g_free (info_name);
+      break;
+    }
+
+  g_free (base_name);
+  g_free (contents);
+
+  return name;
+}
+
+
+
+static void
+thunar_io_trash_run (gpointer data,
+                     gpointer user_data)
+{
+  ThunarIoTrashDir *dir = data;
+  ThunarIoTrash    *engine = user_data;
+  GDateTime        *now;
+  GError           *err;
+  GList            *lp;
+  GList            *batch;
+  gchar            *names[THUNAR_IO_TRASH_BATCH_SIZE];
+  gchar            *paths[THUNAR_IO_TRASH_BATCH_SIZE];
+  gchar            *info_name;
+  gchar            *display_name;
+  gchar            *date;
+  gchar            *dir_path;
+  gint              info_fd = -1;
+  gint              files_fd = -1;
+  gint              errnum;
+  guint             n_batch;
+  guint             n;
+
+  /* this runs in a worker thread, see thunar_io_trash_files() */
+  dir_path = g_build_filename (dir->path, "info", NULL);
+  info_fd = open (dir_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  g_free (dir_path);
+
+  dir_path = g_build_filename (dir->path, "files", NULL);
+  files_fd = open (dir_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  g_free (dir_path);
+
+  for (lp = dir->files; lp != NULL && !thunar_io_trash_is_stopped (engine); )
+    {
+      /* the trash directory went away, let GIO handle the files */
+      if (G_UNLIKELY (info_fd < 0 || files_fd < 0))
+        {
+          thunar_io_trash_push_event (engine, THUNAR_IO_TRASH_EVENT_OTHER, lp->data, NULL);
+          lp = lp->next;
+          continue;
+        }
+
+      now = g_date_time_new_now_local ();
+      date = g_date_time_format (now, "%Y-%m-%dT%H:%M:%S");
+      g_date_time_unref (now);
+
+      /* write the information files for the next batch... */
+      for (batch = lp, n_batch = 0;
+           lp != NULL && n_batch < THUNAR_IO_TRASH_BATCH_SIZE;
+           lp = lp->next, ++n_batch)
+        {
+          err = NULL;
+          paths[n_batch] = g_file_get_path (lp->data);
+          names[n_batch] = thunar_io_trash_write_info (dir, info_fd, files_fd,
+                                                       paths[n_batch], date, &err);
+
+          if (names[n_batch] != NULL)
+            continue;
+
+          if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+            {
+              g_error_free (err);
+              thunar_io_trash_push_event (engine, THUNAR_IO_TRASH_EVENT_OTHER, lp->data, NULL);
+            }
+          else
+            {
+              thunar_io_trash_push_event (engine, THUNAR_IO_TRASH_EVENT_FAILED, lp->data, err);
+            }
+        }
+
+      g_free (date);
+
+      /* ...and move the files into the trash */
+      for (n = 0; n < n_batch; ++n, batch = batch->next)
+        {
+          if (names[n] == NULL)
+            {
+              g_free (paths[n]);
+              continue;
+            }
+
+          if (!thunar_io_trash_is_stopped (engine)
+              && renameat (AT_FDCWD, paths[n], files_fd, names[n]) == 0)
+            {
+              thunar_io_trash_push_event (engine, THUNAR_IO_TRASH_EVENT_TRASHED, batch->data, NULL);
+            }
+          else
+            {
+              errnum = errno;
+
+              /* drop the information file again */
+              info_name = g_strconcat (names[n], ".trashinfo", NULL);
+              unlinkat (info_fd, info_name, 0);
+              g_free (info_name);
+
+              if (thunar_io_trash_is_stopped (engine))
+                {
+                  /* nothing to report */
+                }
+              else if (errnum == EXDEV)
+                {
+                  thunar_io_trash_push_event (engine, THUNAR_IO_TRASH_EVENT_OTHER, batch->data, NULL);
+                }
+              else
+                {
+                  display_name = g_filename_display_basename (paths[n]);
+                  err = g_error_new (G_IO_ERROR, g_io_error_from_errno (errnum),
+                                     _("Failed to move \"%s\" to the trash: %s"),
+                                     display_name, g_strerror (errnum));
+                  g_free (display_name);
+
+                  thunar_io_trash_push_event (engine, THUNAR_IO_TRASH_EVENT_FAILED, batch->data, err);
+                }
+            }
+
+          g_free (paths[n]);
+          g_free (names[n]);
+        }
+    }
+
+  if (info_fd >= 0)
+    close (info_fd);
+  if (files_fd >= 0)
+    close (files_fd);
+
+  thunar_io_trash_push_event (engine, THUNAR_IO_TRASH_EVENT_DONE, NULL, NULL);
+}
+
+
+
+/**
+ * thunar_io_trash_files:
+ * @job               : the #ThunarJob trashing the files.
+ * @file_list         : the list of #GFile<!---->s to trash.
+ * @thumbnail_cache   : a #ThunarThumbnailCache.
+ * @other_list_return : return location for the files that were not handled.
+ * @error             : return location for errors or %NULL.
+ *
+ * Moves the local files in @file_list into the trash directory of their
+ * volume, following the freedesktop.org trash specification. The
+ * .trashinfo files are written in batches and each volume is handled
+ * in its own thread, while the job thread reports every trashed file
+ * to the job progress and the @thumbnail_cache.
+ *
+ * Files that are not local, or which cannot be moved into a trash
+ * directory with a simple rename, are returned in @other_list_return
+ * and should be trashed with g_file_trash(). Release the list with
+ * thunar_g_file_list_free().
+ *
+ * Return value: %FALSE if a file could not be trashed or the job was
+ *               cancelled.
+ **/
+gboolean
+thunar_io_trash_files (ThunarJob            *job,
+                       GList                *file_list,
+                       ThunarThumbnailCache *thumbnail_cache,
+                       GList               **other_list_return,
+                       GError              **error)
+{
+  ThunarIoTrashEvent *event;
+  ThunarIoTrashDir   *dir;
+  ThunarIoTrash       engine;
+  struct stat         statb;
+  GThreadPool        *pool;
+  GError             *err = NULL;
+  GList              *dirs;
+  GList              *cleanup_list = NULL;
+  GList              *other_list = NULL;
+  GList              *lp;
+  GList              *dp;
+  gchar              *path;
+  gchar              *prefix;
+  guint               n_cleanup = 0;
+  guint               n_running = 0;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
+  _thunar_return_val_if_fail (THUNAR_IS_THUMBNAIL_CACHE (thumbnail_cache), FALSE);
+  _thunar_return_val_if_fail (other_list_return != NULL, FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  /* the home trash is always the first directory */
+  dirs = g_list_prepend (NULL, thunar_io_trash_dir_new_home ());
+
+  /* sort the files by the trash directory of their device */
+  for (lp = file_list; lp != NULL; lp = lp->next)
+    {
+      path = g_file_get_path (lp->data);
+      dir = NULL;
+
+      if (path != NULL
+          && !thunar_g_file_is_root (lp->data)
+          && g_lstat (path, &statb) == 0)
+        {
+          for (dp = dirs; dir == NULL && dp != NULL; dp = dp->next)
+            if (((ThunarIoTrashDir *) dp->data)->device == statb.st_dev)
+              dir = dp->data;
+
+          if (dir == NULL)
+            {
+              dir = thunar_io_trash_dir_new_volume (path, statb.st_dev);
+              dirs = g_list_append (dirs, dir);
+            }
+
+          /* leave mount points and files inside the trash to GIO */
+          if (dir->path != NULL)
+            {
+              prefix = g_strconcat (dir->path, G_DIR_SEPARATOR_S, NULL);
+              if (g_str_has_prefix (path, prefix)
+                  || (dir->topdir != NULL && strcmp (path, dir->topdir) == 0))
+                dir = NULL;
+              g_free (prefix);
+            }
+        }
+
+      if (dir != NULL && dir->path != NULL)
+        dir->files = g_list_prepend (dir->files, g_object_ref (lp->data));
+      else
+        other_list = g_list_prepend (other_list, g_object_ref (lp->data));
+
+      g_free (path);
+    }
+
+  engine.cancellable = exo_job_get_cancellable (EXO_JOB (job));
+  engine.events = g_async_queue_new ();
+  engine.stop = 0;
+
+  /* trash to the devices in parallel */
+  pool = g_thread_pool_new (thunar_io_trash_run, &engine,
+                            THUNAR_IO_TRASH_MAX_THREADS,
+                            FALSE, NULL);
+  for (dp = dirs; dp != NULL; dp = dp->next)
+    {
+      dir = dp->data;
+      if (dir->files != NULL)
+        {
+          dir->files = g_list_reverse (dir->files);
+          g_thread_pool_push (pool, dir, NULL);
+          n_running++;
+        }
+    }
+
+  while (n_running > 0)
+    {
+      event = g_async_queue_pop (engine.events);
+
+      switch (event->type)
+        {
+        case THUNAR_IO_TRASH_EVENT_TRASHED:
+          thunar_job_processing_file (job, event->file);
+
+          /* update the thumbnail cache in batches */
+          cleanup_list = g_list_prepend (cleanup_list, g_object_ref (event->file));
+          if (++n_cleanup >= THUNAR_IO_TRASH_CLEANUP_SIZE)
+            {
+              thunar_thumbnail_cache_cleanup_files (thumbnail_cache, cleanup_list);
+              thunar_g_file_list_free (cleanup_list);
+              cleanup_list = NULL;
+              n_cleanup = 0;
+            }
+          break;
+
+        case THUNAR_IO_TRASH_EVENT_OTHER:
+          other_list = g_list_prepend (other_list, g_object_ref (event->file));
+          break;
+
+        case THUNAR_IO_TRASH_EVENT_FAILED:
+          /* remember the first error and stop the other volumes */
+          if (err == NULL)
+            err = event->error;
+          else
+            g_error_free (event->error);
+          g_atomic_int_set (&engine.stop, 1);
+          break;
+
+        case THUNAR_IO_TRASH_EVENT_DONE:
+          n_running--;
+          break;
+        }
+
+      if (event->file != NULL)
+        g_object_unref (event->file);
+      g_slice_free (ThunarIoTrashEvent, event);
+    }
+
+  thunar_thumbnail_cache_cleanup_files (thumbnail_cache, cleanup_list);
+  thunar_g_file_list_free (cleanup_list);
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+  g_async_queue_unref (engine.events);
+  g_list_free_full (dirs, (GDestroyNotify) thunar_io_trash_dir_free);
+
+  *other_list_return = g_list_reverse (other_list);
+
+  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+    {
+      g_clear_error (&err);
+      return FALSE;
+    }
+
+  if (G_UNLIKELY (err != NULL))
+    {
+      g_propagate_error (error, err);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+
+static void
+thunar_io_trash_add_directory (GPtrArray   *directories,
+                               const gchar *path,
+                               gboolean    *complete_return)
+{
+  struct stat statb;
+  guint       n;
+
+  if (g_lstat (path, &statb) != 0)
+    return;
+
+  /* only use trash directories that belong to us, GVfs may still
+   * know what to do with the others */
+  if (!S_ISDIR (statb.st_mode) || statb.st_uid != getuid ())
+    {
+      if (complete_return != NULL)
+        *complete_return = FALSE;
+      return;
+    }
+
+  for (n = 0; n < directories->len; ++n)
+    if (strcmp (g_ptr_array_index (directories, n), path) == 0)
+      return;
+
+  g_ptr_array_add (directories, g_strdup (path));
+}
+
+
+
+/**
+ * thunar_io_trash_get_directories:
+ * @complete_return : return location for whether all trash directories
+ *                    were found, or %NULL.
+ *
+ * Looks up the local trash directories of the user, which are the
+ * trash in the home directory and the trash directories on the
+ * mounted volumes. Only directories that already exist are returned.
+ *
+ * @complete_return is set to %FALSE if a trash directory exists but
+ * cannot be used, or if the volumes cannot be looked at.
+ *
+ * Return value: a #GPtrArray of paths, free with g_ptr_array_free().
+ **/
+GPtrArray *
+thunar_io_trash_get_directories (gboolean *complete_return)
+{
+  GPtrArray   *directories;
+  gchar       *path;
+#ifdef HAVE_GIO_UNIX
+  const gchar *mount_path;
+  GList       *mounts;
+  GList       *lp;
+  gchar       *uid;
+  gchar       *name;
+#endif
+
+  directories = g_ptr_array_new_with_free_func (g_free);
+
+  if (complete_return != NULL)
+    *complete_return = TRUE;
+
+  path = g_build_filename (g_get_user_data_dir (), "Trash", NULL);
+  thunar_io_trash_add_directory (directories, path, complete_return);
+  g_free (path);
+
+#ifdef HAVE_GIO_UNIX
+  uid = g_strdup_printf ("%lu", (gulong) getuid ());
+  name = g_strconcat (".Trash-", uid, NULL);
+
+  /* look for the trash directories on the mounted volumes */
+  mounts = g_unix_mounts_get (NULL);
+  for (lp = mounts; lp != NULL; lp = lp->next)
+    {
+      if (g_unix_mount_is_system_internal (lp->data))
+        continue;
+
+      mount_path = g_unix_mount_get_mount_path (lp->data);
+
+      path = g_build_filename (mount_path, ".Trash", uid, NULL);
+      thunar_io_trash_add_directory (directories, path, complete_return);
+      g_free (path);
+
+      path = g_build_filename (mount_path, name, NULL);
+      thunar_io_trash_add_directory (directories, path, complete_return);
+      g_free (path);
+    }
+  g_list_free_full (mounts, (GDestroyNotify) g_unix_mount_free);
+
+  g_free (name);
+  g_free (uid);
+#else
+  /* the trash directories on the volumes are unknown */
+  if (complete_return != NULL)
+    *complete_return = FALSE;
+#endif
+
+  return directories;
+}
+
+
+
+static GPtrArray *
+thunar_io_trash_list_directory (const gchar *path)
+{
+  struct dirent *d;
+  GPtrArray     *names;
+  DIR           *dp;
+
+  names = g_ptr_array_new_with_free_func (g_free);
+
+  dp = opendir (path);
+  if (G_UNLIKELY (dp == NULL))
+    return names;
+
+  while ((d = readdir (dp)) != NULL)
+    {
+      /* skip the special entries */
+      if (d->d_name[0] == '.'
+          && (d->d_name[1] == '\0' || (d->d_name[1] == '.' && d->d_name[2] == '\0')))
+        continue;
+
+      g_ptr_array_add (names, g_strdup (d->d_name));
+    }
+
+  closedir (dp);
+
+  return names;
+}
+
+
+
+static void
+thunar_io_trash_empty_entry (ThunarJob            *job,
+                             const gchar          *trash_path,
+                             const gchar          *name,
+                             ThunarThumbnailCache *thumbnail_cache,
+                             GError              **error)
+{
+  ThunarJobResponse response;
+  struct stat       statb;
+  GError           *err = NULL;
+  GFile            *file;
+  gchar            *path;
+  gchar            *info_path;
+  gchar            *info_name;
+  gchar            *display_name;
+  gint              errnum;
+
+  path = g_build_filename (trash_path, "files", name, NULL);
+  file = g_file_new_for_path (path);
+
+  /* update progress information */
+  thunar_job_processing_file (job, file);
+
+  if (g_lstat (path, &statb) == 0 && S_ISDIR (statb.st_mode))
+    {
+      /* remove whole trees with the parallel delete engine, it only
+       * refuses if the directory went away in the meantime */
+      if (!thunar_io_delete_tree (job, file, thumbnail_cache, &err)
+          && g_error_matches (err, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+        g_clear_error (&err);
+    }
+  else
+    {
+      while (g_unlink (path) != 0 && errno != ENOENT)
+        {
+          errnum = errno;
+
+          /* ask the user whether he wants to skip this file */
+          display_name = g_filename_display_name (name);
+          response = thunar_job_ask_skip (job, _("Could not delete file \"%s\": %s"),
+                                          display_name, g_strerror (errnum));
+          g_free (display_name);
+
+          /* check whether to retry */
+          if (response != THUNAR_JOB_RESPONSE_RETRY)
+            break;
+        }
+
+      /* notify the thumbnail cache that the corresponding thumbnail can also
+       * be deleted now */
+      thunar_thumbnail_cache_delete_file (thumbnail_cache, file);
+    }
+
+  /* drop the information file once the entry is gone */
+  if (g_lstat (path, &statb) != 0)
+    {
+      info_name = g_strconcat (name, ".trashinfo", NULL);
+      info_path = g_build_filename (trash_path, "info", info_name, NULL);
+      g_unlink (info_path);
+      g_free (info_path);
+      g_free (info_name);
+    }
+
+  g_object_unref (file);
+  g_free (path);
+
+  if (G_UNLIKELY (err != NULL))
+    g_propagate_error (error, err);
+}
+
+
+
+/**
+ * thunar_io_trash_empty:
+ * @job             : the #ThunarJob emptying the trash.
+ * @thumbnail_cache : a #ThunarThumbnailCache.
+ * @complete_return : return location for whether all trash directories
+ *                    were handled, or %NULL.
+ * @error           : return location for errors or %NULL.
+ *
+ * Empties the local trash directories of the user, the one in the home
+ * directory and those on the mounted volumes, without going through
+ * GVfs. The entries of all files/ directories are counted up front to
+ * set the job progress. Directories are removed with the parallel
+ * thunar_io_delete_tree(), the .trashinfo files are dropped once their
+ * entry is gone.
+ *
+ * @complete_return is set to %FALSE if there may be trash directories
+ * that were not handled here, see thunar_io_trash_get_directories().
+ *
+ * Return value: %FALSE if the job failed or was cancelled.
+ **/
+gboolean
+thunar_io_trash_empty (ThunarJob            *job,
+                       ThunarThumbnailCache *thumbnail_cache,
+                       gboolean             *complete_return,
+                       GError              **error)
+{
+  struct stat  statb;
+  const gchar *trash_path;
+  GPtrArray   *directories;
+  GPtrArray  **entries;
+  GPtrArray   *infos;
+  GError      *err = NULL;
+  gchar       *path;
+  gchar       *name;
+  guint        n_total = 0;
+  guint        n, m;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
+  _thunar_return_val_if_fail (THUNAR_IS_THUMBNAIL_CACHE (thumbnail_cache), FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  directories = thunar_io_trash_get_directories (complete_return);
+  entries = g_new0 (GPtrArray *, directories->len);
+
+  /* the top-level entries are counted quickly, without descending */
+  for (n = 0; n < directories->len; ++n)
+    {
+      path = g_build_filename (g_ptr_array_index (directories, n), "files", NULL);
+      entries[n] = thunar_io_trash_list_directory (path);
+      n_total += entries[n]->len;
+      g_free (path);
+    }
+
+  /* we know the total number of entries to process */
+  thunar_job_set_total_files (job, n_total);
+
+  for (n = 0; err == NULL && n < directories->len; ++n)
+    {
+      trash_path = g_ptr_array_index (directories, n);
+
+      for (m = 0;
+           err == NULL && m < entries[n]->len && !exo_job_is_cancelled (EXO_JOB (job));
+           ++m)
+        {
+          thunar_io_trash_empty_entry (job, trash_path, g_ptr_array_index (entries[n], m),
+                                       thumbnail_cache, &err);
+        }
+
+      if (err != NULL || exo_job_is_cancelled (EXO_JOB (job)))
+        break;
+
+      /* drop information files without a trashed file */
+      path = g_build_filename (trash_path, "info", NULL);
+      infos = thunar_io_trash_list_directory (path);
+      g_free (path);
+
+      for (m = 0; m < infos->len; ++m)
+        {
+          name = g_ptr_array_index (infos, m);
+          if (!g_str_has_suffix (name, ".trashinfo"))
+            continue;
+
+          path = g_build_filename (trash_path, "files", name, NULL);
+          path[strlen (path) - strlen (".trashinfo")] = '\0';
+          if (g_lstat (path, &statb) != 0 && errno == ENOENT)
+            {
+              g_free (path);
+              path = g_build_filename (trash_path, "info", name, NULL);
+              g_unlink (path);
+            }
+          g_free (path);
+        }
+
+      g_ptr_array_free (infos, TRUE);
+    }
+
+  for (n = 0; n < directories->len; ++n)
+    g_ptr_array_free (entries[n], TRUE);
+  g_free (entries);
+  g_ptr_array_free (directories, TRUE);
+
+  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+    {
+      g_clear_error (&err);
+      return FALSE;
+    }
+
+  if (G_UNLIKELY (err != NULL))
+    {
+      g_propagate_error (error, err);
+      return FALSE;
+    }
+
+  return TRUE;
+}
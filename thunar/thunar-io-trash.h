@@ -0,0 +1,44 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __THUNAR_IO_TRASH_H__
+#define __THUNAR_IO_TRASH_H__
+
+#include <gio/gio.h>
+
+#include <thunar/thunar-job.h>
+#include <thunar/thunar-thumbnail-cache.h>
+
+G_BEGIN_DECLS
+
+gboolean   thunar_io_trash_files           (ThunarJob            *job,
+                                            GList                *file_list,
+                                            ThunarThumbnailCache *thumbnail_cache,
+                                            GList               **other_list_return,
+                                            GError              **error);
+
+gboolean   thunar_io_trash_empty           (ThunarJob            *job,
+                                            ThunarThumbnailCache *thumbnail_cache,
+                                            gboolean             *complete_return,
+                                            GError              **error);
+
+GPtrArray *thunar_io_trash_get_directories (gboolean             *complete_return) G_GNUC_MALLOC;
+
+G_END_DECLS
+
+#endif /* !__THUNAR_IO_TRASH_H__ */
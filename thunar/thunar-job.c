@@ -40,6 +40,9 @@
 
 #define THUNAR_JOB_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), THUNAR_TYPE_JOB, ThunarJobPrivate))
 
+/* minimum time between two progress updates in microseconds */
+#define THUNAR_JOB_UPDATE_INTERVAL (100 * 1000)
+
 
 
 /* Signal identifiers */
@@ -69,7 +72,9 @@ struct _ThunarJobPrivate
   ThunarJobResponse earlier_ask_create_response;
   ThunarJobResponse earlier_ask_overwrite_response;
   ThunarJobResponse earlier_ask_skip_response;
-  GList            *total_files;
+  guint             n_total_files;
+  guint             n_processed_files;
+  gint64            last_update_time;
 };
 
 
@@ -546,6 +551,39 @@ thunar_job_ask_no_size (ThunarJob   *job,
 
 
 
+ThunarJobResponse
+thunar_job_ask_resume (ThunarJob   *job,
+                       const gchar *format,
+                       ...)
+{
+  ThunarJobResponse response;
+  va_list           var_args;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), THUNAR_JOB_RESPONSE_CANCEL);
+  _thunar_return_val_if_fail (format != NULL, THUNAR_JOB_RESPONSE_CANCEL);
+
+  /* check if the user already cancelled the job */
+  if (G_UNLIKELY (exo_job_is_cancelled (EXO_JOB (job))))
+    return THUNAR_JOB_RESPONSE_CANCEL;
+
+  /* ask the user what he wants to do */
+  va_start (var_args, format);
+  response = _thunar_job_ask_valist (job, format, var_args,
+                                     _("Do you want to resume it?"),
+                                     THUNAR_JOB_RESPONSE_YES
+                                     | THUNAR_JOB_RESPONSE_NO
+                                     | THUNAR_JOB_RESPONSE_CANCEL);
+  va_end (var_args);
+
+  /* cancel the job if the user does not want to continue */
+  if (response == THUNAR_JOB_RESPONSE_CANCEL)
+    exo_job_cancel (EXO_JOB (job));
+
+  return response;
+}
+
+
+
 gboolean
 thunar_job_files_ready (ThunarJob *job,
                         GList     *file_list)
@@ -591,31 +629,36 @@ thunar_job_new_files (ThunarJob   *job,
 
 void
 thunar_job_set_total_files (ThunarJob *job,
-                            GList     *total_files)
+                            guint      n_total_files)
 {
   _thunar_return_if_fail (THUNAR_IS_JOB (job));
-  _thunar_return_if_fail (job->priv->total_files == NULL);
-  _thunar_return_if_fail (total_files != NULL);
 
-  job->priv->total_files = total_files;
+  /* jobs with several passes may raise the total later on */
+  job->priv->n_total_files = n_total_files;
 }
 
 
 
 void
 thunar_job_processing_file (ThunarJob *job,
-                            GList     *current_file)
+                            GFile     *current_file)
 {
-  GList *lp;
-  gchar *base_name;
-  gchar *display_name;
-  guint  n_processed;
-  guint  n_total;
+  gint64  now;
+  gchar  *base_name;
+  gchar  *display_name;
 
   _thunar_return_if_fail (THUNAR_IS_JOB (job));
-  _thunar_return_if_fail (current_file != NULL);
+  _thunar_return_if_fail (G_IS_FILE (current_file));
+
+  job->priv->n_processed_files++;
+
+  /* don't flood the main loop with updates for small files */
+  now = g_get_monotonic_time ();
+  if (now - job->priv->last_update_time < THUNAR_JOB_UPDATE_INTERVAL)
+    return;
+  job->priv->last_update_time = now;
 
-  base_name = g_file_get_basename (current_file->data);
+  base_name = g_file_get_basename (current_file);
   display_name = g_filename_display_name (base_name);
   g_free (base_name);
 
@@ -623,20 +666,9 @@ thunar_job_processing_file (ThunarJob *job,
   g_free (display_name);
 
   /* verify that we have total files set */
-  if (G_LIKELY (job->priv->total_files != NULL))
+  if (G_LIKELY (job->priv->n_total_files > 0))
     {
-      /* determine the number of files processed so far */
-      for (lp = job->priv->total_files, n_processed = 0;
-           lp != current_file;
-           lp = lp->next, n_processed++);
-
-      /* emit only if n_processed is a multiple of 8 */
-      if ((n_processed % 8) == 0)
-        {
-          /* determine the total_number of files */
-          n_total = g_list_length (job->priv->total_files);
-
-          exo_job_percent (EXO_JOB (job), (n_processed * 100.0) / n_total);
-        }
+      exo_job_percent (EXO_JOB (job), ((job->priv->n_processed_files - 1) * 100.0)
+                                      / MAX (job->priv->n_total_files, job->priv->n_processed_files));
     }
 }
@@ -36,6 +36,7 @@
 #include <thunar/thunar-list-model.h>
 #include <thunar/thunar-preferences.h>
 #include <thunar/thunar-private.h>
+#include <thunar/thunar-size-cache.h>
 #include <thunar/thunar-user.h>
 
 
@@ -141,6 +142,9 @@ static void               thunar_list_model_sort                  (ThunarListMod
 static void               thunar_list_model_file_changed          (ThunarFileMonitor      *file_monitor,
                                                                    ThunarFile             *file,
                                                                    ThunarListModel        *store);
+static void               thunar_list_model_size_changed          (ThunarSizeCache        *size_cache,
+                                                                   ThunarFile             *file,
+                                                                   ThunarListModel        *store);
 static void               thunar_list_model_folder_destroy        (ThunarFolder           *folder,
                                                                    ThunarListModel        *store);
 static void               thunar_list_model_folder_error          (ThunarFolder           *folder,
@@ -179,6 +183,9 @@ static gint               sort_by_size_in_bytes                   (const ThunarF
 static gint               sort_by_type                            (const ThunarFile       *a,
                                                                    const ThunarFile       *b,
                                                                    gboolean                case_sensitive);
+static gint               sort_by_recursive_size                  (const ThunarFile       *a,
+                                                                   const ThunarFile       *b,
+                                                                   gboolean                case_sensitive);
 
 static gboolean           thunar_list_model_get_case_sensitive    (ThunarListModel        *store);
 static void               thunar_list_model_set_case_sensitive    (ThunarListModel        *store,
@@ -229,6 +236,9 @@ struct _ThunarListModel
    */
   ThunarFileMonitor *file_monitor;
 
+  /* the sizes of the directories for THUNAR_COLUMN_RECURSIVE_SIZE */
+  ThunarSizeCache   *size_cache;
+
   /* ids for the "row-inserted" and "row-deleted" signals
    * of GtkTreeModel to speed up folder changing.
    */
@@ -246,6 +256,10 @@ struct _ThunarListModel
 static guint       list_model_signals[LAST_SIGNAL];
 static GParamSpec *list_model_props[N_PROPERTIES] = { NULL, };
 
+/* the shared size cache, which every list model holds a reference
+ * on, so sort_by_recursive_size() does not have to look it up */
+static ThunarSizeCache *list_model_size_cache = NULL;
+
 
 
 G_DEFINE_TYPE_WITH_CODE (ThunarListModel, thunar_list_model, G_TYPE_OBJECT,
@@ -449,6 +463,12 @@ thunar_list_model_init (ThunarListModel *store)
   store->file_monitor = thunar_file_monitor_get_default ();
   g_signal_connect (G_OBJECT (store->file_monitor), "file-changed",
                     G_CALLBACK (thunar_list_model_file_changed), store);
+
+  /* redraw the directories once their size is known */
+  store->size_cache = thunar_size_cache_get ();
+  g_signal_connect (G_OBJECT (store->size_cache), "size-changed",
+                    G_CALLBACK (thunar_list_model_size_changed), store);
+  list_model_size_cache = store->size_cache;
 }
 
 
@@ -475,6 +495,10 @@ thunar_list_model_finalize (GObject *object)
   g_signal_handlers_disconnect_by_func (G_OBJECT (store->file_monitor), thunar_list_model_file_changed, store);
   g_object_unref (G_OBJECT (store->file_monitor));
 
+  /* disconnect from the size cache */
+  g_signal_handlers_disconnect_by_func (G_OBJECT (store->size_cache), thunar_list_model_size_changed, store);
+  g_object_unref (G_OBJECT (store->size_cache));
+
   (*G_OBJECT_CLASS (thunar_list_model_parent_class)->finalize) (object);
 }
 
@@ -628,6 +652,9 @@ thunar_list_model_get_column_type (GtkTreeModel *model,
     case THUNAR_COLUMN_TYPE:
       return G_TYPE_STRING;
 
+    case THUNAR_COLUMN_RECURSIVE_SIZE:
+      return G_TYPE_STRING;
+
     case THUNAR_COLUMN_FILE:
       return THUNAR_TYPE_FILE;
 
@@ -699,6 +726,7 @@ thunar_list_model_get_value (GtkTreeModel *model,
   const gchar *real_name;
   ThunarUser  *user;
   ThunarFile  *file;
+  guint64      size;
   gchar       *str;
 
   _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (model));
@@ -798,6 +826,14 @@ thunar_list_model_get_value (GtkTreeModel *model,
         }
       break;
 
+    case THUNAR_COLUMN_RECURSIVE_SIZE:
+      g_value_init (value, G_TYPE_STRING);
+      if (thunar_size_cache_get_allocated_size (THUNAR_LIST_MODEL (model)->size_cache, file, &size))
+        g_value_take_string (value, g_format_size_full (size, THUNAR_LIST_MODEL (model)->file_size_binary ? G_FORMAT_SIZE_IEC_UNITS : G_FORMAT_SIZE_DEFAULT));
+      else if (thunar_file_is_directory (file) && thunar_file_is_local (file))
+        thunar_size_cache_request (THUNAR_LIST_MODEL (model)->size_cache, file);
+      break;
+
     case THUNAR_COLUMN_FILE:
       g_value_init (value, THUNAR_TYPE_FILE);
       g_value_set_object (value, file);
@@ -953,6 +989,8 @@ thunar_list_model_get_sort_column_id (GtkTreeSortable *sortable,
     *sort_column_id = THUNAR_COLUMN_DATE_MODIFIED;
   else if (store->sort_func == sort_by_type)
     *sort_column_id = THUNAR_COLUMN_TYPE;
+  else if (store->sort_func == sort_by_recursive_size)
+    *sort_column_id = THUNAR_COLUMN_RECURSIVE_SIZE;
   else if (store->sort_func == sort_by_owner)
     *sort_column_id = THUNAR_COLUMN_OWNER;
   else if (store->sort_func == sort_by_group)
@@ -1025,6 +1063,10 @@ thunar_list_model_set_sort_column_id (GtkTreeSortable *sortable,
       store->sort_func = sort_by_type;
       break;
 
+    case THUNAR_COLUMN_RECURSIVE_SIZE:
+      store->sort_func = sort_by_recursive_size;
+      break;
+
     default:
       _thunar_assert_not_reached ();
     }
@@ -1237,6 +1279,21 @@ thunar_list_model_file_changed (ThunarFileMonitor *file_monitor,
 
 
 
+static void
+thunar_list_model_size_changed (ThunarSizeCache *size_cache,
+                                ThunarFile      *file,
+                                ThunarListModel *store)
+{
+  _thunar_return_if_fail (THUNAR_IS_SIZE_CACHE (size_cache));
+  _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (store));
+  _thunar_return_if_fail (THUNAR_IS_FILE (file));
+
+  /* redraw and resort the row, if the folder is in this model */
+  thunar_list_model_file_changed (store->file_monitor, file, store);
+}
+
+
+
 static void
 thunar_list_model_folder_destroy (ThunarFolder    *folder,
                                   ThunarListModel *store)
@@ -1614,6 +1671,28 @@ sort_by_size_in_bytes (const ThunarFile *a,
 
 
 
+static gint
+sort_by_recursive_size (const ThunarFile *a,
+                        const ThunarFile *b,
+                        gboolean          case_sensitive)
+{
+  guint64 size_a = 0;
+  guint64 size_b = 0;
+
+  /* folders that were not counted yet sort as empty */
+  thunar_size_cache_get_allocated_size (list_model_size_cache, a, &size_a);
+  thunar_size_cache_get_allocated_size (list_model_size_cache, b, &size_b);
+
+  if (size_a < size_b)
+    return -1;
+  else if (size_a > size_b)
+    return 1;
+
+  return thunar_file_compare_by_name (a, b, case_sensitive);
+}
+
+
+
 static gint
 sort_by_type (const ThunarFile *a,
               const ThunarFile *b,
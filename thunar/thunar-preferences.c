@@ -81,20 +81,27 @@ enum
   PROP_MISC_FOLDERS_FIRST,
   PROP_MISC_FULL_PATH_IN_TITLE,
   PROP_MISC_HORIZONTAL_WHEEL_NAVIGATES,
+  PROP_MISC_ICON_DISK_CACHE,
   PROP_MISC_IMAGE_SIZE_IN_STATUSBAR,
+  PROP_MISC_JOBS_PER_DEVICE,
   PROP_MISC_MIDDLE_CLICK_IN_TAB,
   PROP_MISC_OPEN_NEW_WINDOW_AS_TAB,
+  PROP_MISC_PARALLEL_COPY,
+  PROP_MISC_PRESERVE_HARDLINKS,
   PROP_MISC_RECURSIVE_PERMISSIONS,
   PROP_MISC_REMEMBER_GEOMETRY,
   PROP_MISC_SHOW_ABOUT_TEMPLATES,
   PROP_MISC_SHOW_DELETE_ACTION,
   PROP_MISC_SINGLE_CLICK,
   PROP_MISC_SINGLE_CLICK_TIMEOUT,
+  PROP_MISC_SKIP_IDENTICAL,
+  PROP_MISC_SKIP_IDENTICAL_COMPARE,
   PROP_MISC_SMALL_TOOLBAR_ICONS,
   PROP_MISC_TAB_CLOSE_MIDDLE_CLICK,
   PROP_MISC_TEXT_BESIDE_ICONS,
   PROP_MISC_THUMBNAIL_MODE,
   PROP_MISC_THUMBNAIL_DRAW_FRAMES,
+  PROP_MISC_VERIFY_COPIES,
   PROP_MISC_FILE_SIZE_BINARY,
   PROP_SHORTCUTS_ICON_EMBLEMS,
   PROP_SHORTCUTS_ICON_SIZE,
@@ -563,6 +570,19 @@ thunar_preferences_class_init (ThunarPreferencesClass *klass)
                             FALSE,
                             EXO_PARAM_READWRITE);
 
+  /**
+   * ThunarPreferences:misc-icon-disk-cache:
+   *
+   * Whether to keep the rendered theme icons in the user's cache
+   * directory, so they don't need to be rendered again on startup.
+   **/
+  preferences_props[PROP_MISC_ICON_DISK_CACHE] =
+      g_param_spec_boolean ("misc-icon-disk-cache",
+                            NULL,
+                            NULL,
+                            FALSE,
+                            EXO_PARAM_READWRITE);
+
   /**
    * ThunarPreferences:misc-image-size-in-statusbar:
    *
@@ -577,6 +597,20 @@ thunar_preferences_class_init (ThunarPreferencesClass *klass)
                             FALSE,
                             EXO_PARAM_READWRITE);
 
+  /**
+   * ThunarPreferences:misc-jobs-per-device:
+   *
+   * The number of file operations that run at the same time on
+   * a single filesystem, further operations are queued. 0 means
+   * that all operations run at once.
+   **/
+  preferences_props[PROP_MISC_JOBS_PER_DEVICE] =
+      g_param_spec_uint ("misc-jobs-per-device",
+                         "MiscJobsPerDevice",
+                         NULL,
+                         0u, G_MAXUINT, 1u,
+                         EXO_PARAM_READWRITE);
+
   /**
    * ThunarPreferences:misc-middle-click-in-tab:
    *
@@ -602,6 +636,32 @@ thunar_preferences_class_init (ThunarPreferencesClass *klass)
                             FALSE,
                             EXO_PARAM_READWRITE);
 
+  /**
+   * ThunarPreferences:misc-parallel-copy:
+   *
+   * Whether transfer jobs copy small files concurrently using
+   * a pool of worker threads.
+   **/
+  preferences_props[PROP_MISC_PARALLEL_COPY] =
+      g_param_spec_boolean ("misc-parallel-copy",
+                            "MiscParallelCopy",
+                            NULL,
+                            TRUE,
+                            EXO_PARAM_READWRITE);
+
+  /**
+   * ThunarPreferences:misc-preserve-hardlinks:
+   *
+   * Whether transfer jobs recreate hard links between the copied
+   * files instead of copying the data of each link again.
+   **/
+  preferences_props[PROP_MISC_PRESERVE_HARDLINKS] =
+      g_param_spec_boolean ("misc-preserve-hardlinks",
+                            "MiscPreserveHardlinks",
+                            NULL,
+                            TRUE,
+                            EXO_PARAM_READWRITE);
+
   /**
    * ThunarPreferences:misc-recursive-permissions:
    *
@@ -685,6 +745,33 @@ thunar_preferences_class_init (ThunarPreferencesClass *klass)
                          0u, G_MAXUINT, 500u,
                          EXO_PARAM_READWRITE);
 
+  /**
+   * ThunarPreferences:misc-skip-identical:
+   *
+   * Whether transfer jobs skip existing files with the same size and a
+   * modification time not older than the source, instead of asking the
+   * user to replace them.
+   **/
+  preferences_props[PROP_MISC_SKIP_IDENTICAL] =
+      g_param_spec_boolean ("misc-skip-identical",
+                            "MiscSkipIdentical",
+                            NULL,
+                            FALSE,
+                            EXO_PARAM_READWRITE);
+
+  /**
+   * ThunarPreferences:misc-skip-identical-compare:
+   *
+   * Whether the contents of the files are compared as well, before
+   * an existing file is skipped as identical.
+   **/
+  preferences_props[PROP_MISC_SKIP_IDENTICAL_COMPARE] =
+      g_param_spec_boolean ("misc-skip-identical-compare",
+                            "MiscSkipIdenticalCompare",
+                            NULL,
+                            FALSE,
+                            EXO_PARAM_READWRITE);
+
   /**
    * ThunarPreferences:misc-small-toolbar-icons:
    *
@@ -750,6 +837,19 @@ thunar_preferences_class_init (ThunarPreferencesClass *klass)
                             FALSE,
                             EXO_PARAM_READWRITE);
 
+  /**
+   * ThunarPreferences:misc-verify-copies:
+   *
+   * Whether copied files are read back from the disk and compared
+   * with the data that was written.
+   **/
+  preferences_props[PROP_MISC_VERIFY_COPIES] =
+      g_param_spec_boolean ("misc-verify-copies",
+                            "MiscVerifyCopies",
+                            NULL,
+                            FALSE,
+                            EXO_PARAM_READWRITE);
+
   /**
    * ThunarPreferences:misc-file-size-binary:
    *
@@ -405,3 +405,41 @@ thunar_progress_dialog_has_jobs (ThunarProgressDialog *dialog)
   _thunar_return_val_if_fail (THUNAR_IS_PROGRESS_DIALOG (dialog), FALSE);
   return dialog->views != NULL;
 }
+
+
+
+/**
+ * thunar_progress_dialog_set_job_queued:
+ * @dialog : a #ThunarProgressDialog.
+ * @job    : a #ThunarJob added to @dialog.
+ * @queued : whether @job waits in the job scheduler.
+ * @paused : whether the user paused @job.
+ *
+ * Updates the view of @job. Queued views are moved to the end
+ * of the dialog, so calling this for every job in the order of
+ * the queue also orders the views.
+ **/
+void
+thunar_progress_dialog_set_job_queued (ThunarProgressDialog *dialog,
+                                       ThunarJob            *job,
+                                       gboolean              queued,
+                                       gboolean              paused)
+{
+  GList *lp;
+
+  _thunar_return_if_fail (THUNAR_IS_PROGRESS_DIALOG (dialog));
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
+
+  for (lp = dialog->views; lp != NULL; lp = lp->next)
+    {
+      if (thunar_progress_view_get_job (lp->data) != job)
+        continue;
+
+      thunar_progress_view_set_queued (lp->data, queued, paused);
+
+      if (queued)
+        gtk_box_reorder_child (GTK_BOX (dialog->content_box), lp->data, -1);
+
+      break;
+    }
+}
@@ -24,6 +24,7 @@
 
 #include <exo/exo.h>
 
+#include <thunar/thunar-application.h>
 #include <thunar/thunar-dialogs.h>
 #include <thunar/thunar-gobject-extensions.h>
 #include <thunar/thunar-job.h>
@@ -56,6 +57,9 @@ static void              thunar_progress_view_set_property (GObject            *
                                                             const GValue       *value,
                                                             GParamSpec         *pspec);
 static void              thunar_progress_view_cancel_job   (ThunarProgressView *view);
+static void              thunar_progress_view_move_up      (ThunarProgressView *view);
+static void              thunar_progress_view_move_down    (ThunarProgressView *view);
+static void              thunar_progress_view_toggle_pause (ThunarProgressView *view);
 static ThunarJobResponse thunar_progress_view_ask          (ThunarProgressView *view,
                                                             const gchar        *message,
                                                             ThunarJobResponse   choices,
@@ -75,7 +79,6 @@ static void              thunar_progress_view_info_message (ThunarProgressView *
 static void              thunar_progress_view_percent      (ThunarProgressView *view,
                                                             gdouble             percent,
                                                             ExoJob             *job);
-static ThunarJob        *thunar_progress_view_get_job      (ThunarProgressView *view);
 static void              thunar_progress_view_set_job      (ThunarProgressView *view,
                                                             ThunarJob          *job);
 
@@ -96,6 +99,12 @@ struct _ThunarProgressView
   GtkWidget *progress_label;
   GtkWidget *message_label;
 
+  /* controls while the job waits in the job scheduler */
+  GtkWidget *queue_box;
+  GtkWidget *pause_button;
+  gboolean   queued;
+  gboolean   paused;
+
   gchar     *icon_name;
   gchar     *title;
 };
@@ -228,6 +237,30 @@ thunar_progress_view_init (ThunarProgressView *view)
   gtk_box_pack_start (GTK_BOX (vbox3), view->progress_label, FALSE, TRUE, 0);
   gtk_widget_show (view->progress_label);
 
+  view->queue_box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+  gtk_box_pack_start (GTK_BOX (hbox), view->queue_box, FALSE, TRUE, 0);
+
+  button = gtk_button_new_from_icon_name ("go-up", GTK_ICON_SIZE_BUTTON);
+  gtk_widget_set_tooltip_text (button, _("Move up in the queue"));
+  g_signal_connect_swapped (button, "clicked", G_CALLBACK (thunar_progress_view_move_up), view);
+  gtk_box_pack_start (GTK_BOX (view->queue_box), button, FALSE, TRUE, 0);
+  gtk_widget_set_can_focus (button, FALSE);
+  gtk_widget_show (button);
+
+  button = gtk_button_new_from_icon_name ("go-down", GTK_ICON_SIZE_BUTTON);
+  gtk_widget_set_tooltip_text (button, _("Move down in the queue"));
+  g_signal_connect_swapped (button, "clicked", G_CALLBACK (thunar_progress_view_move_down), view);
+  gtk_box_pack_start (GTK_BOX (view->queue_box), button, FALSE, TRUE, 0);
+  gtk_widget_set_can_focus (button, FALSE);
+  gtk_widget_show (button);
+
+  view->pause_button = gtk_button_new_from_icon_name ("media-playback-pause", GTK_ICON_SIZE_BUTTON);
+  gtk_widget_set_tooltip_text (view->pause_button, _("Pause"));
+  g_signal_connect_swapped (view->pause_button, "clicked", G_CALLBACK (thunar_progress_view_toggle_pause), view);
+  gtk_box_pack_start (GTK_BOX (view->queue_box), view->pause_button, FALSE, TRUE, 0);
+  gtk_widget_set_can_focus (view->pause_button, FALSE);
+  gtk_widget_show (view->pause_button);
+
   button = gtk_button_new_from_icon_name ("process-stop", GTK_ICON_SIZE_BUTTON);
   gtk_button_set_label (GTK_BUTTON (button), _("Cancel"));
   g_signal_connect_swapped (button, "clicked", G_CALLBACK (thunar_progress_view_cancel_job), view);
@@ -357,6 +390,51 @@ thunar_progress_view_cancel_job (ThunarProgressView *view)
 
 
 
+static void
+thunar_progress_view_move_up (ThunarProgressView *view)
+{
+  ThunarApplication *application;
+
+  _thunar_return_if_fail (THUNAR_IS_PROGRESS_VIEW (view));
+  _thunar_return_if_fail (THUNAR_IS_JOB (view->job));
+
+  application = thunar_application_get ();
+  thunar_application_move_job (application, view->job, TRUE);
+  g_object_unref (application);
+}
+
+
+
+static void
+thunar_progress_view_move_down (ThunarProgressView *view)
+{
+  ThunarApplication *application;
+
+  _thunar_return_if_fail (THUNAR_IS_PROGRESS_VIEW (view));
+  _thunar_return_if_fail (THUNAR_IS_JOB (view->job));
+
+  application = thunar_application_get ();
+  thunar_application_move_job (application, view->job, FALSE);
+  g_object_unref (application);
+}
+
+
+
+static void
+thunar_progress_view_toggle_pause (ThunarProgressView *view)
+{
+  ThunarApplication *application;
+
+  _thunar_return_if_fail (THUNAR_IS_PROGRESS_VIEW (view));
+  _thunar_return_if_fail (THUNAR_IS_JOB (view->job));
+
+  application = thunar_application_get ();
+  thunar_application_pause_job (application, view->job, !view->paused);
+  g_object_unref (application);
+}
+
+
+
 static ThunarJobResponse
 thunar_progress_view_ask (ThunarProgressView *view,
                           const gchar        *message,
@@ -516,7 +594,7 @@ thunar_progress_view_new_with_job (ThunarJob *job)
  *
  * Return value: the job associated with @view or %NULL.
  **/
-static ThunarJob *
+ThunarJob *
 thunar_progress_view_get_job (ThunarProgressView *view)
 {
   _thunar_return_val_if_fail (THUNAR_IS_PROGRESS_VIEW (view), NULL);
@@ -602,3 +680,43 @@ thunar_progress_view_set_title (ThunarProgressView *view,
 
   g_object_notify (G_OBJECT (view), "title");
 }
+
+
+
+/**
+ * thunar_progress_view_set_queued:
+ * @view   : a #ThunarProgressView.
+ * @queued : whether the job of @view waits in the job scheduler.
+ * @paused : whether the user paused the queued job.
+ *
+ * Shows the queue controls of @view while its job is queued.
+ **/
+void
+thunar_progress_view_set_queued (ThunarProgressView *view,
+                                 gboolean            queued,
+                                 gboolean            paused)
+{
+  _thunar_return_if_fail (THUNAR_IS_PROGRESS_VIEW (view));
+
+  if (view->queued == queued && view->paused == paused)
+    return;
+
+  /* leave the status text to the job once it runs */
+  if (view->queued && !queued)
+    gtk_label_set_text (GTK_LABEL (view->progress_label), NULL);
+
+  view->queued = queued;
+  view->paused = paused;
+
+  gtk_widget_set_visible (view->queue_box, queued);
+
+  if (queued)
+    {
+      gtk_label_set_text (GTK_LABEL (view->progress_label), paused ? _("Paused") : _("Queued"));
+
+      gtk_button_set_image (GTK_BUTTON (view->pause_button),
+                            gtk_image_new_from_icon_name (paused ? "media-playback-start" : "media-playback-pause",
+                                                          GTK_ICON_SIZE_BUTTON));
+      gtk_widget_set_tooltip_text (view->pause_button, paused ? _("Resume") : _("Pause"));
+    }
+}
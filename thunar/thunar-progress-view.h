@@ -45,6 +45,10 @@ void       thunar_progress_view_set_icon_name (ThunarProgressView *view,
                                                const gchar        *icon_name);
 void       thunar_progress_view_set_title     (ThunarProgressView *view,
                                                const gchar        *title);
+ThunarJob *thunar_progress_view_get_job       (ThunarProgressView *view);
+void       thunar_progress_view_set_queued    (ThunarProgressView *view,
+                                               gboolean            queued,
+                                               gboolean            paused);
 
 G_END_DECLS;
 
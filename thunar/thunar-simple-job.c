@@ -41,9 +41,12 @@
 
 
 
-static void     thunar_simple_job_finalize   (GObject              *object);
-static gboolean thunar_simple_job_execute    (ExoJob               *job,
-                                              GError              **error);
+static void       thunar_simple_job_finalize   (GObject              *object);
+static gboolean   thunar_simple_job_execute    (ExoJob               *job,
+                                                GError              **error);
+static ThunarJob *thunar_simple_job_new_valist (ThunarSimpleJobFunc   func,
+                                                guint                 n_param_values,
+                                                va_list               var_args);
 
 
 
@@ -142,37 +145,12 @@ thunar_simple_job_execute (ExoJob  *job,
 
 
 
-/**
- * thunar_simple_job_launch:
- * @func           : the #ThunarSimpleJobFunc to execute the job.
- * @n_param_values : the number of parameters to pass to the @func.
- * @...            : a list of #GType and parameter pairs (exactly
- *                   @n_param_values pairs) that are passed to @func.
- *
- * Allocates a new #ThunarSimpleJob, which executes the specified
- * @func with the specified parameters.
- *
- * For example the listdir @func expects a #ThunarPath for the
- * folder to list, so the call to thunar_simple_job_launch()
- * would look like this:
- *
- * <informalexample><programlisting>
- * thunar_simple_job_launch (_thunar_io_jobs_listdir, 1,
- *                               THUNAR_TYPE_PATH, path);
- * </programlisting></informalexample>
- *
- * The caller is responsible to release the returned object using
- * thunar_job_unref() when no longer needed.
- *
- * Return value: the launched #ThunarJob.
- **/
-ThunarJob *
-thunar_simple_job_launch (ThunarSimpleJobFunc func,
-                          guint               n_param_values,
-                          ...)
+static ThunarJob *
+thunar_simple_job_new_valist (ThunarSimpleJobFunc func,
+                              guint               n_param_values,
+                              va_list             var_args)
 {
   ThunarSimpleJob *simple_job;
-  va_list          var_args;
   GValue           value = { 0, };
   gchar           *error_message;
   guint            n;
@@ -183,7 +161,6 @@ thunar_simple_job_launch (ThunarSimpleJobFunc func,
   simple_job->param_values = g_array_sized_new (FALSE, TRUE, sizeof (GValue), n_param_values);
 
   /* collect the parameters */
-  va_start (var_args, n_param_values);
   for (n = 0; n < n_param_values; ++n)
     {
       /* initialize the value to hold the next parameter */
@@ -205,10 +182,82 @@ thunar_simple_job_launch (ThunarSimpleJobFunc func,
        * because we don't want to free the data */
       memset (&value, 0, sizeof (GValue));
     }
+
+  return THUNAR_JOB (simple_job);
+}
+
+
+
+/**
+ * thunar_simple_job_new:
+ * @func           : the #ThunarSimpleJobFunc to execute the job.
+ * @n_param_values : the number of parameters to pass to the @func.
+ * @...            : a list of #GType and parameter pairs (exactly
+ *                   @n_param_values pairs) that are passed to @func.
+ *
+ * Works like thunar_simple_job_launch(), but does not launch the
+ * job, so the caller can decide when to run it using exo_job_launch().
+ *
+ * The caller is responsible to release the returned object using
+ * g_object_unref() when no longer needed.
+ *
+ * Return value: the newly allocated #ThunarJob.
+ **/
+ThunarJob *
+thunar_simple_job_new (ThunarSimpleJobFunc func,
+                       guint               n_param_values,
+                       ...)
+{
+  ThunarJob *job;
+  va_list    var_args;
+
+  va_start (var_args, n_param_values);
+  job = thunar_simple_job_new_valist (func, n_param_values, var_args);
+  va_end (var_args);
+
+  return job;
+}
+
+
+
+/**
+ * thunar_simple_job_launch:
+ * @func           : the #ThunarSimpleJobFunc to execute the job.
+ * @n_param_values : the number of parameters to pass to the @func.
+ * @...            : a list of #GType and parameter pairs (exactly
+ *                   @n_param_values pairs) that are passed to @func.
+ *
+ * Allocates a new #ThunarSimpleJob, which executes the specified
+ * @func with the specified parameters.
+ *
+ * For example the listdir @func expects a #ThunarPath for the
+ * folder to list, so the call to thunar_simple_job_launch()
+ * would look like this:
+ *
+ * <informalexample><programlisting>
+ * thunar_simple_job_launch (_thunar_io_jobs_listdir, 1,
+ *                               THUNAR_TYPE_PATH, path);
+ * </programlisting></informalexample>
+ *
+ * The caller is responsible to release the returned object using
+ * thunar_job_unref() when no longer needed.
+ *
+ * Return value: the launched #ThunarJob.
+ **/
+ThunarJob *
+thunar_simple_job_launch (ThunarSimpleJobFunc func,
+                          guint               n_param_values,
+                          ...)
+{
+  ThunarJob *job;
+  va_list    var_args;
+
+  va_start (var_args, n_param_values);
+  job = thunar_simple_job_new_valist (func, n_param_values, var_args);
   va_end (var_args);
 
   /* launch the job */
-  return THUNAR_JOB (exo_job_launch (EXO_JOB (simple_job)));
+  return THUNAR_JOB (exo_job_launch (EXO_JOB (job)));
 }
 
 
@@ -0,0 +1,801 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <libxfce4util/libxfce4util.h>
+
+#include <thunar/thunar-deep-count-job.h>
+#include <thunar/thunar-file-monitor.h>
+#include <thunar/thunar-private.h>
+#include <thunar/thunar-size-cache.h>
+
+
+
+/* the file in the cache directory the sizes are kept in */
+#define THUNAR_SIZE_CACHE_FILE "Thunar/directory-sizes"
+
+/* the maximum number of directories that are saved */
+#define THUNAR_SIZE_CACHE_MAX_SAVED (10000)
+
+/* delay before changes are written to disk, in seconds */
+#define THUNAR_SIZE_CACHE_SAVE_DELAY (5)
+
+
+
+/* Signal identifiers */
+enum
+{
+  SIZE_CHANGED,
+  LAST_SIGNAL,
+};
+
+
+
+typedef struct _ThunarSizeCacheEntry ThunarSizeCacheEntry;
+
+
+
+static void     thunar_size_cache_finalize          (GObject           *object);
+static void     thunar_size_cache_file_changed      (ThunarFileMonitor *file_monitor,
+                                                     ThunarFile        *file,
+                                                     ThunarSizeCache   *cache);
+static void     thunar_size_cache_file_destroyed    (ThunarFileMonitor *file_monitor,
+                                                     ThunarFile        *file,
+                                                     ThunarSizeCache   *cache);
+static void     thunar_size_cache_load              (ThunarSizeCache   *cache);
+static void     thunar_size_cache_save              (ThunarSizeCache   *cache);
+
+
+
+struct _ThunarSizeCacheClass
+{
+  GObjectClass __parent__;
+};
+
+struct _ThunarSizeCache
+{
+  GObject __parent__;
+
+  ThunarFileMonitor  *file_monitor;
+
+  /* the entries by key and by path */
+  GHashTable         *entries;
+  GHashTable         *paths;
+
+  guint               save_timer_id;
+
+  /* directories waiting to be counted, one at a time */
+  GQueue             *requests;
+  GHashTable         *requested;
+  ThunarDeepCountJob *job;
+  ThunarFile         *job_file;
+};
+
+/* the size of a directory, identified by its device, inode and
+ * modification time, so renamed directories keep their size and
+ * changed ones are counted again */
+struct _ThunarSizeCacheEntry
+{
+  guint64  device;
+  guint64  inode;
+  guint64  mtime;
+
+  gchar   *path;
+
+  /* the real time the entry was added */
+  gint64   counted;
+
+  guint64  total_size;
+  guint64  allocated_size;
+  guint    file_count;
+  guint    directory_count;
+  guint    unreadable_directory_count;
+};
+
+
+
+static guint size_cache_signals[LAST_SIGNAL];
+
+
+
+G_DEFINE_TYPE (ThunarSizeCache, thunar_size_cache, G_TYPE_OBJECT)
+
+
+
+static void
+thunar_size_cache_class_init (ThunarSizeCacheClass *klass)
+{
+  GObjectClass *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->finalize = thunar_size_cache_finalize;
+
+  /**
+   * ThunarSizeCache::size-changed:
+   * @cache : a #ThunarSizeCache.
+   * @file  : the directory whose size is known now.
+   *
+   * Emitted when the size of @file was added to the @cache, or
+   * when it was dropped again because something in @file changed.
+   **/
+  size_cache_signals[SIZE_CHANGED] =
+    g_signal_new (I_("size-changed"),
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST, 0,
+                  NULL, NULL,
+                  g_cclosure_marshal_VOID__OBJECT,
+                  G_TYPE_NONE, 1, THUNAR_TYPE_FILE);
+}
+
+
+
+static guint
+thunar_size_cache_entry_hash (gconstpointer data)
+{
+  const ThunarSizeCacheEntry *entry = data;
+
+  return (guint) (entry->inode ^ (entry->inode >> 32) ^ entry->device ^ entry->mtime);
+}
+
+
+
+static gboolean
+thunar_size_cache_entry_equal (gconstpointer a,
+                               gconstpointer b)
+{
+  const ThunarSizeCacheEntry *entry_a = a;
+  const ThunarSizeCacheEntry *entry_b = b;
+
+  return entry_a->inode == entry_b->inode
+      && entry_a->device == entry_b->device
+      && entry_a->mtime == entry_b->mtime;
+}
+
+
+
+static void
+thunar_size_cache_entry_free (gpointer data)
+{
+  ThunarSizeCacheEntry *entry = data;
+
+  g_free (entry->path);
+  g_slice_free (ThunarSizeCacheEntry, entry);
+}
+
+
+
+static void
+thunar_size_cache_init (ThunarSizeCache *cache)
+{
+  cache->entries = g_hash_table_new_full (thunar_size_cache_entry_hash,
+                                          thunar_size_cache_entry_equal,
+                                          thunar_size_cache_entry_free, NULL);
+  cache->paths = g_hash_table_new (g_str_hash, g_str_equal);
+  cache->requests = g_queue_new ();
+  cache->requested = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  thunar_size_cache_load (cache);
+
+  /* forget the sizes of directories that change */
+  cache->file_monitor = thunar_file_monitor_get_default ();
+  g_signal_connect (G_OBJECT (cache->file_monitor), "file-changed",
+                    G_CALLBACK (thunar_size_cache_file_changed), cache);
+  g_signal_connect (G_OBJECT (cache->file_monitor), "file-destroyed",
+                    G_CALLBACK (thunar_size_cache_file_destroyed), cache);
+}
+
+
+
+static void
+thunar_size_cache_finalize (GObject *object)
+{
+  ThunarSizeCache *cache = THUNAR_SIZE_CACHE (object);
+
+  /* disconnect from the file monitor */
+  g_signal_handlers_disconnect_matched (cache->file_monitor, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, cache);
+  g_object_unref (cache->file_monitor);
+
+  /* stop counting */
+  if (cache->job != NULL)
+    {
+      g_signal_handlers_disconnect_matched (cache->job, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, cache);
+      exo_job_cancel (EXO_JOB (cache->job));
+      g_object_unref (cache->job);
+      g_object_unref (cache->job_file);
+    }
+
+  g_queue_foreach (cache->requests, (GFunc) g_object_unref, NULL);
+  g_queue_free (cache->requests);
+  g_hash_table_destroy (cache->requested);
+
+  /* write pending changes */
+  if (cache->save_timer_id != 0)
+    {
+      g_source_remove (cache->save_timer_id);
+      thunar_size_cache_save (cache);
+    }
+
+  g_hash_table_destroy (cache->paths);
+  g_hash_table_destroy (cache->entries);
+
+  (*G_OBJECT_CLASS (thunar_size_cache_parent_class)->finalize) (object);
+}
+
+
+
+static gboolean
+thunar_size_cache_get_key (const ThunarFile     *file,
+                           ThunarSizeCacheEntry *key)
+{
+  GFileInfo *info;
+
+  /* only local directories are cached, remote ones are too slow to
+   * count and usually have no inode, see THUNAR_FILE_INFO_NAMESPACE */
+  info = thunar_file_get_info (file);
+  if (info == NULL
+      || !thunar_file_is_directory (file)
+      || !thunar_file_is_local (file)
+      || !g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_UNIX_INODE))
+    return FALSE;
+
+  key->device = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_DEVICE);
+  key->inode = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_UNIX_INODE);
+  key->mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC
+             + g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+
+  return TRUE;
+}
+
+
+
+static gboolean
+thunar_size_cache_save_timeout (gpointer user_data)
+{
+  ThunarSizeCache *cache = THUNAR_SIZE_CACHE (user_data);
+
+  cache->save_timer_id = 0;
+  thunar_size_cache_save (cache);
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_size_cache_schedule_save (ThunarSizeCache *cache)
+{
+  if (cache->save_timer_id == 0)
+    {
+      cache->save_timer_id = g_timeout_add_seconds (THUNAR_SIZE_CACHE_SAVE_DELAY,
+                                                    thunar_size_cache_save_timeout,
+                                                    cache);
+    }
+}
+
+
+
+static void
+thunar_size_cache_add_entry (ThunarSizeCache      *cache,
+                             ThunarSizeCacheEntry *entry)
+{
+  ThunarSizeCacheEntry *old_entry;
+
+  /* a path or key is only known once */
+  old_entry = g_hash_table_lookup (cache->paths, entry->path);
+  if (old_entry != NULL)
+    {
+      g_hash_table_remove (cache->paths, old_entry->path);
+      g_hash_table_remove (cache->entries, old_entry);
+    }
+
+  old_entry = g_hash_table_lookup (cache->entries, entry);
+  if (old_entry != NULL)
+    {
+      g_hash_table_remove (cache->paths, old_entry->path);
+      g_hash_table_remove (cache->entries, old_entry);
+    }
+
+  g_hash_table_insert (cache->entries, entry, entry);
+  g_hash_table_insert (cache->paths, entry->path, entry);
+}
+
+
+
+static void
+thunar_size_cache_invalidate (ThunarSizeCache *cache,
+                              ThunarFile      *file,
+                              gboolean         destroyed)
+{
+  ThunarSizeCacheEntry *entry;
+  ThunarFile           *changed_file;
+  GSList               *changed_files = NULL;
+  GSList               *lp;
+  GFile                *gfile;
+  guint64               mtime;
+  gchar                *path;
+  gchar                *parent;
+  gboolean              removed = FALSE;
+
+  if (g_hash_table_size (cache->paths) == 0)
+    return;
+
+  path = g_file_get_path (thunar_file_get_file (file));
+  if (path == NULL)
+    return;
+
+  mtime = thunar_file_get_date (file, THUNAR_FILE_DATE_MODIFIED) * G_USEC_PER_SEC;
+
+  /* walk up to the root, every directory containing the file
+   * may have a different size now */
+  for (;;)
+    {
+      entry = g_hash_table_lookup (cache->paths, path);
+
+      /* files reload for many reasons, only newer changes matter */
+      if (entry != NULL && (destroyed || mtime >= (guint64) entry->counted))
+        {
+          /* tell the views and dialogs showing the directory */
+          gfile = g_file_new_for_path (entry->path);
+          changed_file = thunar_file_cache_lookup (gfile);
+          if (changed_file != NULL)
+            changed_files = g_slist_prepend (changed_files, changed_file);
+          g_object_unref (gfile);
+
+          g_hash_table_remove (cache->paths, entry->path);
+          g_hash_table_remove (cache->entries, entry);
+          removed = TRUE;
+        }
+
+      parent = g_path_get_dirname (path);
+      if (strcmp (parent, path) == 0)
+        {
+          g_free (parent);
+          break;
+        }
+
+      g_free (path);
+      path = parent;
+    }
+
+  g_free (path);
+
+  if (removed)
+    thunar_size_cache_schedule_save (cache);
+
+  for (lp = changed_files; lp != NULL; lp = lp->next)
+    {
+      g_signal_emit (G_OBJECT (cache), size_cache_signals[SIZE_CHANGED], 0, lp->data);
+      g_object_unref (lp->data);
+    }
+  g_slist_free (changed_files);
+}
+
+
+
+static void
+thunar_size_cache_file_changed (ThunarFileMonitor *file_monitor,
+                                ThunarFile        *file,
+                                ThunarSizeCache   *cache)
+{
+  _thunar_return_if_fail (THUNAR_IS_SIZE_CACHE (cache));
+  _thunar_return_if_fail (THUNAR_IS_FILE (file));
+
+  thunar_size_cache_invalidate (cache, file, FALSE);
+}
+
+
+
+static void
+thunar_size_cache_file_destroyed (ThunarFileMonitor *file_monitor,
+                                  ThunarFile        *file,
+                                  ThunarSizeCache   *cache)
+{
+  _thunar_return_if_fail (THUNAR_IS_SIZE_CACHE (cache));
+  _thunar_return_if_fail (THUNAR_IS_FILE (file));
+
+  thunar_size_cache_invalidate (cache, file, TRUE);
+}
+
+
+
+static void
+thunar_size_cache_load (ThunarSizeCache *cache)
+{
+  ThunarSizeCacheEntry *entry;
+  gchar               **lines;
+  gchar                *contents;
+  gchar                *path;
+  gchar                *end;
+  guint                 n;
+
+  path = xfce_resource_lookup (XFCE_RESOURCE_CACHE, THUNAR_SIZE_CACHE_FILE);
+  if (path == NULL)
+    return;
+
+  if (g_file_get_contents (path, &contents, NULL, NULL))
+    {
+      /* "device inode mtime counted size allocated files dirs unreadable path" per line */
+      lines = g_strsplit (contents, "\n", -1);
+      for (n = 0; lines[n] != NULL; ++n)
+        {
+          entry = g_slice_new0 (ThunarSizeCacheEntry);
+          entry->device = g_ascii_strtoull (lines[n], &end, 10);
+          entry->inode = g_ascii_strtoull (end, &end, 10);
+          entry->mtime = g_ascii_strtoull (end, &end, 10);
+          entry->counted = g_ascii_strtoll (end, &end, 10);
+          entry->total_size = g_ascii_strtoull (end, &end, 10);
+          entry->allocated_size = g_ascii_strtoull (end, &end, 10);
+          entry->file_count = g_ascii_strtoull (end, &end, 10);
+          entry->directory_count = g_ascii_strtoull (end, &end, 10);
+          entry->unreadable_directory_count = g_ascii_strtoull (end, &end, 10);
+
+          /* skip lines that were cut off */
+          if (G_UNLIKELY (*end != ' ' || end[1] != '/'))
+            {
+              g_slice_free (ThunarSizeCacheEntry, entry);
+              continue;
+            }
+
+          entry->path = g_strdup (end + 1);
+          thunar_size_cache_add_entry (cache, entry);
+        }
+
+      g_strfreev (lines);
+      g_free (contents);
+    }
+
+  g_free (path);
+}
+
+
+
+static gint
+thunar_size_cache_compare_counted (gconstpointer a,
+                                   gconstpointer b)
+{
+  const ThunarSizeCacheEntry *entry_a = a;
+  const ThunarSizeCacheEntry *entry_b = b;
+
+  /* most recent counts first */
+  if (entry_a->counted != entry_b->counted)
+    return (entry_a->counted > entry_b->counted) ? -1 : 1;
+
+  return 0;
+}
+
+
+
+static void
+thunar_size_cache_save (ThunarSizeCache *cache)
+{
+  ThunarSizeCacheEntry *entry;
+  GString              *contents;
+  GError               *error = NULL;
+  GList                *entries;
+  GList                *lp;
+  gchar                *path;
+  guint                 n;
+
+  path = xfce_resource_save_location (XFCE_RESOURCE_CACHE, THUNAR_SIZE_CACHE_FILE, TRUE);
+  if (G_UNLIKELY (path == NULL))
+    return;
+
+  entries = g_list_sort (g_hash_table_get_keys (cache->entries), thunar_size_cache_compare_counted);
+
+  contents = g_string_new (NULL);
+  for (lp = entries, n = 0; lp != NULL && n < THUNAR_SIZE_CACHE_MAX_SAVED; lp = lp->next, ++n)
+    {
+      entry = lp->data;
+      g_string_append_printf (contents,
+                              "%" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT
+                              " %" G_GINT64_FORMAT " %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT
+                              " %u %u %u %s\n",
+                              entry->device, entry->inode, entry->mtime, entry->counted,
+                              entry->total_size, entry->allocated_size, entry->file_count,
+                              entry->directory_count,
+                              entry->unreadable_directory_count, entry->path);
+    }
+
+  if (!g_file_set_contents (path, contents->str, contents->len, &error))
+    {
+      g_warning ("Failed to write the directory sizes to \"%s\": %s", path, error->message);
+      g_error_free (error);
+    }
+
+  g_string_free (contents, TRUE);
+  g_list_free (entries);
+  g_free (path);
+}
+
+
+
+static void
+thunar_size_cache_start_next (ThunarSizeCache *cache);
+
+
+
+static void
+thunar_size_cache_job_finished (ExoJob          *job,
+                                ThunarSizeCache *cache)
+{
+  guint64 total_size;
+  guint64 allocated_size;
+  guint   file_count;
+  guint   directory_count;
+  guint   unreadable_directory_count;
+
+  _thunar_return_if_fail (THUNAR_IS_SIZE_CACHE (cache));
+  _thunar_return_if_fail (cache->job == THUNAR_DEEP_COUNT_JOB (job));
+
+  if (thunar_deep_count_job_get_result (cache->job, &total_size, &allocated_size, &file_count,
+                                        &directory_count, &unreadable_directory_count))
+    {
+      thunar_size_cache_insert (cache, cache->job_file, total_size, allocated_size,
+                                file_count, directory_count, unreadable_directory_count);
+    }
+
+  g_signal_handlers_disconnect_matched (cache->job, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, cache);
+  g_object_unref (cache->job);
+  cache->job = NULL;
+
+  g_hash_table_remove (cache->requested, cache->job_file);
+  g_object_unref (cache->job_file);
+  cache->job_file = NULL;
+
+  thunar_size_cache_start_next (cache);
+}
+
+
+
+static void
+thunar_size_cache_start_next (ThunarSizeCache *cache)
+{
+  GList files;
+
+  /* the deep count job is parallel already */
+  if (cache->job != NULL)
+    return;
+
+  cache->job_file = g_queue_pop_head (cache->requests);
+  if (cache->job_file == NULL)
+    return;
+
+  files.data = cache->job_file;
+  files.next = NULL;
+  files.prev = NULL;
+
+  cache->job = thunar_deep_count_job_new (&files, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS);
+  g_signal_connect (cache->job, "finished", G_CALLBACK (thunar_size_cache_job_finished), cache);
+  exo_job_launch (EXO_JOB (cache->job));
+}
+
+
+
+/**
+ * thunar_size_cache_get:
+ *
+ * Returns the shared #ThunarSizeCache, which remembers the total
+ * size of directories counted by #ThunarDeepCountJob<!---->s across
+ * sessions. The sizes are forgotten when something inside the
+ * directory changes, as far as the #ThunarFileMonitor reports it.
+ *
+ * The caller is responsible to free the returned object using
+ * g_object_unref() when no longer needed.
+ *
+ * Return value: the #ThunarSizeCache.
+ **/
+ThunarSizeCache *
+thunar_size_cache_get (void)
+{
+  static ThunarSizeCache *cache = NULL;
+
+  if (G_UNLIKELY (cache == NULL))
+    {
+      cache = g_object_new (THUNAR_TYPE_SIZE_CACHE, NULL);
+      g_object_add_weak_pointer (G_OBJECT (cache), (gpointer) &cache);
+    }
+  else
+    {
+      g_object_ref (G_OBJECT (cache));
+    }
+
+  return cache;
+}
+
+
+
+/**
+ * thunar_size_cache_lookup:
+ * @cache                      : a #ThunarSizeCache.
+ * @file                       : a directory.
+ * @total_size                 : return location for the total size or %NULL.
+ * @allocated_size             : return location for the space used on disk or %NULL.
+ * @file_count                 : return location for the number of files or %NULL.
+ * @directory_count            : return location for the number of directories or %NULL.
+ * @unreadable_directory_count : return location for the number of unreadable
+ *                               directories or %NULL.
+ *
+ * Looks up the counters of @file, as they were when it was last
+ * counted.
+ *
+ * Return value: %TRUE if the size of @file is known.
+ **/
+gboolean
+thunar_size_cache_lookup (ThunarSizeCache  *cache,
+                          const ThunarFile *file,
+                          guint64          *total_size,
+                          guint64          *allocated_size,
+                          guint            *file_count,
+                          guint            *directory_count,
+                          guint            *unreadable_directory_count)
+{
+  ThunarSizeCacheEntry  key;
+  ThunarSizeCacheEntry *entry;
+
+  _thunar_return_val_if_fail (THUNAR_IS_SIZE_CACHE (cache), FALSE);
+  _thunar_return_val_if_fail (THUNAR_IS_FILE (file), FALSE);
+
+  if (!thunar_size_cache_get_key (file, &key))
+    return FALSE;
+
+  entry = g_hash_table_lookup (cache->entries, &key);
+  if (entry == NULL)
+    return FALSE;
+
+  if (total_size != NULL)
+    *total_size = entry->total_size;
+  if (allocated_size != NULL)
+    *allocated_size = entry->allocated_size;
+  if (file_count != NULL)
+    *file_count = entry->file_count;
+  if (directory_count != NULL)
+    *directory_count = entry->directory_count;
+  if (unreadable_directory_count != NULL)
+    *unreadable_directory_count = entry->unreadable_directory_count;
+
+  return TRUE;
+}
+
+
+
+/**
+ * thunar_size_cache_insert:
+ * @cache                      : a #ThunarSizeCache.
+ * @file                       : a directory.
+ * @total_size                 : the total size in bytes.
+ * @allocated_size             : the space used on disk in bytes.
+ * @file_count                 : the number of files.
+ * @directory_count            : the number of directories.
+ * @unreadable_directory_count : the number of unreadable directories.
+ *
+ * Remembers the result of a deep count of @file and emits
+ * "size-changed". Nothing happens if @file is not a local directory.
+ **/
+void
+thunar_size_cache_insert (ThunarSizeCache *cache,
+                          ThunarFile      *file,
+                          guint64          total_size,
+                          guint64          allocated_size,
+                          guint            file_count,
+                          guint            directory_count,
+                          guint            unreadable_directory_count)
+{
+  ThunarSizeCacheEntry *entry;
+  ThunarSizeCacheEntry  key;
+  gchar                *path;
+
+  _thunar_return_if_fail (THUNAR_IS_SIZE_CACHE (cache));
+  _thunar_return_if_fail (THUNAR_IS_FILE (file));
+
+  if (!thunar_size_cache_get_key (file, &key))
+    return;
+
+  path = g_file_get_path (thunar_file_get_file (file));
+  if (path == NULL)
+    return;
+
+  entry = g_slice_new (ThunarSizeCacheEntry);
+  *entry = key;
+  entry->path = path;
+  entry->counted = g_get_real_time ();
+  entry->total_size = total_size;
+  entry->allocated_size = allocated_size;
+  entry->file_count = file_count;
+  entry->directory_count = directory_count;
+  entry->unreadable_directory_count = unreadable_directory_count;
+  thunar_size_cache_add_entry (cache, entry);
+
+  thunar_size_cache_schedule_save (cache);
+
+  g_signal_emit (G_OBJECT (cache), size_cache_signals[SIZE_CHANGED], 0, file);
+}
+
+
+
+/**
+ * thunar_size_cache_request:
+ * @cache : a #ThunarSizeCache.
+ * @file  : a directory.
+ *
+ * Queues a deep count of @file, unless its size is known already.
+ * "size-changed" is emitted once the count is done. Directories are
+ * counted one after another, in the order they were requested.
+ **/
+void
+thunar_size_cache_request (ThunarSizeCache *cache,
+                           ThunarFile      *file)
+{
+  ThunarSizeCacheEntry key;
+
+  _thunar_return_if_fail (THUNAR_IS_SIZE_CACHE (cache));
+  _thunar_return_if_fail (THUNAR_IS_FILE (file));
+
+  /* only directories with a known key are counted */
+  if (!thunar_size_cache_get_key (file, &key)
+      || g_hash_table_lookup (cache->entries, &key) != NULL
+      || g_hash_table_lookup (cache->requested, file) != NULL)
+    return;
+
+  g_hash_table_insert (cache->requested, file, file);
+  g_queue_push_tail (cache->requests, g_object_ref (file));
+
+  thunar_size_cache_start_next (cache);
+}
+
+
+
+/**
+ * thunar_size_cache_get_allocated_size:
+ * @cache          : a #ThunarSizeCache.
+ * @file           : a #ThunarFile.
+ * @allocated_size : return location for the space used on disk.
+ *
+ * Determines the space @file uses on disk, which is the recursive
+ * size from the last count for directories.
+ *
+ * Return value: %TRUE if the size of @file is known.
+ **/
+gboolean
+thunar_size_cache_get_allocated_size (ThunarSizeCache  *cache,
+                                      const ThunarFile *file,
+                                      guint64          *allocated_size)
+{
+  GFileInfo *info;
+
+  _thunar_return_val_if_fail (THUNAR_IS_SIZE_CACHE (cache), FALSE);
+  _thunar_return_val_if_fail (THUNAR_IS_FILE (file), FALSE);
+  _thunar_return_val_if_fail (allocated_size != NULL, FALSE);
+
+  if (thunar_file_is_directory (file))
+    return thunar_size_cache_lookup (cache, file, NULL, allocated_size, NULL, NULL, NULL);
+
+  info = thunar_file_get_info (file);
+  if (info == NULL || !g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_ALLOCATED_SIZE))
+    return FALSE;
+
+  *allocated_size = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_STANDARD_ALLOCATED_SIZE);
+
+  return TRUE;
+}
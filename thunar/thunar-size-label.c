@@ -34,6 +34,7 @@
 #include <thunar/thunar-gtk-extensions.h>
 #include <thunar/thunar-preferences.h>
 #include <thunar/thunar-private.h>
+#include <thunar/thunar-size-cache.h>
 #include <thunar/thunar-size-label.h>
 
 
@@ -60,7 +61,14 @@ static void     thunar_size_label_set_property          (GObject              *o
 static gboolean thunar_size_label_button_press_event    (GtkWidget            *ebox,
                                                          GdkEventButton       *event,
                                                          ThunarSizeLabel      *size_label);
+static void     thunar_size_label_refresh               (GtkWidget            *button,
+                                                         ThunarSizeLabel      *size_label);
+static void     thunar_size_label_size_changed          (ThunarSizeCache      *size_cache,
+                                                         ThunarFile           *file,
+                                                         ThunarSizeLabel      *size_label);
 static void     thunar_size_label_files_changed         (ThunarSizeLabel      *size_label);
+static void     thunar_size_label_update                (ThunarSizeLabel      *size_label,
+                                                         gboolean              use_cache);
 static void     thunar_size_label_error                 (ExoJob               *job,
                                                          const GError         *error,
                                                          ThunarSizeLabel      *size_label);
@@ -72,6 +80,11 @@ static void     thunar_size_label_status_update         (ThunarDeepCountJob   *j
                                                          guint                 directory_count,
                                                          guint                 unreadable_directory_count,
                                                          ThunarSizeLabel      *size_label);
+static void     thunar_size_label_set_counts            (ThunarSizeLabel      *size_label,
+                                                         guint64               total_size,
+                                                         guint                 file_count,
+                                                         guint                 directory_count,
+                                                         guint                 unreadable_directory_count);
 static GList   *thunar_size_label_get_files             (ThunarSizeLabel      *size_label);
 static void     thunar_size_label_set_files             (ThunarSizeLabel      *size_label,
                                                          GList                *files);
@@ -89,12 +102,14 @@ struct _ThunarSizeLabel
 
   ThunarDeepCountJob *job;
   ThunarPreferences  *preferences;
+  ThunarSizeCache    *size_cache;
 
   GList              *files;
   gboolean            file_size_binary;
 
   GtkWidget          *label;
   GtkWidget          *spinner;
+  GtkWidget          *refresh_button;
 };
 
 
@@ -155,6 +170,11 @@ thunar_size_label_init (ThunarSizeLabel *size_label)
   g_signal_connect_swapped (G_OBJECT (size_label->preferences), "notify::misc-file-size-binary",
                             G_CALLBACK (thunar_size_label_files_changed), size_label);
 
+  /* sizes of directories counted before */
+  size_label->size_cache = thunar_size_cache_get ();
+  g_signal_connect (G_OBJECT (size_label->size_cache), "size-changed",
+                    G_CALLBACK (thunar_size_label_size_changed), size_label);
+
   /* configure the box */
   gtk_box_set_spacing (GTK_BOX (size_label), 6);
 
@@ -178,6 +198,14 @@ thunar_size_label_init (ThunarSizeLabel *size_label)
   gtk_label_set_line_wrap (GTK_LABEL (size_label->label), TRUE);
   gtk_box_pack_start (GTK_BOX (size_label), size_label->label, TRUE, TRUE, 0);
   gtk_widget_show (size_label->label);
+
+  /* add the button to count the directory again, shown once a size is known */
+  size_label->refresh_button = gtk_button_new_from_icon_name ("view-refresh", GTK_ICON_SIZE_MENU);
+  gtk_button_set_relief (GTK_BUTTON (size_label->refresh_button), GTK_RELIEF_NONE);
+  gtk_widget_set_valign (size_label->refresh_button, GTK_ALIGN_START);
+  gtk_widget_set_tooltip_text (size_label->refresh_button, _("Click here to calculate the total size of the folder again."));
+  g_signal_connect (G_OBJECT (size_label->refresh_button), "clicked", G_CALLBACK (thunar_size_label_refresh), size_label);
+  gtk_box_pack_start (GTK_BOX (size_label), size_label->refresh_button, FALSE, FALSE, 0);
 }
 
 
@@ -202,6 +230,10 @@ thunar_size_label_finalize (GObject *object)
   g_signal_handlers_disconnect_by_func (size_label->preferences, thunar_size_label_files_changed, size_label);
   g_object_unref (size_label->preferences);
 
+  /* disconnect from the size cache */
+  g_signal_handlers_disconnect_by_func (size_label->size_cache, thunar_size_label_size_changed, size_label);
+  g_object_unref (size_label->size_cache);
+
   (*G_OBJECT_CLASS (thunar_size_label_parent_class)->finalize) (object);
 }
 
@@ -285,6 +317,7 @@ thunar_size_label_button_press_event (GtkWidget       *ebox,
 
       /* tell the user that the operation was canceled */
       gtk_label_set_text (GTK_LABEL (size_label->label), _("Calculation aborted"));
+      gtk_widget_show (size_label->refresh_button);
 
       /* we handled the event */
       return TRUE;
@@ -295,11 +328,58 @@ thunar_size_label_button_press_event (GtkWidget       *ebox,
 
 
 
+static void
+thunar_size_label_refresh (GtkWidget       *button,
+                           ThunarSizeLabel *size_label)
+{
+  _thunar_return_if_fail (THUNAR_IS_SIZE_LABEL (size_label));
+
+  /* count again, even if the size is known */
+  if (size_label->files != NULL)
+    thunar_size_label_update (size_label, FALSE);
+}
+
+
+
+static void
+thunar_size_label_size_changed (ThunarSizeCache *size_cache,
+                                ThunarFile      *file,
+                                ThunarSizeLabel *size_label)
+{
+  _thunar_return_if_fail (THUNAR_IS_SIZE_CACHE (size_cache));
+  _thunar_return_if_fail (THUNAR_IS_FILE (file));
+  _thunar_return_if_fail (THUNAR_IS_SIZE_LABEL (size_label));
+
+  /* pick up a size counted elsewhere, or count again if the
+   * cached size was dropped because the directory changed */
+  if (size_label->job == NULL
+      && size_label->files != NULL
+      && size_label->files->next == NULL
+      && size_label->files->data == file)
+    thunar_size_label_update (size_label, TRUE);
+}
+
+
+
 static void
 thunar_size_label_files_changed (ThunarSizeLabel *size_label)
+{
+  _thunar_return_if_fail (THUNAR_IS_SIZE_LABEL (size_label));
+
+  thunar_size_label_update (size_label, TRUE);
+}
+
+
+
+static void
+thunar_size_label_update (ThunarSizeLabel *size_label,
+                          gboolean         use_cache)
 {
   gchar             *size_string;
   guint64            size;
+  guint              file_count;
+  guint              directory_count;
+  guint              unreadable_directory_count;
 
   _thunar_return_if_fail (THUNAR_IS_SIZE_LABEL (size_label));
   _thunar_return_if_fail (size_label->files != NULL);
@@ -314,9 +394,24 @@ thunar_size_label_files_changed (ThunarSizeLabel *size_label)
       size_label->job = NULL;
     }
 
-  /* check if there are multiple files or the single file is a directory */
-  if (size_label->files->next != NULL
-      || thunar_file_is_directory (THUNAR_FILE (size_label->files->data)))
+  gtk_widget_hide (size_label->refresh_button);
+
+  /* the size of a single directory may be known from an earlier count, the
+   * cache drops it when the file monitor notices a change in the directory */
+  if (use_cache
+      && size_label->files->next == NULL
+      && thunar_file_is_directory (THUNAR_FILE (size_label->files->data))
+      && thunar_size_cache_lookup (size_label->size_cache, THUNAR_FILE (size_label->files->data), &size, NULL,
+                                   &file_count, &directory_count, &unreadable_directory_count))
+    {
+      gtk_spinner_stop (GTK_SPINNER (size_label->spinner));
+      gtk_widget_hide (size_label->spinner);
+
+      thunar_size_label_set_counts (size_label, size, file_count, directory_count, unreadable_directory_count);
+      gtk_widget_show (size_label->refresh_button);
+    }
+  else if (size_label->files->next != NULL
+           || thunar_file_is_directory (THUNAR_FILE (size_label->files->data)))
     {
       /* schedule a new job to determine the total size of the directory (not following symlinks) */
       size_label->job = thunar_deep_count_job_new (size_label->files, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS);
@@ -369,13 +464,32 @@ static void
 thunar_size_label_finished (ExoJob          *job,
                             ThunarSizeLabel *size_label)
 {
+  guint64          total_size;
+  guint64          allocated_size;
+  guint            file_count;
+  guint            directory_count;
+  guint            unreadable_directory_count;
+
   _thunar_return_if_fail (THUNAR_IS_JOB (job));
   _thunar_return_if_fail (THUNAR_IS_SIZE_LABEL (size_label));
   _thunar_return_if_fail (size_label->job == THUNAR_DEEP_COUNT_JOB (job));
 
+  if (thunar_deep_count_job_get_result (THUNAR_DEEP_COUNT_JOB (job), &total_size, &allocated_size,
+                                        &file_count, &directory_count, &unreadable_directory_count))
+    {
+      /* remember the size of a single directory for the next time */
+      if (size_label->files->next == NULL
+          && thunar_file_is_directory (THUNAR_FILE (size_label->files->data)))
+        {
+          thunar_size_cache_insert (size_label->size_cache, THUNAR_FILE (size_label->files->data), total_size,
+                                    allocated_size, file_count, directory_count, unreadable_directory_count);
+        }
+    }
+
   /* stop and hide the spinner */
   gtk_spinner_stop (GTK_SPINNER (size_label->spinner));
   gtk_widget_hide (size_label->spinner);
+  gtk_widget_show (size_label->refresh_button);
 
   /* disconnect from the job */
   g_signal_handlers_disconnect_matched (size_label->job, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, size_label);
@@ -392,15 +506,29 @@ thunar_size_label_status_update (ThunarDeepCountJob *job,
                                  guint               directory_count,
                                  guint               unreadable_directory_count,
                                  ThunarSizeLabel    *size_label)
+{
+  _thunar_return_if_fail (THUNAR_IS_DEEP_COUNT_JOB (job));
+  _thunar_return_if_fail (THUNAR_IS_SIZE_LABEL (size_label));
+  _thunar_return_if_fail (size_label->job == job);
+
+  thunar_size_label_set_counts (size_label, total_size, file_count, directory_count, unreadable_directory_count);
+}
+
+
+
+static void
+thunar_size_label_set_counts (ThunarSizeLabel *size_label,
+                              guint64          total_size,
+                              guint            file_count,
+                              guint            directory_count,
+                              guint            unreadable_directory_count)
 {
   gchar             *size_string;
   gchar             *text;
   guint              n;
   gchar             *unreable_text;
 
-  _thunar_return_if_fail (THUNAR_IS_DEEP_COUNT_JOB (job));
   _thunar_return_if_fail (THUNAR_IS_SIZE_LABEL (size_label));
-  _thunar_return_if_fail (size_label->job == job);
 
   /* determine the total number of items */
   n = file_count + directory_count + unreadable_directory_count;
@@ -28,6 +28,9 @@
 #include <glib-object.h>
 #include <gio/gio.h>
 
+#include <exo/exo.h>
+
+#include <thunar/thunar-enum-types.h>
 #include <thunar/thunar-private.h>
 #include <thunar/thunar-thumbnail-cache.h>
 #include <thunar/thunar-file.h>
@@ -42,7 +45,30 @@
 
 
 
-static void thunar_thumbnail_cache_finalize (GObject *object);
+/* maximum number of URIs sent to the cache service in a single D-Bus call */
+#define THUNAR_THUMBNAIL_CACHE_CHUNK_SIZE (500)
+
+
+
+typedef struct _ThunarThumbnailCacheQueue ThunarThumbnailCacheQueue;
+
+
+
+/* Property identifiers */
+enum
+{
+  PROP_0,
+  PROP_QUEUE_DEPTH,
+};
+
+
+
+static void     thunar_thumbnail_cache_finalize      (GObject                   *object);
+static void     thunar_thumbnail_cache_get_property  (GObject                   *object,
+                                                      guint                      prop_id,
+                                                      GValue                    *value,
+                                                      GParamSpec                *pspec);
+static gboolean thunar_thumbnail_cache_process_queue (gpointer                   user_data);
 
 
 
@@ -53,11 +79,38 @@ enum
   THUNAR_THUMBNAIL_CACHE_PROXY_FAILED
 };
 
+enum
+{
+  THUNAR_THUMBNAIL_CACHE_QUEUE_MOVE,
+  THUNAR_THUMBNAIL_CACHE_QUEUE_COPY,
+  THUNAR_THUMBNAIL_CACHE_QUEUE_DELETE,
+  THUNAR_THUMBNAIL_CACHE_QUEUE_CLEANUP,
+  THUNAR_THUMBNAIL_CACHE_N_QUEUES
+};
+
 struct _ThunarThumbnailCacheClass
 {
   GObjectClass __parent__;
 };
 
+struct _ThunarThumbnailCacheQueue
+{
+  ThunarThumbnailCache *cache;
+  guint                 type;
+
+  /* queued files in order; target_files is NULL for delete/cleanup */
+  GPtrArray            *source_files;
+  GPtrArray            *target_files;
+
+  /* maps the (target) file to its position + 1 in the arrays, so
+   * duplicate requests are dropped in constant time */
+  GHashTable           *index;
+
+  guint                 interval;
+  guint                 idle_id;
+  guint                 flush_scheduled : 1;
+};
+
 struct _ThunarThumbnailCache
 {
   GObject     __parent__;
@@ -65,19 +118,7 @@ struct _ThunarThumbnailCache
   ThunarThumbnailCacheDBus *cache_proxy;
   int                       proxy_state;
 
-  GList      *move_source_queue;
-  GList      *move_target_queue;
-  guint       move_queue_idle_id;
-
-  GList      *copy_source_queue;
-  GList      *copy_target_queue;
-  guint       copy_queue_idle_id;
-
-  GList      *delete_queue;
-  guint       delete_queue_idle_id;
-
-  GList      *cleanup_queue;
-  guint       cleanup_queue_idle_id;
+  ThunarThumbnailCacheQueue queues[THUNAR_THUMBNAIL_CACHE_N_QUEUES];
 
 #if GLIB_CHECK_VERSION (2, 32, 0)
   GMutex      lock;
@@ -102,6 +143,22 @@ thunar_thumbnail_cache_class_init (ThunarThumbnailCacheClass *klass)
 
   gobject_class = G_OBJECT_CLASS (klass);
   gobject_class->finalize = thunar_thumbnail_cache_finalize;
+  gobject_class->get_property = thunar_thumbnail_cache_get_property;
+
+  /**
+   * ThunarThumbnailCache:queue-depth:
+   *
+   * The number of requests of all kinds waiting to be sent to the
+   * thumbnail cache service, see thunar_thumbnail_cache_get_queue_depth().
+   * Meant for debugging, no change notifications are emitted.
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_QUEUE_DEPTH,
+                                   g_param_spec_uint ("queue-depth",
+                                                      "queue-depth",
+                                                      "queue-depth",
+                                                      0, G_MAXUINT, 0,
+                                                      EXO_PARAM_READABLE));
 }
 
 
@@ -109,32 +166,26 @@ thunar_thumbnail_cache_class_init (ThunarThumbnailCacheClass *klass)
 static void
 thunar_thumbnail_cache_finalize (GObject *object)
 {
-  ThunarThumbnailCache *cache = THUNAR_THUMBNAIL_CACHE (object);
+  ThunarThumbnailCache      *cache = THUNAR_THUMBNAIL_CACHE (object);
+  ThunarThumbnailCacheQueue *queue;
+  guint                      n;
 
   /* acquire a cache lock */
   _thumbnail_cache_lock (cache);
 
-  /* drop the move queue idle and all queued files */
-  if (cache->move_queue_idle_id > 0)
-    g_source_remove (cache->move_queue_idle_id);
-  g_list_free_full (cache->move_source_queue, g_object_unref);
-  g_list_free_full (cache->move_target_queue, g_object_unref);
-
-  /* drop the copy queue idle and all queued files */
-  if (cache->copy_queue_idle_id > 0)
-    g_source_remove (cache->copy_queue_idle_id);
-  g_list_free_full (cache->copy_source_queue, g_object_unref);
-  g_list_free_full (cache->copy_target_queue, g_object_unref);
+  /* drop the queue timeouts and all queued files */
+  for (n = 0; n < THUNAR_THUMBNAIL_CACHE_N_QUEUES; ++n)
+    {
+      queue = &cache->queues[n];
 
-  /* drop the delete queue idle and all queued files */
-  if (cache->delete_queue_idle_id > 0)
-    g_source_remove (cache->delete_queue_idle_id);
-  g_list_free_full (cache->delete_queue, g_object_unref);
+      if (queue->idle_id > 0)
+        g_source_remove (queue->idle_id);
 
-  /* drop the cleanup queue idle and all queued files */
-  if (cache->cleanup_queue_idle_id > 0)
-    g_source_remove (cache->cleanup_queue_idle_id);
-  g_list_free_full (cache->cleanup_queue, g_object_unref);
+      g_ptr_array_unref (queue->source_files);
+      if (queue->target_files != NULL)
+        g_ptr_array_unref (queue->target_files);
+      g_hash_table_destroy (queue->index);
+    }
 
   /* check if we have a valid cache proxy */
   if (cache->cache_proxy != NULL)
@@ -156,25 +207,65 @@ thunar_thumbnail_cache_finalize (GObject *object)
 
 
 static void
-thunar_thumbnail_cache_copy_async_reply (ThunarThumbnailCacheDBus *proxy,
-                                         GAsyncResult             *res,
-                                         gpointer                  user_data)
+thunar_thumbnail_cache_get_property (GObject    *object,
+                                     guint       prop_id,
+                                     GValue     *value,
+                                     GParamSpec *pspec)
 {
-  GList      *li;
-  ThunarFile *file;
-  GError     *error = NULL;
-
-  _thunar_return_if_fail (THUNAR_IS_THUMBNAIL_CACHE_DBUS (proxy));
+  ThunarThumbnailCache *cache = THUNAR_THUMBNAIL_CACHE (object);
+  guint                 n_move;
+  guint                 n_copy;
+  guint                 n_delete;
+  guint                 n_cleanup;
 
-  if (!thunar_thumbnail_cache_dbus_call_copy_finish (proxy, res, &error))
+  switch (prop_id)
     {
-      g_printerr ("ThunarThumbnailCache: failed to call Copy(): %s\n", error->message);
+    case PROP_QUEUE_DEPTH:
+      thunar_thumbnail_cache_get_queue_depth (cache, &n_move, &n_copy, &n_delete, &n_cleanup);
+      g_value_set_uint (value, n_move + n_copy + n_delete + n_cleanup);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
     }
-  g_clear_error (&error);
+}
+
+
+
+static void
+thunar_thumbnail_cache_queue_init (ThunarThumbnailCache      *cache,
+                                   ThunarThumbnailCacheQueue *queue,
+                                   guint                      type,
+                                   guint                      interval)
+{
+  queue->cache = cache;
+  queue->type = type;
+  queue->interval = interval;
+  queue->idle_id = 0;
+  queue->flush_scheduled = FALSE;
+
+  queue->source_files = g_ptr_array_new_with_free_func (g_object_unref);
+  if (type == THUNAR_THUMBNAIL_CACHE_QUEUE_MOVE || type == THUNAR_THUMBNAIL_CACHE_QUEUE_COPY)
+    queue->target_files = g_ptr_array_new_with_free_func (g_object_unref);
+  else
+    queue->target_files = NULL;
+
+  /* the keys are owned by the arrays */
+  queue->index = g_hash_table_new (g_file_hash, (GEqualFunc) g_file_equal);
+}
+
+
+
+static void
+thunar_thumbnail_cache_refresh_files (GPtrArray *files)
+{
+  ThunarFile *file;
+  guint       n;
 
-  for (li = user_data; li != NULL; li = li->next)
+  for (n = 0; n < files->len; ++n)
     {
-      file = thunar_file_cache_lookup (G_FILE (li->data));
+      file = thunar_file_cache_lookup (g_ptr_array_index (files, n));
 
       if (G_LIKELY (file != NULL))
         {
@@ -183,197 +274,193 @@ thunar_thumbnail_cache_copy_async_reply (ThunarThumbnailCacheDBus *proxy,
           g_object_unref (file);
         }
     }
-
-  g_list_free_full (user_data, g_object_unref);
 }
 
 
 
 static void
-thunar_thumbnail_cache_move_async_reply (ThunarThumbnailCacheDBus *proxy,
+thunar_thumbnail_cache_copy_async_reply (ThunarThumbnailCacheDBus *proxy,
                                          GAsyncResult             *res,
                                          gpointer                  user_data)
 {
-  GList      *li;
-  ThunarFile *file;
-  GError     *error = NULL;
+  GError *error = NULL;
 
   _thunar_return_if_fail (THUNAR_IS_THUMBNAIL_CACHE_DBUS (proxy));
 
-  if (!thunar_thumbnail_cache_dbus_call_move_finish (proxy, res, &error))
+  if (!thunar_thumbnail_cache_dbus_call_copy_finish (proxy, res, &error))
     {
-      g_printerr ("ThunarThumbnailCache: failed to call Move(): %s\n", error->message);
+      g_printerr ("ThunarThumbnailCache: failed to call Copy(): %s\n", error->message);
     }
   g_clear_error (&error);
 
-  for (li = user_data; li != NULL; li = li->next)
-    {
-      file = thunar_file_cache_lookup (G_FILE (li->data));
-
-      if (G_LIKELY (file != NULL))
-        {
-          /* if visible, let the view know there might be a thumb */
-          thunar_file_changed (file);
-          g_object_unref (file);
-        }
-    }
-
-  g_list_free_full (user_data, g_object_unref);
+  thunar_thumbnail_cache_refresh_files (user_data);
+  g_ptr_array_unref (user_data);
 }
 
 
 
 static void
-thunar_thumbnail_cache_move_async (ThunarThumbnailCache *cache,
-                                   const gchar         **source_uris,
-                                   const gchar         **target_uris,
-                                   gpointer              user_data)
+thunar_thumbnail_cache_move_async_reply (ThunarThumbnailCacheDBus *proxy,
+                                         GAsyncResult             *res,
+                                         gpointer                  user_data)
 {
-  _thunar_return_if_fail (THUNAR_IS_THUMBNAIL_CACHE (cache));
-  _thunar_return_if_fail (source_uris != NULL);
-  _thunar_return_if_fail (target_uris != NULL);
-
-  /* request a thumbnail cache update asynchronously */
-  thunar_thumbnail_cache_dbus_call_move (cache->cache_proxy,
-                                         source_uris, target_uris,
-                                         NULL,
-                                         (GAsyncReadyCallback)thunar_thumbnail_cache_move_async_reply,
-                                         user_data);
-}
+  GError *error = NULL;
 
+  _thunar_return_if_fail (THUNAR_IS_THUMBNAIL_CACHE_DBUS (proxy));
 
+  if (!thunar_thumbnail_cache_dbus_call_move_finish (proxy, res, &error))
+    {
+      g_printerr ("ThunarThumbnailCache: failed to call Move(): %s\n", error->message);
+    }
+  g_clear_error (&error);
 
-static void
-thunar_thumbnail_cache_copy_async (ThunarThumbnailCache *cache,
-                                   const gchar         **source_uris,
-                                   const gchar         **target_uris,
-                                   gpointer              user_data)
-{
-  _thunar_return_if_fail (THUNAR_IS_THUMBNAIL_CACHE (cache));
-  _thunar_return_if_fail (source_uris != NULL);
-  _thunar_return_if_fail (target_uris != NULL);
-
-  /* request a thumbnail cache update asynchronously */
-  thunar_thumbnail_cache_dbus_call_copy (cache->cache_proxy,
-                                         source_uris, target_uris,
-                                         NULL,
-                                         (GAsyncReadyCallback)thunar_thumbnail_cache_copy_async_reply,
-                                         user_data);
+  thunar_thumbnail_cache_refresh_files (user_data);
+  g_ptr_array_unref (user_data);
 }
 
 
 
-static void
-thunar_thumbnail_cache_delete_async (ThunarThumbnailCache *cache,
-                                     const gchar         **uris)
+static gchar **
+thunar_thumbnail_cache_dup_uris (GPtrArray *files,
+                                 guint      offset,
+                                 guint      n_uris)
 {
-  _thunar_return_if_fail (THUNAR_IS_THUMBNAIL_CACHE (cache));
-  _thunar_return_if_fail (uris != NULL);
+  gchar **uris;
+  guint   n;
 
-  /* request a thumbnail cache update asynchronously */
-  thunar_thumbnail_cache_dbus_call_delete (cache->cache_proxy, uris,
-                                           NULL, NULL, NULL);
+  /* allocate a NULL-terminated string array for the URIs */
+  uris = g_new (gchar *, n_uris + 1);
+  for (n = 0; n < n_uris; ++n)
+    uris[n] = g_file_get_uri (g_ptr_array_index (files, offset + n));
+  uris[n] = NULL;
+
+  return uris;
 }
 
 
 
 static void
-thunar_thumbnail_cache_cleanup_async (ThunarThumbnailCache *cache,
-                                      const gchar *const    *base_uris)
+thunar_thumbnail_cache_send_chunk (ThunarThumbnailCache *cache,
+                                   guint                 type,
+                                   GPtrArray            *source_files,
+                                   GPtrArray            *target_files,
+                                   guint                 offset,
+                                   guint                 n_uris)
 {
-  _thunar_return_if_fail (THUNAR_IS_THUMBNAIL_CACHE (cache));
-  _thunar_return_if_fail (base_uris != NULL);
+  GPtrArray *reply_files;
+  gchar    **source_uris;
+  gchar    **target_uris = NULL;
+  guint      n;
+
+  source_uris = thunar_thumbnail_cache_dup_uris (source_files, offset, n_uris);
+  if (target_files != NULL)
+    target_uris = thunar_thumbnail_cache_dup_uris (target_files, offset, n_uris);
+
+  switch (type)
+    {
+    case THUNAR_THUMBNAIL_CACHE_QUEUE_MOVE:
+    case THUNAR_THUMBNAIL_CACHE_QUEUE_COPY:
+      /* the targets of this chunk are refreshed once the service replied */
+      reply_files = g_ptr_array_new_full (n_uris, g_object_unref);
+      for (n = 0; n < n_uris; ++n)
+        g_ptr_array_add (reply_files, g_object_ref (g_ptr_array_index (target_files, offset + n)));
+
+      /* request a thumbnail cache update asynchronously */
+      if (type == THUNAR_THUMBNAIL_CACHE_QUEUE_MOVE)
+        {
+          thunar_thumbnail_cache_dbus_call_move (cache->cache_proxy,
+                                                 (const gchar **) source_uris,
+                                                 (const gchar **) target_uris,
+                                                 NULL,
+                                                 (GAsyncReadyCallback) thunar_thumbnail_cache_move_async_reply,
+                                                 reply_files);
+        }
+      else
+        {
+          thunar_thumbnail_cache_dbus_call_copy (cache->cache_proxy,
+                                                 (const gchar **) source_uris,
+                                                 (const gchar **) target_uris,
+                                                 NULL,
+                                                 (GAsyncReadyCallback) thunar_thumbnail_cache_copy_async_reply,
+                                                 reply_files);
+        }
+      break;
 
-  /* request a thumbnail cache update asynchronously */
-  thunar_thumbnail_cache_dbus_call_cleanup (cache->cache_proxy,
-                                            (const gchar **)base_uris, 0,
-                                            NULL, NULL, NULL);
+    case THUNAR_THUMBNAIL_CACHE_QUEUE_DELETE:
+      /* request a thumbnail cache update asynchronously */
+      thunar_thumbnail_cache_dbus_call_delete (cache->cache_proxy,
+                                               (const gchar **) source_uris,
+                                               NULL, NULL, NULL);
+      break;
+
+    case THUNAR_THUMBNAIL_CACHE_QUEUE_CLEANUP:
+#ifndef NDEBUG
+      g_debug ("cleanup:");
+      for (n = 0; source_uris[n] != NULL; ++n)
+        g_debug ("  %s", source_uris[n]);
+#endif
+
+      /* request a thumbnail cache update asynchronously */
+      thunar_thumbnail_cache_dbus_call_cleanup (cache->cache_proxy,
+                                                (const gchar **) source_uris, 0,
+                                                NULL, NULL, NULL);
+      break;
+
+    default:
+      _thunar_assert_not_reached ();
+    }
+
+  /* free the URI arrays */
+  g_strfreev (source_uris);
+  g_strfreev (target_uris);
 }
 
 
 
 static gboolean
-thunar_thumbnail_cache_process_queue (ThunarThumbnailCache *cache,
-                                      gboolean              copy_async)
+thunar_thumbnail_cache_process_queue (gpointer user_data)
 {
-  GList  *sp;
-  GList  *tp;
-  gchar **source_uris;
-  gchar **target_uris;
-  guint   n_uris;
-  guint   n;
-  GList  *source_queue;
-  GList  *target_queue;
+  ThunarThumbnailCacheQueue *queue = user_data;
+  ThunarThumbnailCache      *cache = queue->cache;
+  GPtrArray                 *source_files;
+  GPtrArray                 *target_files = NULL;
+  guint                      offset;
 
   _thunar_return_val_if_fail (THUNAR_IS_THUMBNAIL_CACHE (cache), FALSE);
 
   /* acquire a cache lock */
   _thumbnail_cache_lock (cache);
 
-  /* steal the lists */
-  if (copy_async)
-    {
-      source_queue = cache->copy_source_queue;
-      cache->copy_source_queue = NULL;
-      target_queue = cache->copy_target_queue;
-      cache->copy_target_queue = NULL;
-    }
-  else
-    {
-      source_queue = cache->move_source_queue;
-      cache->move_source_queue = NULL;
-      target_queue = cache->move_target_queue;
-      cache->move_target_queue = NULL;
-    }
-
-  /* compute how many URIs there are */
-  n_uris = g_list_length (source_queue);
+  /* this source is done after we return */
+  queue->idle_id = 0;
+  queue->flush_scheduled = FALSE;
 
-  /* allocate a string array for the URIs */
-  source_uris = g_new0 (gchar *, n_uris + 1);
-  target_uris = g_new0 (gchar *, n_uris + 1);
-
-  /* fill URI array with file URIs from the move queue */
-  for (n = 0,
-       sp = g_list_last (source_queue),
-       tp = g_list_last (target_queue);
-       sp != NULL && tp != NULL;
-       sp = sp->prev, tp = tp->prev, ++n)
+  if (G_LIKELY (queue->source_files->len > 0))
     {
-      source_uris[n] = g_file_get_uri (sp->data);
-      target_uris[n] = g_file_get_uri (tp->data);
-
-      /* release the source object */
-      g_object_unref (sp->data);
-    }
+      /* steal the queued files and reset the queue */
+      source_files = queue->source_files;
+      queue->source_files = g_ptr_array_new_with_free_func (g_object_unref);
+      if (queue->target_files != NULL)
+        {
+          target_files = queue->target_files;
+          queue->target_files = g_ptr_array_new_with_free_func (g_object_unref);
+        }
+      g_hash_table_remove_all (queue->index);
 
-  /* NULL-terminate the URI arrays */
-  source_uris[n] = NULL;
-  target_uris[n] = NULL;
+      /* send the requests in bounded chunks, so a huge operation does
+       * not end up in a single giant D-Bus message */
+      for (offset = 0; offset < source_files->len; offset += THUNAR_THUMBNAIL_CACHE_CHUNK_SIZE)
+        {
+          thunar_thumbnail_cache_send_chunk (cache, queue->type,
+                                             source_files, target_files, offset,
+                                             MIN (source_files->len - offset,
+                                                  THUNAR_THUMBNAIL_CACHE_CHUNK_SIZE));
+        }
 
-  if (copy_async)
-    {
-      /* asynchronously copy the thumbnails */
-      thunar_thumbnail_cache_copy_async (cache,
-                                         (const gchar **)source_uris,
-                                         (const gchar **)target_uris,
-                                         target_queue);
+      g_ptr_array_unref (source_files);
+      if (target_files != NULL)
+        g_ptr_array_unref (target_files);
     }
-  else
-    {
-      /* asynchronously move the thumbnails */
-      thunar_thumbnail_cache_move_async (cache,
-                                         (const gchar **)source_uris,
-                                         (const gchar **)target_uris,
-                                         target_queue);
-    }
-
-  /* free the URI arrays */
-  g_strfreev (source_uris);
-  g_strfreev (target_uris);
-
-  /* release the move queue lists */
-  g_list_free (source_queue);
 
   /* release the cache lock */
   _thumbnail_cache_unlock (cache);
@@ -383,146 +470,127 @@ thunar_thumbnail_cache_process_queue (ThunarThumbnailCache *cache,
 
 
 
-static gboolean
-thunar_thumbnail_cache_process_move_queue (gpointer user_data)
+static void
+thunar_thumbnail_cache_schedule_queue (ThunarThumbnailCache      *cache,
+                                       ThunarThumbnailCacheQueue *queue)
 {
-  return thunar_thumbnail_cache_process_queue (user_data, FALSE);
-}
+  /* the caller must hold the cache lock */
+  if (cache->proxy_state != THUNAR_THUMBNAIL_CACHE_PROXY_AVAILABLE
+      || queue->source_files->len == 0)
+    return;
 
+  /* a flush is already on its way */
+  if (queue->flush_scheduled)
+    return;
 
+  /* cancel any pending timeout to process the queue */
+  if (queue->idle_id > 0)
+    g_source_remove (queue->idle_id);
 
-static void
-thunar_thumbnail_cache_process_move_queue_destroy (gpointer user_data)
-{
-  THUNAR_THUMBNAIL_CACHE (user_data)->move_queue_idle_id = 0;
+  if (queue->source_files->len >= THUNAR_THUMBNAIL_CACHE_CHUNK_SIZE)
+    {
+      /* the queue is full, flush it as soon as possible instead of
+       * waiting for the operation to settle down */
+      queue->flush_scheduled = TRUE;
+      queue->idle_id = g_idle_add_full (G_PRIORITY_DEFAULT_IDLE,
+                                        thunar_thumbnail_cache_process_queue,
+                                        queue, NULL);
+    }
+  else
+    {
+      /* process the queue once no new files were added for a while */
+      queue->idle_id = g_timeout_add_full (G_PRIORITY_DEFAULT_IDLE, queue->interval,
+                                           thunar_thumbnail_cache_process_queue,
+                                           queue, NULL);
+    }
 }
 
 
 
-static gboolean
-thunar_thumbnail_cache_process_copy_queue (gpointer user_data)
+static void
+thunar_thumbnail_cache_queue_add (ThunarThumbnailCacheQueue *queue,
+                                  GFile                     *source_file,
+                                  GFile                     *target_file)
 {
-  return thunar_thumbnail_cache_process_queue (user_data, TRUE);
-}
+  GFile *key;
+  guint  position;
 
+  /* the caller must hold the cache lock */
+  key = target_file != NULL ? target_file : source_file;
 
+  /* drop exact duplicates of queued requests */
+  position = GPOINTER_TO_UINT (g_hash_table_lookup (queue->index, key));
+  if (position == 0
+      || (target_file != NULL
+          && !g_file_equal (g_ptr_array_index (queue->source_files, position - 1), source_file)))
+    {
+      /* add the files to the queue */
+      g_ptr_array_add (queue->source_files, g_object_ref (source_file));
+      if (target_file != NULL)
+        g_ptr_array_add (queue->target_files, g_object_ref (target_file));
 
-static void
-thunar_thumbnail_cache_process_copy_queue_destroy (gpointer user_data)
-{
-  THUNAR_THUMBNAIL_CACHE (user_data)->copy_queue_idle_id = 0;
+      /* remember the latest position of this file */
+      g_hash_table_replace (queue->index, key, GUINT_TO_POINTER (queue->source_files->len));
+    }
 }
 
 
 
-static gboolean
-thunar_thumbnail_cache_process_delete_queue (ThunarThumbnailCache *cache)
+static void
+thunar_thumbnail_cache_queue_file (ThunarThumbnailCache *cache,
+                                   guint                 type,
+                                   GFile                *source_file,
+                                   GFile                *target_file)
 {
-  GList  *lp;
-  gchar **uris;
-  guint   n_uris;
-  guint   n;
-
-  _thunar_return_val_if_fail (THUNAR_IS_THUMBNAIL_CACHE (cache), FALSE);
+  ThunarThumbnailCacheQueue *queue = &cache->queues[type];
 
   /* acquire a cache lock */
   _thumbnail_cache_lock (cache);
 
-  /* compute how many URIs there are */
-  n_uris = g_list_length (cache->delete_queue);
-
-  /* allocate a string array for the URIs */
-  uris = g_new0 (gchar *, n_uris + 1);
-
-  /* fill URI array with file URIs from the delete queue */
-  for (lp = g_list_last (cache->delete_queue), n = 0; lp != NULL; lp = lp->prev, ++n)
+  /* check if we have a valid proxy for the cache service */
+  if (cache->proxy_state != THUNAR_THUMBNAIL_CACHE_PROXY_FAILED)
     {
-      uris[n] = g_file_get_uri (lp->data);
-
-      /* release the file object */
-      g_object_unref (lp->data);
+      thunar_thumbnail_cache_queue_add (queue, source_file, target_file);
+      thunar_thumbnail_cache_schedule_queue (cache, queue);
     }
 
-  /* NULL-terminate the URI array */
-  uris[n] = NULL;
-
-  /* asynchronously delete the thumbnails */
-  thunar_thumbnail_cache_delete_async (cache, (const gchar **)uris);
-
-  /* free the URI array */
-  g_strfreev (uris);
-
-  /* release the delete queue list */
-  g_list_free (cache->delete_queue);
-  cache->delete_queue = NULL;
-
-  /* reset the delete queue idle ID */
-  cache->delete_queue_idle_id = 0;
-
   /* release the cache lock */
   _thumbnail_cache_unlock (cache);
-
-  return FALSE;
 }
 
 
 
 static gboolean
-thunar_thumbnail_cache_process_cleanup_queue (ThunarThumbnailCache *cache)
+thunar_thumbnail_cache_has_thumbnail (GFile *file)
 {
-  GList  *lp;
-  gchar **uris;
-  guint   n_uris;
-  guint   n;
-
-  _thunar_return_val_if_fail (THUNAR_IS_THUMBNAIL_CACHE (cache), FALSE);
-
-  /* acquire a cache lock */
-  _thumbnail_cache_lock (cache);
-
-  /* compute how many URIs there are */
-  n_uris = g_list_length (cache->cleanup_queue);
-
-  /* allocate a string array for the URIs */
-  uris = g_new0 (gchar *, n_uris + 1);
-
-#ifndef NDEBUG
-  g_debug ("cleanup:");
-#endif
-
-  /* fill URI array with file URIs from the cleanup queue */
-  for (lp = g_list_last (cache->cleanup_queue), n = 0; lp != NULL; lp = lp->prev, ++n)
+  GEnumClass *klass;
+  gboolean    has_thumbnail = FALSE;
+  gchar      *uri;
+  gchar      *md5_hash;
+  gchar      *filename;
+  gchar      *path;
+  guint       n;
+
+  uri = g_file_get_uri (file);
+  md5_hash = g_compute_checksum_for_string (G_CHECKSUM_MD5, uri, -1);
+  filename = g_strconcat (md5_hash, ".png", NULL);
+  g_free (md5_hash);
+  g_free (uri);
+
+  /* look in all the flavors we know about */
+  klass = g_type_class_ref (THUNAR_TYPE_THUMBNAIL_SIZE);
+  for (n = 0; !has_thumbnail && n < klass->n_values; ++n)
     {
-      uris[n] = g_file_get_uri (lp->data);
-
-#ifndef NDEBUG
-      g_debug ("  %s", uris[n]);
-#endif
-
-      /* release the file object */
-      g_object_unref (lp->data);
+      path = g_build_filename (g_get_user_cache_dir (), "thumbnails",
+                               klass->values[n].value_nick, filename, NULL);
+      has_thumbnail = g_file_test (path, G_FILE_TEST_EXISTS);
+      g_free (path);
     }
+  g_type_class_unref (klass);
 
-  /* NULL-terminate the URI array */
-  uris[n] = NULL;
-
-  /* asynchronously cleanup the thumbnails */
-  thunar_thumbnail_cache_cleanup_async (cache, (const gchar *const *)uris);
-
-  /* free the URI array */
-  g_strfreev (uris);
-
-  /* release the cleanup queue list */
-  g_list_free (cache->cleanup_queue);
-  cache->cleanup_queue = NULL;
-
-  /* reset the cleanup queue idle ID */
-  cache->cleanup_queue_idle_id = 0;
+  g_free (filename);
 
-  /* release the cache lock */
-  _thumbnail_cache_unlock (cache);
-
-  return FALSE;
+  return has_thumbnail;
 }
 
 
@@ -544,36 +612,14 @@ thunar_thumbnail_cache_move_file (ThunarThumbnailCache *cache,
   _thunar_return_if_fail (G_IS_FILE (source_file));
   _thunar_return_if_fail (G_IS_FILE (target_file));
 
-  /* acquire a cache lock */
-  _thumbnail_cache_lock (cache);
-
-  /* check if we have a valid proxy for the cache service */
-  if (cache->proxy_state != THUNAR_THUMBNAIL_CACHE_PROXY_FAILED)
-    {
-      /* add the files to the move queue */
-      cache->move_source_queue = g_list_prepend (cache->move_source_queue,
-                                                 g_object_ref (source_file));
-      cache->move_target_queue = g_list_prepend (cache->move_target_queue,
-                                                 g_object_ref (target_file));
-    }
+  /* files without a thumbnail don't need the service, but directories
+   * always do, because the service moves the thumbnails of their children */
+  if (!thunar_thumbnail_cache_has_thumbnail (source_file)
+      && g_file_query_file_type (target_file, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS, NULL) != G_FILE_TYPE_DIRECTORY)
+    return;
 
-  if (cache->proxy_state == THUNAR_THUMBNAIL_CACHE_PROXY_AVAILABLE)
-    {
-      /* cancel any pending timeout to process the move queue */
-      if (cache->move_queue_idle_id > 0)
-        {
-          g_source_remove (cache->move_queue_idle_id);
-          cache->move_queue_idle_id = 0;
-        }
-
-      /* process the move queue in a 250ms timeout */
-      cache->move_queue_idle_id =
-        g_timeout_add_full (G_PRIORITY_DEFAULT_IDLE, 250, thunar_thumbnail_cache_process_move_queue,
-                            cache, thunar_thumbnail_cache_process_move_queue_destroy);
-    }
-
-  /* release the cache lock */
-  _thumbnail_cache_unlock (cache);
+  thunar_thumbnail_cache_queue_file (cache, THUNAR_THUMBNAIL_CACHE_QUEUE_MOVE,
+                                     source_file, target_file);
 }
 
 
@@ -587,36 +633,14 @@ thunar_thumbnail_cache_copy_file (ThunarThumbnailCache *cache,
   _thunar_return_if_fail (G_IS_FILE (source_file));
   _thunar_return_if_fail (G_IS_FILE (target_file));
 
-  /* acquire a cache lock */
-  _thumbnail_cache_lock (cache);
-
-  /* check if we have a valid proxy for the cache service */
-  if (cache->proxy_state != THUNAR_THUMBNAIL_CACHE_PROXY_FAILED)
-    {
-      /* add the files to the copy queues */
-      cache->copy_source_queue = g_list_prepend (cache->copy_source_queue,
-                                                 g_object_ref (source_file));
-      cache->copy_target_queue = g_list_prepend (cache->copy_target_queue,
-                                                 g_object_ref (target_file));
-    }
-
-  if (cache->proxy_state == THUNAR_THUMBNAIL_CACHE_PROXY_AVAILABLE)
-    {
-      /* cancel any pending timeout to process the copy queue */
-      if (cache->copy_queue_idle_id > 0)
-        {
-          g_source_remove (cache->copy_queue_idle_id);
-          cache->copy_queue_idle_id = 0;
-        }
-
-      /* process the copy queue in a 250ms timeout */
-      cache->copy_queue_idle_id =
-        g_timeout_add_full (G_PRIORITY_DEFAULT_IDLE, 500, thunar_thumbnail_cache_process_copy_queue,
-                            cache, thunar_thumbnail_cache_process_copy_queue_destroy);
-    }
+  /* files without a thumbnail don't need the service, but directories
+   * always do, because the service copies the thumbnails of their children */
+  if (!thunar_thumbnail_cache_has_thumbnail (source_file)
+      && g_file_query_file_type (target_file, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS, NULL) != G_FILE_TYPE_DIRECTORY)
+    return;
 
-  /* release the cache lock */
-  _thumbnail_cache_unlock (cache);
+  thunar_thumbnail_cache_queue_file (cache, THUNAR_THUMBNAIL_CACHE_QUEUE_COPY,
+                                     source_file, target_file);
 }
 
 
@@ -628,33 +652,12 @@ thunar_thumbnail_cache_delete_file (ThunarThumbnailCache *cache,
   _thunar_return_if_fail (THUNAR_IS_THUMBNAIL_CACHE (cache));
   _thunar_return_if_fail (G_IS_FILE (file));
 
-  /* acquire a cache lock */
-  _thumbnail_cache_lock (cache);
-
-  /* check if we have a valid proxy for the cache service */
-  if (cache->proxy_state != THUNAR_THUMBNAIL_CACHE_PROXY_FAILED)
-    {
-      /* add the file to the delete queue */
-      cache->delete_queue = g_list_prepend (cache->delete_queue, g_object_ref (file));
-    }
-
-  if (cache->proxy_state == THUNAR_THUMBNAIL_CACHE_PROXY_AVAILABLE)
-    {
-      /* cancel any pending timeout to process the delete queue */
-      if (cache->delete_queue_idle_id > 0)
-        {
-          g_source_remove (cache->delete_queue_idle_id);
-          cache->delete_queue_idle_id = 0;
-        }
-
-      /* process the delete queue in a 250ms timeout */
-      cache->delete_queue_idle_id =
-        g_timeout_add (500, (GSourceFunc) thunar_thumbnail_cache_process_delete_queue,
-                       cache);
-    }
+  /* nothing to delete if the file never had a thumbnail */
+  if (!thunar_thumbnail_cache_has_thumbnail (file))
+    return;
 
-  /* release the cache lock */
-  _thumbnail_cache_unlock (cache);
+  thunar_thumbnail_cache_queue_file (cache, THUNAR_THUMBNAIL_CACHE_QUEUE_DELETE,
+                                     file, NULL);
 }
 
 
@@ -666,32 +669,79 @@ thunar_thumbnail_cache_cleanup_file (ThunarThumbnailCache *cache,
   _thunar_return_if_fail (THUNAR_IS_THUMBNAIL_CACHE (cache));
   _thunar_return_if_fail (G_IS_FILE (file));
 
-  /* acquire a cache lock */
+  /* the file is a base URI for the cleanup, so always queue it */
+  thunar_thumbnail_cache_queue_file (cache, THUNAR_THUMBNAIL_CACHE_QUEUE_CLEANUP,
+                                     file, NULL);
+}
+
+
+
+/**
+ * thunar_thumbnail_cache_cleanup_files:
+ * @cache     : a #ThunarThumbnailCache.
+ * @file_list : a list of #GFile<!---->s.
+ *
+ * Like thunar_thumbnail_cache_cleanup_file(), but queues all files
+ * of @file_list while holding the cache lock only once.
+ **/
+void
+thunar_thumbnail_cache_cleanup_files (ThunarThumbnailCache *cache,
+                                      GList                *file_list)
+{
+  ThunarThumbnailCacheQueue *queue = &cache->queues[THUNAR_THUMBNAIL_CACHE_QUEUE_CLEANUP];
+  GList                     *lp;
+
+  _thunar_return_if_fail (THUNAR_IS_THUMBNAIL_CACHE (cache));
+
+  if (file_list == NULL)
+    return;
+
   _thumbnail_cache_lock (cache);
 
-  /* check if we have a valid proxy for the cache service */
   if (cache->proxy_state != THUNAR_THUMBNAIL_CACHE_PROXY_FAILED)
     {
-      /* add the file to the cleanup queue */
-      cache->cleanup_queue = g_list_prepend (cache->cleanup_queue, g_object_ref (file));
+      for (lp = file_list; lp != NULL; lp = lp->next)
+        thunar_thumbnail_cache_queue_add (queue, lp->data, NULL);
+
+      thunar_thumbnail_cache_schedule_queue (cache, queue);
     }
 
-  if (cache->proxy_state == THUNAR_THUMBNAIL_CACHE_PROXY_AVAILABLE)
-    {
-      /* cancel any pending timeout to process the cleanup queue */
-      if (cache->cleanup_queue_idle_id > 0)
-        {
-          g_source_remove (cache->cleanup_queue_idle_id);
-          cache->cleanup_queue_idle_id = 0;
-        }
+  _thumbnail_cache_unlock (cache);
+}
 
-      /* process the cleanup queue in a 250ms timeout */
-      cache->cleanup_queue_idle_id =
-        g_timeout_add (1000, (GSourceFunc) thunar_thumbnail_cache_process_cleanup_queue,
-                       cache);
-    }
 
-  /* release the cache lock */
+
+/**
+ * thunar_thumbnail_cache_get_queue_depth:
+ * @cache     : a #ThunarThumbnailCache.
+ * @n_move    : return location for the number of queued moves or %NULL.
+ * @n_copy    : return location for the number of queued copies or %NULL.
+ * @n_delete  : return location for the number of queued deletes or %NULL.
+ * @n_cleanup : return location for the number of queued cleanups or %NULL.
+ *
+ * Returns the number of requests currently waiting to be sent to the
+ * thumbnail cache service.
+ **/
+void
+thunar_thumbnail_cache_get_queue_depth (ThunarThumbnailCache *cache,
+                                        guint                *n_move,
+                                        guint                *n_copy,
+                                        guint                *n_delete,
+                                        guint                *n_cleanup)
+{
+  _thunar_return_if_fail (THUNAR_IS_THUMBNAIL_CACHE (cache));
+
+  _thumbnail_cache_lock (cache);
+
+  if (n_move != NULL)
+    *n_move = cache->queues[THUNAR_THUMBNAIL_CACHE_QUEUE_MOVE].source_files->len;
+  if (n_copy != NULL)
+    *n_copy = cache->queues[THUNAR_THUMBNAIL_CACHE_QUEUE_COPY].source_files->len;
+  if (n_delete != NULL)
+    *n_delete = cache->queues[THUNAR_THUMBNAIL_CACHE_QUEUE_DELETE].source_files->len;
+  if (n_cleanup != NULL)
+    *n_cleanup = cache->queues[THUNAR_THUMBNAIL_CACHE_QUEUE_CLEANUP].source_files->len;
+
   _thumbnail_cache_unlock (cache);
 }
 
@@ -705,6 +755,7 @@ thunar_thumbnail_cache_proxy_created (GObject      *source,
   ThunarThumbnailCache     *cache = THUNAR_THUMBNAIL_CACHE (userdata);
   ThunarThumbnailCacheDBus *proxy;
   GError                   *error = NULL;
+  guint                     n;
 
   _thumbnail_cache_lock (cache);
 
@@ -722,29 +773,9 @@ thunar_thumbnail_cache_proxy_created (GObject      *source,
 
   g_clear_error (&error);
 
-  /* process the move queue in a 250ms timeout */
-  if (cache->move_source_queue)
-      cache->move_queue_idle_id =
-        g_timeout_add_full (G_PRIORITY_DEFAULT_IDLE, 250, thunar_thumbnail_cache_process_move_queue,
-                            cache, thunar_thumbnail_cache_process_move_queue_destroy);
-
-  /* process the copy queue in a 250ms timeout */
-  if (cache->copy_source_queue)
-      cache->copy_queue_idle_id =
-        g_timeout_add_full (G_PRIORITY_DEFAULT_IDLE, 500, thunar_thumbnail_cache_process_copy_queue,
-                            cache, thunar_thumbnail_cache_process_copy_queue_destroy);
-
-  /* process the delete queue in a 250ms timeout */
-  if (cache->delete_queue)
-      cache->delete_queue_idle_id =
-        g_timeout_add (500, (GSourceFunc) thunar_thumbnail_cache_process_delete_queue,
-                       cache);
-
-  /* process the cleanup queue in a 250ms timeout */
-  if (cache->cleanup_queue)
-      cache->cleanup_queue_idle_id =
-        g_timeout_add (1000, (GSourceFunc) thunar_thumbnail_cache_process_cleanup_queue,
-                       cache);
+  /* process the files queued while we were waiting for the proxy */
+  for (n = 0; n < THUNAR_THUMBNAIL_CACHE_N_QUEUES; ++n)
+    thunar_thumbnail_cache_schedule_queue (cache, &cache->queues[n]);
 
   _thumbnail_cache_unlock (cache);
 
@@ -764,6 +795,16 @@ thunar_thumbnail_cache_init (ThunarThumbnailCache *cache)
   cache->lock = g_mutex_new ();
 #endif
 
+  /* setup the request queues */
+  thunar_thumbnail_cache_queue_init (cache, &cache->queues[THUNAR_THUMBNAIL_CACHE_QUEUE_MOVE],
+                                     THUNAR_THUMBNAIL_CACHE_QUEUE_MOVE, 250);
+  thunar_thumbnail_cache_queue_init (cache, &cache->queues[THUNAR_THUMBNAIL_CACHE_QUEUE_COPY],
+                                     THUNAR_THUMBNAIL_CACHE_QUEUE_COPY, 500);
+  thunar_thumbnail_cache_queue_init (cache, &cache->queues[THUNAR_THUMBNAIL_CACHE_QUEUE_DELETE],
+                                     THUNAR_THUMBNAIL_CACHE_QUEUE_DELETE, 500);
+  thunar_thumbnail_cache_queue_init (cache, &cache->queues[THUNAR_THUMBNAIL_CACHE_QUEUE_CLEANUP],
+                                     THUNAR_THUMBNAIL_CACHE_QUEUE_CLEANUP, 1000);
+
   /* add an additional reference to keep us alive while tre proxy initializes */
   g_object_ref (cache);
 
@@ -25,7 +25,7 @@
 
 G_BEGIN_DECLS
 
-#define THUNAR_TYPE_THUMBNAIL_CACHE            (thunar_thumbnail_cache_get_type ())
+#define THUNAR_TYPE_THUMBNAIL_CACHE            (thunar_thumbnail_cache_get_type      ())
 #define THUNAR_THUMBNAIL_CACHE(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), THUNAR_TYPE_THUMBNAIL_CACHE, ThunarThumbnailCache))
 #define THUNAR_THUMBNAIL_CACHE_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), THUNAR_TYPE_THUMBNAIL_CACHE, ThunarThumbnailCacheClass))
 #define THUNAR_IS_THUMBNAIL_CACHE(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), THUNAR_TYPE_THUMBNAIL_CACHE))
@@ -36,20 +36,28 @@ typedef struct _ThunarThumbnailCachePrivate ThunarThumbnailCachePrivate;
 typedef struct _ThunarThumbnailCacheClass   ThunarThumbnailCacheClass;
 typedef struct _ThunarThumbnailCache        ThunarThumbnailCache;
 
-GType                 thunar_thumbnail_cache_get_type     (void) G_GNUC_CONST;
+GType                 thunar_thumbnail_cache_get_type      (void) G_GNUC_CONST;
 
-ThunarThumbnailCache *thunar_thumbnail_cache_new          (void) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
+ThunarThumbnailCache *thunar_thumbnail_cache_new           (void) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
 
-void                  thunar_thumbnail_cache_move_file    (ThunarThumbnailCache *cache,
-                                                           GFile                *source_file,
-                                                           GFile                *target_file);
-void                  thunar_thumbnail_cache_copy_file    (ThunarThumbnailCache *cache,
-                                                           GFile                *source_file,
-                                                           GFile                *target_file);
-void                  thunar_thumbnail_cache_delete_file  (ThunarThumbnailCache *cache,
-                                                           GFile                *file);
-void                  thunar_thumbnail_cache_cleanup_file (ThunarThumbnailCache *cache,
-                                                           GFile                *file);
+void                  thunar_thumbnail_cache_move_file     (ThunarThumbnailCache *cache,
+                                                            GFile                *source_file,
+                                                            GFile                *target_file);
+void                  thunar_thumbnail_cache_copy_file     (ThunarThumbnailCache *cache,
+                                                            GFile                *source_file,
+                                                            GFile                *target_file);
+void                  thunar_thumbnail_cache_delete_file   (ThunarThumbnailCache *cache,
+                                                            GFile                *file);
+void                  thunar_thumbnail_cache_cleanup_file  (ThunarThumbnailCache *cache,
+                                                            GFile                *file);
+void                  thunar_thumbnail_cache_cleanup_files (ThunarThumbnailCache *cache,
+                                                            GList                *file_list);
+
+void                  thunar_thumbnail_cache_get_queue_depth (ThunarThumbnailCache *cache,
+                                                              guint                *n_move,
+                                                              guint                *n_copy,
+                                                              guint                *n_delete,
+                                                              guint                *n_cleanup);
 
 G_END_DECLS
 
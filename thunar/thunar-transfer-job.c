@@ -23,23 +23,44 @@
 #include <config.h>
 #endif
 
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
 #include <gio/gio.h>
 
 #include <thunar/thunar-application.h>
 #include <thunar/thunar-gio-extensions.h>
-#include <thunar/thunar-io-scan-directory.h>
+#include <thunar/thunar-io-copy.h>
 #include <thunar/thunar-io-jobs-util.h>
 #include <thunar/thunar-job.h>
 #include <thunar/thunar-preferences.h>
 #include <thunar/thunar-private.h>
 #include <thunar/thunar-thumbnail-cache.h>
 #include <thunar/thunar-transfer-job.h>
+#include <thunar/thunar-transfer-journal.h>
+
 
 
+/* files from this size on are journaled before they are copied,
+ * so an interrupted copy can be resumed */
+#define THUNAR_TRANSFER_JOB_JOURNAL_PARTIAL_SIZE (16 * 1024 * 1024)
 
 /* seconds before we show the transfer rate + remaining time */
 #define MINIMUM_TRANSFER_TIME (10 * G_USEC_PER_SEC) /* 10 seconds */
 
+/* files up to this size are copied concurrently by the worker pool */
+#define THUNAR_TRANSFER_JOB_PARALLEL_MAX_SIZE (1024 * 1024)
+
+/* maximum number of worker threads per transfer job */
+#define THUNAR_TRANSFER_JOB_MAX_THREADS (8)
+
+/* maximum number of concurrent copies from a single device */
+#define THUNAR_TRANSFER_JOB_DEVICE_TASKS (4)
+
 
 
 /* Property identifiers */
@@ -47,11 +68,30 @@ enum
 {
   PROP_0,
   PROP_FILE_SIZE_BINARY,
+  PROP_PARALLEL_COPY,
+  PROP_PRESERVE_HARDLINKS,
+  PROP_SKIP_IDENTICAL,
+  PROP_SKIP_IDENTICAL_COMPARE,
+  PROP_VERIFY,
 };
 
 
 
-typedef struct _ThunarTransferNode ThunarTransferNode;
+/* how far the scanner got with a transfer node */
+typedef enum
+{
+  THUNAR_TRANSFER_NODE_UNSCANNED,
+  THUNAR_TRANSFER_NODE_LISTED,  /* the immediate children are known */
+  THUNAR_TRANSFER_NODE_SCANNED, /* the whole subtree is known */
+} ThunarTransferNodeState;
+
+
+
+typedef struct _ThunarTransferNode     ThunarTransferNode;
+typedef struct _ThunarTransferTask     ThunarTransferTask;
+typedef struct _ThunarTransferEvent    ThunarTransferEvent;
+typedef struct _ThunarTransferDirIndex ThunarTransferDirIndex;
+typedef struct _ThunarTransferInode    ThunarTransferInode;
 
 
 
@@ -69,6 +109,19 @@ static void     thunar_transfer_job_finalize     (GObject                *object
 static gboolean thunar_transfer_job_execute      (ExoJob                 *job,
                                                   GError                **error);
 static void     thunar_transfer_node_free        (gpointer                data);
+static void     thunar_transfer_dir_index_free   (gpointer                data);
+static guint    thunar_transfer_inode_hash       (gconstpointer           data);
+static gboolean thunar_transfer_inode_equal      (gconstpointer           a,
+                                                  gconstpointer           b);
+static void     thunar_transfer_inode_free       (gpointer                data);
+static void     thunar_transfer_job_copy_node    (ThunarTransferJob      *job,
+                                                  ThunarTransferNode     *node,
+                                                  GFile                  *target_file,
+                                                  GFile                  *target_parent_file,
+                                                  GList                 **target_file_list_return,
+                                                  GError                **error);
+static gboolean thunar_transfer_job_verify_destination (ThunarTransferJob *job,
+                                                        GError           **error);
 
 
 
@@ -96,6 +149,41 @@ struct _ThunarTransferJob
 
   ThunarPreferences    *preferences;
   gboolean              file_size_binary;
+  gboolean              parallel_copy;
+  gboolean              preserve_hardlinks;
+  gboolean              skip_identical;
+  gboolean              skip_identical_compare;
+  gboolean              verify;
+
+  /* worker pool for concurrent copies of small files */
+  GThreadPool          *copy_pool;
+  GAsyncQueue          *copy_results;
+  GHashTable           *copy_devices;
+  guint                 copy_n_running;
+
+  /* number of files copied using each strategy */
+  guint                 n_strategy_files[THUNAR_IO_COPY_N_STRATEGIES];
+
+  /* scanner thread listing the source directories while we copy */
+  GThreadPool          *scan_pool;
+  GAsyncQueue          *scan_events;
+  GError               *scan_error;
+  volatile gint         scan_stop;
+  guint                 scan_done : 1;
+  guint                 scan_verified : 1;
+
+  /* names in the target directories, see thunar_transfer_job_get_dir_index() */
+  GHashTable           *dir_indexes;
+
+  /* first target of each multiply linked source inode */
+  GHashTable           *hardlinks;
+
+  /* completed and partially copied files, to resume the transfer */
+  ThunarTransferJournal *journal;
+  gboolean              journal_resume;
+
+  /* the target whose copy is recorded as partial in the journal */
+  GFile                *journal_partial_file;
 };
 
 struct _ThunarTransferNode
@@ -103,6 +191,52 @@ struct _ThunarTransferNode
   ThunarTransferNode *next;
   ThunarTransferNode *children;
   GFile              *source_file;
+  GFileType           type;
+  guint64             size;
+  guint32             device;
+  gchar              *display_name;
+  guint64             inode;
+  guint32             n_links;
+  guint64             mtime;
+
+  /* only accessed from the job thread */
+  ThunarTransferNodeState state;
+  guint                   serial : 1; /* never hand over to the worker pool */
+};
+
+struct _ThunarTransferTask
+{
+  GFile              *source_file;
+  GFile              *target_file;
+  guint64             size;
+  guint32             device;
+  guint32             n_links;
+  guint64             mtime;
+  gchar              *display_name;
+  ThunarIoCopyStrategy strategy;
+  GError             *error;
+};
+
+struct _ThunarTransferEvent
+{
+  ThunarTransferNode     *node;  /* %NULL once the scanner is done */
+  ThunarTransferNodeState state;
+  guint64                 size;  /* size of the listed children */
+};
+
+struct _ThunarTransferDirIndex
+{
+  /* names of the files in the directory, %NULL if unknown */
+  GHashTable *names;
+
+  /* last "(copy N)" number used per source display name */
+  GHashTable *copies;
+};
+
+struct _ThunarTransferInode
+{
+  guint32 device;
+  guint64 inode;
 };
 
 
@@ -137,6 +271,78 @@ thunar_transfer_job_class_init (ThunarTransferJobClass *klass)
                                                          NULL,
                                                          TRUE,
                                                          EXO_PARAM_READWRITE));
+
+  /**
+   * ThunarTransferJob:parallel-copy:
+   *
+   * Whether small files are copied concurrently by a pool
+   * of worker threads.
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_PARALLEL_COPY,
+                                   g_param_spec_boolean ("parallel-copy",
+                                                         "ParallelCopy",
+                                                         NULL,
+                                                         TRUE,
+                                                         EXO_PARAM_READWRITE));
+
+  /**
+   * ThunarTransferJob:preserve-hardlinks:
+   *
+   * Whether files linked to the same inode are linked again at
+   * the destination instead of being copied separately.
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_PRESERVE_HARDLINKS,
+                                   g_param_spec_boolean ("preserve-hardlinks",
+                                                         "PreserveHardlinks",
+                                                         NULL,
+                                                         TRUE,
+                                                         EXO_PARAM_READWRITE));
+
+  /**
+   * ThunarTransferJob:skip-identical:
+   *
+   * Whether existing targets with the same size and a modification
+   * time not older than the source are skipped instead of asking
+   * the user to replace them.
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_SKIP_IDENTICAL,
+                                   g_param_spec_boolean ("skip-identical",
+                                                         "SkipIdentical",
+                                                         NULL,
+                                                         FALSE,
+                                                         EXO_PARAM_READWRITE));
+
+  /**
+   * ThunarTransferJob:skip-identical-compare:
+   *
+   * Whether the contents of the files are compared as well, before
+   * an existing target is skipped as identical.
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_SKIP_IDENTICAL_COMPARE,
+                                   g_param_spec_boolean ("skip-identical-compare",
+                                                         "SkipIdenticalCompare",
+                                                         NULL,
+                                                         FALSE,
+                                                         EXO_PARAM_READWRITE));
+
+  /**
+   * ThunarTransferJob:verify:
+   *
+   * Whether copied files are read back and compared with the source.
+   * The data is hashed while it is copied, so only the targets have
+   * to be read again.
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_VERIFY,
+                                   g_param_spec_boolean ("verify",
+                                                         "Verify",
+                                                         NULL,
+                                                         FALSE,
+                                                         EXO_PARAM_READWRITE));
 }
 
 
@@ -147,6 +353,16 @@ thunar_transfer_job_init (ThunarTransferJob *job)
   job->preferences = thunar_preferences_get ();
   exo_binding_new (G_OBJECT (job->preferences), "misc-file-size-binary",
                    G_OBJECT (job), "file-size-binary");
+  exo_binding_new (G_OBJECT (job->preferences), "misc-parallel-copy",
+                   G_OBJECT (job), "parallel-copy");
+  exo_binding_new (G_OBJECT (job->preferences), "misc-preserve-hardlinks",
+                   G_OBJECT (job), "preserve-hardlinks");
+  exo_binding_new (G_OBJECT (job->preferences), "misc-skip-identical",
+                   G_OBJECT (job), "skip-identical");
+  exo_binding_new (G_OBJECT (job->preferences), "misc-skip-identical-compare",
+                   G_OBJECT (job), "skip-identical-compare");
+  exo_binding_new (G_OBJECT (job->preferences), "misc-verify-copies",
+                   G_OBJECT (job), "verify");
 
   job->type = 0;
   job->source_node_list = NULL;
@@ -158,6 +374,20 @@ thunar_transfer_job_init (ThunarTransferJob *job)
   job->last_total_progress = 0;
   job->transfer_rate = 0;
   job->start_time = 0;
+
+  job->copy_pool = NULL;
+  job->copy_results = g_async_queue_new ();
+  job->copy_devices = g_hash_table_new (g_direct_hash, g_direct_equal);
+  job->copy_n_running = 0;
+
+  job->scan_pool = NULL;
+  job->scan_events = g_async_queue_new ();
+  job->scan_error = NULL;
+
+  job->dir_indexes = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal,
+                                            g_object_unref, thunar_transfer_dir_index_free);
+  job->hardlinks = g_hash_table_new_full (thunar_transfer_inode_hash, thunar_transfer_inode_equal,
+                                          thunar_transfer_inode_free, g_object_unref);
 }
 
 
@@ -171,6 +401,20 @@ thunar_transfer_job_finalize (GObject *object)
 
   thunar_g_file_list_free (job->target_file_list);
 
+  g_async_queue_unref (job->copy_results);
+  g_hash_table_destroy (job->copy_devices);
+
+  g_async_queue_unref (job->scan_events);
+  if (job->scan_error != NULL)
+    g_error_free (job->scan_error);
+
+  g_hash_table_destroy (job->dir_indexes);
+  g_hash_table_destroy (job->hardlinks);
+
+  /* keep the journal, the job did not finish */
+  if (job->journal != NULL)
+    thunar_transfer_journal_free (job->journal, FALSE);
+
   g_object_unref (job->preferences);
 
   (*G_OBJECT_CLASS (thunar_transfer_job_parent_class)->finalize) (object);
@@ -192,6 +436,26 @@ thunar_transfer_job_get_property (GObject     *object,
       g_value_set_boolean (value, job->file_size_binary);
       break;
 
+    case PROP_PARALLEL_COPY:
+      g_value_set_boolean (value, job->parallel_copy);
+      break;
+
+    case PROP_PRESERVE_HARDLINKS:
+      g_value_set_boolean (value, job->preserve_hardlinks);
+      break;
+
+    case PROP_SKIP_IDENTICAL:
+      g_value_set_boolean (value, job->skip_identical);
+      break;
+
+    case PROP_SKIP_IDENTICAL_COMPARE:
+      g_value_set_boolean (value, job->skip_identical_compare);
+      break;
+
+    case PROP_VERIFY:
+      g_value_set_boolean (value, job->verify);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -214,6 +478,26 @@ thunar_transfer_job_set_property (GObject      *object,
       job->file_size_binary = g_value_get_boolean (value);
       break;
 
+    case PROP_PARALLEL_COPY:
+      job->parallel_copy = g_value_get_boolean (value);
+      break;
+
+    case PROP_PRESERVE_HARDLINKS:
+      job->preserve_hardlinks = g_value_get_boolean (value);
+      break;
+
+    case PROP_SKIP_IDENTICAL:
+      job->skip_identical = g_value_get_boolean (value);
+      break;
+
+    case PROP_SKIP_IDENTICAL_COMPARE:
+      job->skip_identical_compare = g_value_get_boolean (value);
+      break;
+
+    case PROP_VERIFY:
+      job->verify = g_value_get_boolean (value);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -222,6 +506,218 @@ thunar_transfer_job_set_property (GObject      *object,
 
 
 
+static void
+thunar_transfer_job_push_event (ThunarTransferJob      *job,
+                                ThunarTransferNode     *node,
+                                ThunarTransferNodeState state,
+                                guint64                 size)
+{
+  ThunarTransferEvent *event;
+
+  event = g_slice_new (ThunarTransferEvent);
+  event->node = node;
+  event->state = state;
+  event->size = size;
+
+  g_async_queue_push (job->scan_events, event);
+}
+
+
+
+static gboolean
+thunar_transfer_job_scan_node (ThunarTransferJob  *job,
+                               ThunarTransferNode *node,
+                               GError            **error)
+{
+  GFileEnumerator    *enumerator;
+  ThunarTransferNode *children = NULL;
+  ThunarTransferNode *child_node;
+  GFileInfo          *info;
+  GError             *err = NULL;
+  guint64             size = 0;
+
+  /* this runs in the scanner thread, see thunar_transfer_job_scan() */
+  enumerator = g_file_enumerate_children (node->source_file,
+                                          G_FILE_ATTRIBUTE_STANDARD_NAME ","
+                                          G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME ","
+                                          G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                                          G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                                          G_FILE_ATTRIBUTE_UNIX_DEVICE ","
+                                          G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+                                          G_FILE_ATTRIBUTE_UNIX_INODE ","
+                                          G_FILE_ATTRIBUTE_UNIX_NLINK,
+                                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                          exo_job_get_cancellable (EXO_JOB (job)),
+                                          &err);
+  if (G_UNLIKELY (enumerator == NULL))
+    {
+      g_propagate_error (error, err);
+      return FALSE;
+    }
+
+  /* add the immediate children to the transfer node */
+  while (g_atomic_int_get (&job->scan_stop) == 0
+         && !exo_job_set_error_if_cancelled (EXO_JOB (job), &err))
+    {
+      info = g_file_enumerator_next_file (enumerator, exo_job_get_cancellable (EXO_JOB (job)), &err);
+      if (info == NULL)
+        break;
+
+      /* allocate a new transfer node for the child */
+      child_node = g_slice_new0 (ThunarTransferNode);
+      child_node->source_file = g_file_get_child (node->source_file, g_file_info_get_name (info));
+      child_node->type = g_file_info_get_file_type (info);
+      child_node->size = g_file_info_get_size (info);
+      child_node->device = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_DEVICE);
+      child_node->display_name = g_strdup (g_file_info_get_display_name (info));
+      child_node->inode = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_UNIX_INODE);
+      child_node->n_links = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_NLINK);
+      child_node->mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+
+      /* hook the child node into the child list */
+      child_node->next = children;
+      children = child_node;
+
+      size += child_node->size;
+
+      g_object_unref (info);
+    }
+
+  g_object_unref (enumerator);
+
+  /* the children are released with the tree, even if we failed */
+  node->children = children;
+
+  if (G_UNLIKELY (err != NULL))
+    {
+      g_propagate_error (error, err);
+      return FALSE;
+    }
+
+  if (g_atomic_int_get (&job->scan_stop) != 0)
+    return FALSE;
+
+  /* the job thread can start copying the children now */
+  thunar_transfer_job_push_event (job, node, THUNAR_TRANSFER_NODE_LISTED, size);
+
+  /* scan the child directories in the order they are copied */
+  for (child_node = node->children; child_node != NULL; child_node = child_node->next)
+    if (child_node->type == G_FILE_TYPE_DIRECTORY)
+      if (!thunar_transfer_job_scan_node (job, child_node, error))
+        return FALSE;
+
+  /* the job thread can release the children once they are copied */
+  thunar_transfer_job_push_event (job, node, THUNAR_TRANSFER_NODE_SCANNED, 0);
+
+  return TRUE;
+}
+
+
+
+static void
+thunar_transfer_job_scan (gpointer data,
+                          gpointer user_data)
+{
+  ThunarTransferJob *job = THUNAR_TRANSFER_JOB (user_data);
+  ThunarTransferNode *node;
+  GError            *err = NULL;
+  GList             *lp;
+
+  /* scan the source directories in the order they are copied */
+  for (lp = job->source_node_list; err == NULL && lp != NULL; lp = lp->next)
+    {
+      node = lp->data;
+      if (node->type == G_FILE_TYPE_DIRECTORY
+          && !thunar_transfer_job_scan_node (job, node, &err))
+        break;
+    }
+
+  /* tell the job thread that the scanner is done */
+  job->scan_error = err;
+  thunar_transfer_job_push_event (job, NULL, THUNAR_TRANSFER_NODE_SCANNED, 0);
+}
+
+
+
+static void
+thunar_transfer_job_apply_event (ThunarTransferJob   *job,
+                                 ThunarTransferEvent *event)
+{
+  /* account the size of the newly discovered files */
+  job->total_size += event->size;
+
+  if (G_LIKELY (event->node != NULL))
+    event->node->state = event->state;
+  else
+    job->scan_done = TRUE;
+
+  g_slice_free (ThunarTransferEvent, event);
+}
+
+
+
+static void
+thunar_transfer_job_poll_events (ThunarTransferJob *job)
+{
+  ThunarTransferEvent *event;
+
+  if (job->scan_pool == NULL)
+    return;
+
+  /* apply what the scanner found so far */
+  while ((event = g_async_queue_try_pop (job->scan_events)) != NULL)
+    thunar_transfer_job_apply_event (job, event);
+}
+
+
+
+static gboolean
+thunar_transfer_job_wait_node (ThunarTransferJob      *job,
+                               ThunarTransferNode     *node,
+                               ThunarTransferNodeState state,
+                               GError                **error)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), FALSE);
+  _thunar_return_val_if_fail (node->type == G_FILE_TYPE_DIRECTORY, FALSE);
+
+  while (node->state < state)
+    {
+      /* the scanner stopped before it reached the node */
+      if (job->scan_pool == NULL || job->scan_done)
+        {
+          if (job->scan_error != NULL)
+            g_propagate_error (error, g_error_copy (job->scan_error));
+          else if (!exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+            g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_CANCELLED, _("Operation was cancelled"));
+
+          return FALSE;
+        }
+
+      thunar_transfer_job_apply_event (job, g_async_queue_pop (job->scan_events));
+    }
+
+  return TRUE;
+}
+
+
+
+static void
+thunar_transfer_job_stop_scan (ThunarTransferJob *job)
+{
+  if (job->scan_pool == NULL)
+    return;
+
+  /* wait for the scanner to finish */
+  g_atomic_int_set (&job->scan_stop, 1);
+  g_thread_pool_free (job->scan_pool, FALSE, TRUE);
+
+  /* drop the pending events */
+  thunar_transfer_job_poll_events (job);
+  job->scan_pool = NULL;
+}
+
+
+
 static void
 thunar_transfer_job_progress (goffset  current_num_bytes,
                               goffset  total_num_bytes,
@@ -235,6 +731,9 @@ thunar_transfer_job_progress (goffset  current_num_bytes,
 
   _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
 
+  /* refine the total size with what the scanner found meanwhile */
+  thunar_transfer_job_poll_events (job);
+
   if (G_LIKELY (job->total_size > 0))
     {
       /* update total progress */
@@ -274,73 +773,236 @@ thunar_transfer_job_progress (goffset  current_num_bytes,
 
 
 
-static gboolean
+static void
 thunar_transfer_job_collect_node (ThunarTransferJob  *job,
                                   ThunarTransferNode *node,
-                                  GError            **error)
+                                  GFileInfo          *info)
 {
-  ThunarTransferNode *child_node;
-  GFileInfo          *info;
-  GError             *err = NULL;
-  GList              *file_list;
-  GList              *lp;
+  _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
+  _thunar_return_if_fail (node != NULL && G_IS_FILE (node->source_file));
+  _thunar_return_if_fail (G_IS_FILE_INFO (info));
+
+  /* remember what we need to schedule the copy, directory contents
+   * are collected by the scanner thread, see thunar_transfer_job_scan() */
+  node->type = g_file_info_get_file_type (info);
+  node->size = g_file_info_get_size (info);
+  node->device = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_DEVICE);
+  node->inode = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_UNIX_INODE);
+  node->n_links = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_NLINK);
+  node->mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+
+  job->total_size += node->size;
+}
+
+
+
+static void
+thunar_transfer_dir_index_free (gpointer data)
+{
+  ThunarTransferDirIndex *dir_index = data;
+
+  if (dir_index->names != NULL)
+    g_hash_table_destroy (dir_index->names);
+  g_hash_table_destroy (dir_index->copies);
+
+  g_slice_free (ThunarTransferDirIndex, dir_index);
+}
+
+
+
+static ThunarTransferDirIndex *
+thunar_transfer_job_get_dir_index (ThunarTransferJob *job,
+                                   GFile             *directory,
+                                   gboolean           is_new)
+{
+  ThunarTransferDirIndex *dir_index;
+  GFileEnumerator        *enumerator;
+  GFileInfo              *info;
+
+  _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), NULL);
+  _thunar_return_val_if_fail (G_IS_FILE (directory), NULL);
+
+  dir_index = g_hash_table_lookup (job->dir_indexes, directory);
+  if (G_LIKELY (dir_index != NULL))
+    return dir_index;
+
+  dir_index = g_slice_new0 (ThunarTransferDirIndex);
+  dir_index->names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  dir_index->copies = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  /* directories we created ourselves are known to be empty */
+  if (!is_new)
+    {
+      enumerator = g_file_enumerate_children (directory, G_FILE_ATTRIBUTE_STANDARD_NAME,
+                                              G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                              exo_job_get_cancellable (EXO_JOB (job)),
+                                              NULL);
+      if (G_LIKELY (enumerator != NULL))
+        {
+          while ((info = g_file_enumerator_next_file (enumerator, exo_job_get_cancellable (EXO_JOB (job)), NULL)) != NULL)
+            {
+              g_hash_table_insert (dir_index->names, g_strdup (g_file_info_get_name (info)),
+                                   GUINT_TO_POINTER (TRUE));
+              g_object_unref (info);
+            }
+
+          g_object_unref (enumerator);
+        }
+      else
+        {
+          /* we don't know the contents, fall back to probing the files */
+          g_hash_table_destroy (dir_index->names);
+          dir_index->names = NULL;
+        }
+    }
+
+  g_hash_table_insert (job->dir_indexes, g_object_ref (directory), dir_index);
+
+  return dir_index;
+}
+
+
+
+static gboolean
+thunar_transfer_job_lookup_target (ThunarTransferJob *job,
+                                   GFile             *target_file,
+                                   gboolean          *exists_return)
+{
+  ThunarTransferDirIndex *dir_index;
+  GFile                  *parent;
+  gchar                  *base_name;
 
   _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), FALSE);
-  _thunar_return_val_if_fail (node != NULL && G_IS_FILE (node->source_file), FALSE);
-  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (target_file), FALSE);
+  _thunar_return_val_if_fail (exists_return != NULL, FALSE);
 
-  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+  parent = g_file_get_parent (target_file);
+  if (G_UNLIKELY (parent == NULL))
     return FALSE;
 
-  info = g_file_query_info (node->source_file,
-                            G_FILE_ATTRIBUTE_STANDARD_SIZE ","
-                            G_FILE_ATTRIBUTE_STANDARD_TYPE,
-                            G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
-                            exo_job_get_cancellable (EXO_JOB (job)),
-                            &err);
+  dir_index = thunar_transfer_job_get_dir_index (job, parent, FALSE);
+  g_object_unref (parent);
 
-  if (G_UNLIKELY (info == NULL))
+  /* we don't know, the caller has to find out by copying the file */
+  if (G_UNLIKELY (dir_index->names == NULL))
     return FALSE;
 
-  job->total_size += g_file_info_get_size (info);
+  base_name = g_file_get_basename (target_file);
+  *exists_return = g_hash_table_lookup (dir_index->names, base_name) != NULL;
+  g_free (base_name);
 
-  /* check if we have a directory here */
-  if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
-    {
-      /* scan the directory for immediate children */
-      file_list = thunar_io_scan_directory (THUNAR_JOB (job), node->source_file,
-                                            G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
-                                            FALSE, FALSE, FALSE, &err);
+  return TRUE;
+}
 
-      /* add children to the transfer node */
-      for (lp = file_list; err == NULL && lp != NULL; lp = lp->next)
-        {
-          /* allocate a new transfer node for the child */
-          child_node = g_slice_new0 (ThunarTransferNode);
-          child_node->source_file = g_object_ref (lp->data);
 
-          /* hook the child node into the child list */
-          child_node->next = node->children;
-          node->children = child_node;
 
-          /* collect the child node */
-          thunar_transfer_job_collect_node (job, child_node, &err);
-        }
+static void
+thunar_transfer_job_index_file (ThunarTransferJob *job,
+                                GFile             *target_file)
+{
+  ThunarTransferDirIndex *dir_index;
+  GFile                  *parent;
 
-      /* release the child files */
-      thunar_g_file_list_free (file_list);
-    }
+  _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
+  _thunar_return_if_fail (G_IS_FILE (target_file));
 
-  /* release file info */
-  g_object_unref (info);
+  parent = g_file_get_parent (target_file);
+  if (G_UNLIKELY (parent == NULL))
+    return;
 
-  if (G_UNLIKELY (err != NULL))
+  /* the index of the directory may already be released */
+  dir_index = g_hash_table_lookup (job->dir_indexes, parent);
+  if (dir_index != NULL && dir_index->names != NULL)
     {
-      g_propagate_error (error, err);
-      return FALSE;
+      g_hash_table_insert (dir_index->names, g_file_get_basename (target_file),
+                           GUINT_TO_POINTER (TRUE));
     }
 
-  return TRUE;
+  g_object_unref (parent);
+}
+
+
+
+static guint
+thunar_transfer_inode_hash (gconstpointer data)
+{
+  const ThunarTransferInode *inode = data;
+
+  return (guint) inode->inode ^ (guint) (inode->inode >> 32) ^ inode->device;
+}
+
+
+
+static gboolean
+thunar_transfer_inode_equal (gconstpointer a,
+                             gconstpointer b)
+{
+  const ThunarTransferInode *inode_a = a;
+  const ThunarTransferInode *inode_b = b;
+
+  return inode_a->inode == inode_b->inode && inode_a->device == inode_b->device;
+}
+
+
+
+static void
+thunar_transfer_inode_free (gpointer data)
+{
+  g_slice_free (ThunarTransferInode, data);
+}
+
+
+
+static GFile *
+thunar_transfer_job_link_node (ThunarTransferJob  *job,
+                               ThunarTransferNode *node,
+                               GFile              *target_file)
+{
+  ThunarTransferInode key;
+  GFile              *first_target;
+  gchar              *first_path;
+  gchar              *target_path;
+  gboolean            linked = FALSE;
+
+  _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), NULL);
+  _thunar_return_val_if_fail (G_IS_FILE (target_file), NULL);
+
+  /* check if we already copied another link to the same inode */
+  key.device = node->device;
+  key.inode = node->inode;
+  first_target = g_hash_table_lookup (job->hardlinks, &key);
+  if (first_target == NULL)
+    return NULL;
+
+  /* recreate the link, if anything goes wrong the caller copies the file */
+  first_path = g_file_get_path (first_target);
+  target_path = g_file_get_path (target_file);
+  if (first_path != NULL && target_path != NULL)
+    linked = (link (first_path, target_path) == 0);
+  g_free (first_path);
+  g_free (target_path);
+
+  return linked ? g_object_ref (target_file) : NULL;
+}
+
+
+
+static void
+thunar_transfer_job_remember_link (ThunarTransferJob  *job,
+                                   ThunarTransferNode *node,
+                                   GFile              *target_file)
+{
+  ThunarTransferInode *key;
+
+  _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
+  _thunar_return_if_fail (G_IS_FILE (target_file));
+
+  key = g_slice_new (ThunarTransferInode);
+  key->device = node->device;
+  key->inode = node->inode;
+
+  /* the other links to the inode are linked to this target */
+  g_hash_table_insert (job->hardlinks, key, g_object_ref (target_file));
 }
 
 
@@ -348,15 +1010,18 @@ thunar_transfer_job_collect_node (ThunarTransferJob  *job,
 static gboolean
 ttj_copy_file (ThunarTransferJob *job,
                GFile             *source_file,
+               GFileType          source_type,
                GFile             *target_file,
                GFileCopyFlags     copy_flags,
                gboolean           merge_directories,
                GError           **error)
 {
-  GFileType source_type;
-  GFileType target_type;
-  gboolean  target_exists;
-  GError   *err = NULL;
+  ThunarIoCopyStrategy strategy;
+  GFileType            target_type;
+  gboolean             target_exists;
+  gboolean             keep_partial;
+  gboolean             succeed;
+  GError              *err = NULL;
 
   _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), FALSE);
   _thunar_return_val_if_fail (G_IS_FILE (source_file), FALSE);
@@ -369,33 +1034,56 @@ ttj_copy_file (ThunarTransferJob *job,
   if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
     return FALSE;
 
-  source_type = g_file_query_file_type (source_file, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
-                                        exo_job_get_cancellable (EXO_JOB (job)));
-
-  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
-    return FALSE;
-
-  target_type = g_file_query_file_type (target_file, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
-                                        exo_job_get_cancellable (EXO_JOB (job)));
+  /* the type is already known for collected files */
+  if (source_type == G_FILE_TYPE_UNKNOWN)
+    {
+      source_type = g_file_query_file_type (source_file, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                            exo_job_get_cancellable (EXO_JOB (job)));
 
-  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
-    return FALSE;
+      if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+        return FALSE;
+    }
 
   /* check if the target is a symlink and we are in overwrite mode */
-  if (target_type == G_FILE_TYPE_SYMBOLIC_LINK && (copy_flags & G_FILE_COPY_OVERWRITE) != 0)
+  if ((copy_flags & G_FILE_COPY_OVERWRITE) != 0)
     {
+      target_type = g_file_query_file_type (target_file, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                            exo_job_get_cancellable (EXO_JOB (job)));
+
+      if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+        return FALSE;
+
       /* try to delete the symlink */
-      if (!g_file_delete (target_file, exo_job_get_cancellable (EXO_JOB (job)), &err))
+      if (target_type == G_FILE_TYPE_SYMBOLIC_LINK
+          && !g_file_delete (target_file, exo_job_get_cancellable (EXO_JOB (job)), &err))
         {
           g_propagate_error (error, err);
           return FALSE;
         }
     }
 
-  /* try to copy the file */
-  g_file_copy (source_file, target_file, copy_flags,
-               exo_job_get_cancellable (EXO_JOB (job)),
-               thunar_transfer_job_progress, job, &err);
+  /* a cancelled copy is kept if the journal can resume it */
+  keep_partial = (job->journal_partial_file != NULL
+                  && g_file_equal (target_file, job->journal_partial_file));
+
+  /* try to copy the file, natively if possible */
+  if (job->verify)
+    {
+      succeed = thunar_io_copy_file_verified (source_file, target_file, copy_flags, keep_partial,
+                                              exo_job_get_cancellable (EXO_JOB (job)),
+                                              thunar_transfer_job_progress, job,
+                                              &strategy, &err);
+    }
+  else
+    {
+      succeed = thunar_io_copy_file (source_file, target_file, copy_flags, keep_partial,
+                                     exo_job_get_cancellable (EXO_JOB (job)),
+                                     thunar_transfer_job_progress, job,
+                                     &strategy, &err);
+    }
+
+  if (succeed)
+    job->n_strategy_files[strategy] += 1;
 
   /* check if there were errors */
   if (G_UNLIKELY (err != NULL && err->domain == G_IO_ERROR))
@@ -403,7 +1091,8 @@ ttj_copy_file (ThunarTransferJob *job,
       if (err->code == G_IO_ERROR_WOULD_MERGE
           || (err->code == G_IO_ERROR_EXISTS
               && source_type == G_FILE_TYPE_DIRECTORY
-              && target_type == G_FILE_TYPE_DIRECTORY))
+              && g_file_query_file_type (target_file, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                         exo_job_get_cancellable (EXO_JOB (job))) == G_FILE_TYPE_DIRECTORY))
         {
           /* we tried to overwrite a directory with a directory. this normally results
            * in a merge. ignore the error if we actually *want* to merge */
@@ -453,15 +1142,165 @@ ttj_copy_file (ThunarTransferJob *job,
         }
     }
 
-  if (G_UNLIKELY (err != NULL))
-    {
-      g_propagate_error (error, err);
-      return FALSE;
-    }
-  else
+  if (G_UNLIKELY (err != NULL))
+    {
+      g_propagate_error (error, err);
+      return FALSE;
+    }
+  else
+    {
+      return TRUE;
+    }
+}
+
+
+
+static void
+thunar_transfer_job_open_journal (ThunarTransferJob *job,
+                                  GError           **error)
+{
+  ThunarJobResponse response;
+  GList            *source_file_list = NULL;
+  GList            *lp;
+
+  _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
+  _thunar_return_if_fail (error == NULL || *error == NULL);
+
+  /* only copies can be resumed */
+  if (job->type != THUNAR_TRANSFER_JOB_COPY && job->type != THUNAR_TRANSFER_JOB_MOVE)
+    return;
+
+  for (lp = g_list_last (job->source_node_list); lp != NULL; lp = lp->prev)
+    source_file_list = g_list_prepend (source_file_list, ((ThunarTransferNode *) lp->data)->source_file);
+  job->journal = thunar_transfer_journal_new (source_file_list, job->target_file_list);
+  g_list_free (source_file_list);
+
+  /* check if an earlier run of the transfer was interrupted */
+  if (job->journal == NULL || !thunar_transfer_journal_load (job->journal))
+    return;
+
+  response = thunar_job_ask_resume (THUNAR_JOB (job), "%s",
+                                    _("An earlier transfer of these files was interrupted."));
+  if (response == THUNAR_JOB_RESPONSE_YES)
+    job->journal_resume = TRUE;
+  else if (response == THUNAR_JOB_RESPONSE_NO)
+    thunar_transfer_journal_reset (job->journal);
+  else
+    exo_job_set_error_if_cancelled (EXO_JOB (job), error);
+}
+
+
+
+static GFile *
+thunar_transfer_job_resume_node (ThunarTransferJob  *job,
+                                 ThunarTransferNode *node,
+                                 GFile              *target_file,
+                                 GError            **error)
+{
+  ThunarTransferJournalState state;
+  GFileInfo                 *info;
+  gboolean                   done = FALSE;
+  GError                    *err = NULL;
+
+  _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), NULL);
+  _thunar_return_val_if_fail (G_IS_FILE (target_file), NULL);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  if (!job->journal_resume || node->type != G_FILE_TYPE_REGULAR)
+    return NULL;
+
+  state = thunar_transfer_journal_lookup (job->journal, target_file, node->size, node->mtime);
+  if (state == THUNAR_TRANSFER_JOURNAL_COMPLETE)
+    {
+      /* make sure the copy is still there */
+      info = g_file_query_info (target_file, G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                                G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                exo_job_get_cancellable (EXO_JOB (job)), NULL);
+      if (info != NULL)
+        {
+          done = ((guint64) g_file_info_get_size (info) == node->size);
+          g_object_unref (info);
+        }
+
+      /* account the file in the job progress */
+      if (done)
+        {
+          job->file_progress = 0;
+          thunar_transfer_job_progress (node->size, node->size, job);
+        }
+    }
+  else if (state == THUNAR_TRANSFER_JOURNAL_PARTIAL)
+    {
+      /* append the missing data to the partial copy */
+      job->file_progress = 0;
+      done = thunar_io_copy_resume_file (node->source_file, target_file,
+                                         exo_job_get_cancellable (EXO_JOB (job)),
+                                         thunar_transfer_job_progress, job, &err);
+      /* the resumed data is not hashed, so compare the whole file */
+      if (done && job->verify)
+        {
+          done = thunar_io_copy_compare_files (node->source_file, target_file,
+                                               exo_job_get_cancellable (EXO_JOB (job)), &err);
+        }
+
+      if (G_UNLIKELY (err != NULL))
+        {
+          g_propagate_error (error, err);
+          return NULL;
+        }
+
+      /* the partial copy is of no use, start over */
+      if (!done)
+        g_file_delete (target_file, exo_job_get_cancellable (EXO_JOB (job)), NULL);
+    }
+
+  return done ? g_object_ref (target_file) : NULL;
+}
+
+
+
+static gboolean
+thunar_transfer_job_is_identical (ThunarTransferJob  *job,
+                                  ThunarTransferNode *node,
+                                  GFile              *target_file)
+{
+  GFileInfo *info;
+  gboolean   identical;
+
+  _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (target_file), FALSE);
+
+  /* only regular files can be identical */
+  if (node->type != G_FILE_TYPE_REGULAR)
+    return FALSE;
+
+  info = g_file_query_info (target_file,
+                            G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                            G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                            G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                            exo_job_get_cancellable (EXO_JOB (job)),
+                            NULL);
+  if (G_UNLIKELY (info == NULL))
+    return FALSE;
+
+  /* copies don't keep the modification time, so the target has to be
+   * at least as recent as the source, as it would be after an earlier copy */
+  identical = (g_file_info_get_file_type (info) == G_FILE_TYPE_REGULAR
+               && (guint64) g_file_info_get_size (info) == node->size
+               && g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) >= node->mtime);
+
+  g_object_unref (info);
+
+  /* make sure if requested */
+  if (identical && job->skip_identical_compare)
     {
-      return TRUE;
+      identical = thunar_io_copy_compare_files (node->source_file, target_file,
+                                                exo_job_get_cancellable (EXO_JOB (job)),
+                                                NULL);
     }
+
+  return identical;
 }
 
 
@@ -469,38 +1308,46 @@ ttj_copy_file (ThunarTransferJob *job,
 /**
  * thunar_transfer_job_copy_file:
  * @job                : a #ThunarTransferJob.
- * @source_file        : the source #GFile to copy.
+ * @node               : the #ThunarTransferNode of the file to copy.
  * @target_file        : the destination #GFile to copy to.
  * @error              : return location for errors or %NULL.
  *
- * Tries to copy @source_file to @target_file. The real destination is the
- * return value and may differ from @target_file (e.g. if you try to copy
+ * Tries to copy the source file of @node to @target_file. The real destination
+ * is the return value and may differ from @target_file (e.g. if you try to copy
  * the file "/foo/bar" into the same directory you'll end up with something
  * like "/foo/copy of bar" instead of "/foo/bar".
  *
  * The return value is guaranteed to be %NULL on errors and @error will
  * always be set in those cases. If the file is skipped, the return value
- * will be @source_file.
+ * will be the source file of @node.
  *
- * Return value: the destination #GFile to which @source_file was copied
+ * Return value: the destination #GFile to which the source file was copied
  *               or linked. The caller is reposible to release it with
- *               g_object_unref() if no longer needed. It points to
- *               @source_file if the file was skipped and will be %NULL
+ *               g_object_unref() if no longer needed. It points to the
+ *               source file if the file was skipped and will be %NULL
  *               on error or cancellation.
  **/
 static GFile *
-thunar_transfer_job_copy_file (ThunarTransferJob *job,
-                               GFile             *source_file,
-                               GFile             *target_file,
-                               GError           **error)
+thunar_transfer_job_copy_file (ThunarTransferJob  *job,
+                               ThunarTransferNode *node,
+                               GFile              *target_file,
+                               GError            **error)
 {
-  ThunarJobResponse response;
-  GFileCopyFlags    copy_flags = G_FILE_COPY_NOFOLLOW_SYMLINKS;
-  GError           *err = NULL;
-  gint              n;
+  ThunarTransferDirIndex *dir_index;
+  ThunarJobResponse       response;
+  GFileCopyFlags          copy_flags = G_FILE_COPY_NOFOLLOW_SYMLINKS;
+  GError                 *err = NULL;
+  GFile                  *source_file = node->source_file;
+  gboolean                exists;
+  GFile                  *parent_file;
+  GFile                  *duplicate_file;
+  gchar                  *duplicate_name;
+  gboolean                use_index = TRUE;
+  guint                   n;
 
   _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), NULL);
   _thunar_return_val_if_fail (G_IS_FILE (source_file), NULL);
+  _thunar_return_val_if_fail (node->display_name != NULL, NULL);
   _thunar_return_val_if_fail (G_IS_FILE (target_file), NULL);
   _thunar_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
@@ -513,40 +1360,75 @@ thunar_transfer_job_copy_file (ThunarTransferJob *job,
     {
       if (G_LIKELY (!g_file_equal (source_file, target_file)))
         {
+          /* don't even try to copy a file over a file we know exists, directories
+           * are handed over to ttj_copy_file() since they are merged */
+          if (use_index
+              && (copy_flags & G_FILE_COPY_OVERWRITE) == 0
+              && node->type != G_FILE_TYPE_DIRECTORY
+              && thunar_transfer_job_lookup_target (job, target_file, &exists)
+              && exists)
+            {
+              g_set_error_literal (&err, G_IO_ERROR, G_IO_ERROR_EXISTS, g_strerror (EEXIST));
+            }
           /* try to copy the file from source_file to the target_file */
-          if (ttj_copy_file (job, source_file, target_file, copy_flags, TRUE, &err))
+          else if (ttj_copy_file (job, source_file, node->type, target_file, copy_flags, TRUE, &err))
             {
+              thunar_transfer_job_index_file (job, target_file);
+
               /* return the real target file */
               return g_object_ref (target_file);
             }
         }
       else
         {
-          for (n = 1; err == NULL; ++n)
+          parent_file = g_file_get_parent (source_file);
+          dir_index = thunar_transfer_job_get_dir_index (job, parent_file, FALSE);
+
+          /* continue after the last copy we created of this file */
+          n = GPOINTER_TO_UINT (g_hash_table_lookup (dir_index->copies, node->display_name));
+
+          for (++n; err == NULL; ++n)
             {
-              GFile *duplicate_file = thunar_io_jobs_util_next_duplicate_file (THUNAR_JOB (job),
-                                                                               source_file,
-                                                                               TRUE, n,
-                                                                               &err);
+              /* abort on cancellation */
+              if (exo_job_set_error_if_cancelled (EXO_JOB (job), &err))
+                break;
 
-              if (err == NULL)
+              duplicate_name = thunar_io_jobs_util_duplicate_name (node->display_name,
+                                                                   node->type == G_FILE_TYPE_DIRECTORY,
+                                                                   TRUE, n);
+
+              /* skip names we know are taken without touching the disk */
+              if (dir_index->names != NULL
+                  && g_hash_table_lookup (dir_index->names, duplicate_name) != NULL)
                 {
-                  /* try to copy the file from source file to the duplicate file */
-                  if (ttj_copy_file (job, source_file, duplicate_file, copy_flags, TRUE, &err))
-                    {
-                      /* return the real target file */
-                      return duplicate_file;
-                    }
+                  g_free (duplicate_name);
+                  continue;
+                }
+
+              duplicate_file = g_file_get_child (parent_file, duplicate_name);
+              g_free (duplicate_name);
+
+              /* try to copy the file from source file to the duplicate file */
+              if (ttj_copy_file (job, source_file, node->type, duplicate_file, copy_flags, TRUE, &err))
+                {
+                  g_hash_table_insert (dir_index->copies, g_strdup (node->display_name), GUINT_TO_POINTER (n));
+                  thunar_transfer_job_index_file (job, duplicate_file);
+                  g_object_unref (parent_file);
 
-                  g_object_unref (duplicate_file);
+                  /* return the real target file */
+                  return duplicate_file;
                 }
 
+              g_object_unref (duplicate_file);
+
               if (err != NULL && err->domain == G_IO_ERROR && err->code == G_IO_ERROR_EXISTS)
                 {
                   /* this duplicate already exists => clear the error to try the next alternative */
                   g_clear_error (&err);
                 }
             }
+
+          g_object_unref (parent_file);
         }
 
       /* check if we can recover from this error */
@@ -555,6 +1437,20 @@ thunar_transfer_job_copy_file (ThunarTransferJob *job,
           /* reset the error */
           g_clear_error (&err);
 
+          /* don't copy files again that are already there */
+          if (job->skip_identical
+              && (copy_flags & G_FILE_COPY_OVERWRITE) == 0
+              && !g_file_equal (source_file, target_file)
+              && thunar_transfer_job_is_identical (job, node, target_file))
+            {
+              /* account the skipped file in the job progress */
+              job->file_progress = 0;
+              thunar_transfer_job_progress (node->size, node->size, job);
+
+              /* tell the caller we skipped the file */
+              return g_object_ref (source_file);
+            }
+
           /* ask the user whether to replace the target file */
           response = thunar_job_ask_replace (THUNAR_JOB (job), source_file,
                                              target_file, &err);
@@ -562,9 +1458,13 @@ thunar_transfer_job_copy_file (ThunarTransferJob *job,
           if (err != NULL)
             break;
 
-          /* check if we should retry */
+          /* check if we should retry, the user may have changed the
+           * target directory meanwhile, so don't trust the index */
           if (response == THUNAR_JOB_RESPONSE_RETRY)
-            continue;
+            {
+              use_index = FALSE;
+              continue;
+            }
 
           /* add overwrite flag and retry if we should overwrite */
           if (response == THUNAR_JOB_RESPONSE_YES)
@@ -588,6 +1488,283 @@ thunar_transfer_job_copy_file (ThunarTransferJob *job,
 
 
 
+static void
+thunar_transfer_job_remove_source (ThunarTransferJob    *job,
+                                   GFile                *source_file,
+                                   ThunarThumbnailCache *thumbnail_cache)
+{
+  ThunarJobResponse response;
+  GError           *err = NULL;
+
+  _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
+  _thunar_return_if_fail (G_IS_FILE (source_file));
+
+  for (;;)
+    {
+      if (g_file_delete (source_file, exo_job_get_cancellable (EXO_JOB (job)), &err))
+        {
+          /* notify the thumbnail cache of the delete operation */
+          thunar_thumbnail_cache_delete_file (thumbnail_cache, source_file);
+          break;
+        }
+
+      /* ask the user to retry */
+      response = thunar_job_ask_skip (THUNAR_JOB (job), "%s", err->message);
+
+      /* reset the error */
+      g_clear_error (&err);
+
+      /* check whether to retry */
+      if (G_LIKELY (response != THUNAR_JOB_RESPONSE_RETRY))
+        break;
+    }
+}
+
+
+
+static void
+thunar_transfer_task_free (ThunarTransferTask *task)
+{
+  g_object_unref (task->source_file);
+  g_object_unref (task->target_file);
+  g_free (task->display_name);
+
+  if (task->error != NULL)
+    g_error_free (task->error);
+
+  g_slice_free (ThunarTransferTask, task);
+}
+
+
+
+static void
+thunar_transfer_job_copy_task (gpointer data,
+                               gpointer user_data)
+{
+  ThunarTransferTask *task = data;
+  ThunarTransferJob  *job = THUNAR_TRANSFER_JOB (user_data);
+
+  /* copy the file without asking questions, conflicts and errors
+   * are resolved by the job thread once we report back */
+  if (!exo_job_set_error_if_cancelled (EXO_JOB (job), &task->error))
+    {
+      if (job->verify)
+        {
+          thunar_io_copy_file_verified (task->source_file, task->target_file,
+                                        G_FILE_COPY_NOFOLLOW_SYMLINKS, FALSE,
+                                        exo_job_get_cancellable (EXO_JOB (job)),
+                                        NULL, NULL, &task->strategy, &task->error);
+        }
+      else
+        {
+          thunar_io_copy_file (task->source_file, task->target_file,
+                               G_FILE_COPY_NOFOLLOW_SYMLINKS, FALSE,
+                               exo_job_get_cancellable (EXO_JOB (job)),
+                               NULL, NULL, &task->strategy, &task->error);
+        }
+    }
+
+  /* hand the task back to the job thread */
+  g_async_queue_push (job->copy_results, task);
+}
+
+
+
+static void
+thunar_transfer_job_finish_task (ThunarTransferJob    *job,
+                                 ThunarTransferTask   *task,
+                                 ThunarThumbnailCache *thumbnail_cache,
+                                 GError              **error)
+{
+  ThunarTransferNode *node;
+  GFile              *target_parent;
+  guint               n_tasks;
+
+  _thunar_return_if_fail (job->copy_n_running > 0);
+
+  /* release the slot of the task */
+  n_tasks = GPOINTER_TO_UINT (g_hash_table_lookup (job->copy_devices, GUINT_TO_POINTER (task->device)));
+  g_hash_table_insert (job->copy_devices, GUINT_TO_POINTER (task->device), GUINT_TO_POINTER (n_tasks - 1));
+  job->copy_n_running -= 1;
+
+  /* only release the task if the job already failed */
+  if (error != NULL && *error != NULL)
+    {
+      thunar_transfer_task_free (task);
+      return;
+    }
+
+  if (G_LIKELY (task->error == NULL))
+    {
+      /* account the copied bytes in the job progress */
+      job->n_strategy_files[task->strategy] += 1;
+      job->file_progress = 0;
+      thunar_transfer_job_progress (task->size, task->size, job);
+
+      /* notify the thumbnail cache of the copy operation */
+      thunar_thumbnail_cache_copy_file (thumbnail_cache, task->source_file, task->target_file);
+      thunar_transfer_job_index_file (job, task->target_file);
+
+      if (job->journal != NULL)
+        {
+          thunar_transfer_journal_record (job->journal, task->target_file, task->size,
+                                          task->mtime, THUNAR_TRANSFER_JOURNAL_COMPLETE);
+        }
+
+      /* remove the source file if we are on copy+remove fallback for move */
+      if (job->type == THUNAR_TRANSFER_JOB_MOVE)
+        thunar_transfer_job_remove_source (job, task->source_file, thumbnail_cache);
+    }
+  else if (!exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+    {
+      /* retry the file on the regular code path, which asks the user how
+       * to resolve conflicts and errors, without going back to the pool */
+      node = g_slice_new0 (ThunarTransferNode);
+      node->source_file = g_object_ref (task->source_file);
+      node->type = G_FILE_TYPE_REGULAR;
+      node->size = task->size;
+      node->device = task->device;
+      node->n_links = task->n_links;
+      node->mtime = task->mtime;
+      node->display_name = g_strdup (task->display_name);
+      node->serial = TRUE;
+      target_parent = g_file_get_parent (task->target_file);
+
+      thunar_transfer_job_copy_node (job, node, NULL, target_parent, NULL, error);
+
+      g_object_unref (target_parent);
+      thunar_transfer_node_free (node);
+    }
+
+  thunar_transfer_task_free (task);
+}
+
+
+
+static void
+thunar_transfer_job_wait_tasks (ThunarTransferJob    *job,
+                                ThunarThumbnailCache *thumbnail_cache,
+                                GError              **error)
+{
+  _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
+
+  /* wait for all concurrent copies to finish */
+  while (job->copy_n_running > 0)
+    {
+      thunar_transfer_job_finish_task (job, g_async_queue_pop (job->copy_results),
+                                       thumbnail_cache, error);
+    }
+}
+
+
+
+static gboolean
+thunar_transfer_job_dispatch_node (ThunarTransferJob    *job,
+                                   ThunarTransferNode   *node,
+                                   GFile                *target_file,
+                                   ThunarThumbnailCache *thumbnail_cache,
+                                   GError              **error)
+{
+  ThunarTransferTask *task;
+  gboolean            exists;
+  guint               n_tasks;
+
+  _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), FALSE);
+  _thunar_return_val_if_fail (error != NULL && *error == NULL, FALSE);
+
+  /* only small regular files are copied concurrently, everything
+   * else (directories, symlinks, large files) stays in order */
+  if (!job->parallel_copy
+      || node->serial
+      || node->type != G_FILE_TYPE_REGULAR
+      || node->size > THUNAR_TRANSFER_JOB_PARALLEL_MAX_SIZE)
+    return FALSE;
+
+  /* links to the same inode are recreated in order */
+  if (job->preserve_hardlinks && node->n_links > 1)
+    return FALSE;
+
+  /* conflicts are resolved on the regular code path */
+  if (thunar_transfer_job_lookup_target (job, target_file, &exists) && exists)
+    return FALSE;
+
+  /* start the worker pool on demand */
+  if (G_UNLIKELY (job->copy_pool == NULL))
+    {
+      job->copy_pool = g_thread_pool_new (thunar_transfer_job_copy_task, job,
+                                          THUNAR_TRANSFER_JOB_MAX_THREADS,
+                                          FALSE, NULL);
+    }
+
+  /* process the copies that finished in the meantime */
+  while (*error == NULL && (task = g_async_queue_try_pop (job->copy_results)) != NULL)
+    thunar_transfer_job_finish_task (job, task, thumbnail_cache, error);
+
+  /* wait for a free slot on the source device */
+  for (;;)
+    {
+      n_tasks = GPOINTER_TO_UINT (g_hash_table_lookup (job->copy_devices, GUINT_TO_POINTER (node->device)));
+      if (*error != NULL || n_tasks < THUNAR_TRANSFER_JOB_DEVICE_TASKS)
+        break;
+
+      thunar_transfer_job_finish_task (job, g_async_queue_pop (job->copy_results),
+                                       thumbnail_cache, error);
+    }
+
+  /* don't queue new copies if the job failed */
+  if (*error != NULL)
+    return TRUE;
+
+  /* queue the copy */
+  task = g_slice_new0 (ThunarTransferTask);
+  task->source_file = g_object_ref (node->source_file);
+  task->target_file = g_object_ref (target_file);
+  task->size = node->size;
+  task->device = node->device;
+  task->n_links = node->n_links;
+  task->mtime = node->mtime;
+  task->display_name = g_strdup (node->display_name);
+
+  g_hash_table_insert (job->copy_devices, GUINT_TO_POINTER (node->device), GUINT_TO_POINTER (n_tasks + 1));
+  job->copy_n_running += 1;
+
+  g_thread_pool_push (job->copy_pool, task, NULL);
+
+  return TRUE;
+}
+
+
+
+static gboolean
+thunar_transfer_job_recheck_destination (ThunarTransferJob *job,
+                                         GError           **error)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), FALSE);
+
+  /* apply what the scanner found so far */
+  thunar_transfer_job_poll_events (job);
+
+  /* the precheck was only an estimate while the sources were scanned */
+  if (!job->scan_done || job->scan_verified)
+    return TRUE;
+
+  job->scan_verified = TRUE;
+
+  if (thunar_transfer_job_verify_destination (job, error))
+    return TRUE;
+
+  /* the user does not want to continue without enough space */
+  if (error != NULL && *error == NULL)
+    {
+      exo_job_cancel (EXO_JOB (job));
+      exo_job_set_error_if_cancelled (EXO_JOB (job), error);
+    }
+
+  return FALSE;
+}
+
+
+
 static void
 thunar_transfer_job_copy_node (ThunarTransferJob  *job,
                                ThunarTransferNode *node,
@@ -603,6 +1780,10 @@ thunar_transfer_job_copy_node (ThunarTransferJob  *job,
   GError               *err = NULL;
   GFile                *real_target_file = NULL;
   gchar                *base_name;
+  GFile                *resumed_file;
+  gboolean              new_directory;
+  gboolean              hardlink;
+  gboolean              exists;
 
   _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
   _thunar_return_if_fail (node != NULL && G_IS_FILE (node->source_file));
@@ -622,6 +1803,10 @@ thunar_transfer_job_copy_node (ThunarTransferJob  *job,
 
   for (; err == NULL && node != NULL; node = node->next)
     {
+      /* re-evaluate the free space once the scanner determined the total size */
+      if (!thunar_transfer_job_recheck_destination (job, &err))
+        break;
+
       /* guess the target file for this node (unless already provided) */
       if (G_LIKELY (target_file == NULL))
         {
@@ -632,27 +1817,94 @@ thunar_transfer_job_copy_node (ThunarTransferJob  *job,
       else
         target_file = g_object_ref (target_file);
 
-      /* query file info */
-      info = g_file_query_info (node->source_file,
-                                G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME,
-                                G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
-                                exo_job_get_cancellable (EXO_JOB (job)),
-                                &err);
-
-      /* abort on error or cancellation */
-      if (info == NULL)
+      /* continue where an earlier run of the transfer stopped */
+      resumed_file = thunar_transfer_job_resume_node (job, node, target_file, &err);
+      if (G_UNLIKELY (err != NULL))
         {
           g_object_unref (target_file);
           break;
         }
 
+      /* hand small files over to the worker pool */
+      if (resumed_file == NULL
+          && target_parent_file != NULL
+          && thunar_transfer_job_dispatch_node (job, node, target_file, thumbnail_cache, &err))
+        {
+          g_object_unref (target_file);
+          target_file = NULL;
+          continue;
+        }
+
+      /* query the display name, unless the scanner already did */
+      if (G_UNLIKELY (node->display_name == NULL))
+        {
+          info = g_file_query_info (node->source_file,
+                                    G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME,
+                                    G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                    exo_job_get_cancellable (EXO_JOB (job)),
+                                    &err);
+
+          /* abort on error or cancellation */
+          if (info == NULL)
+            {
+              g_object_unref (target_file);
+              break;
+            }
+
+          node->display_name = g_strdup (g_file_info_get_display_name (info));
+          g_object_unref (info);
+        }
+
       /* update progress information */
-      exo_job_info_message (EXO_JOB (job), "%s", g_file_info_get_display_name (info));
+      exo_job_info_message (EXO_JOB (job), "%s", node->display_name);
 
 retry_copy:
+      /* check whether we are about to create a new directory */
+      new_directory = (node->type == G_FILE_TYPE_DIRECTORY
+                       && thunar_transfer_job_lookup_target (job, target_file, &exists)
+                       && !exists);
+
+      /* the file may already have been copied by an earlier run */
+      real_target_file = resumed_file;
+      resumed_file = NULL;
+
+      /* recreate hard links within the copied tree instead of copying the data again */
+      hardlink = (job->preserve_hardlinks
+                  && node->type == G_FILE_TYPE_REGULAR
+                  && node->n_links > 1);
+      if (hardlink && real_target_file == NULL)
+        {
+          real_target_file = thunar_transfer_job_link_node (job, node, target_file);
+          if (real_target_file != NULL)
+            {
+              /* account the linked file in the job progress */
+              job->file_progress = 0;
+              thunar_transfer_job_progress (node->size, node->size, job);
+              thunar_transfer_job_index_file (job, real_target_file);
+            }
+        }
+
       /* copy the item specified by this node (not recursively) */
-      real_target_file = thunar_transfer_job_copy_file (job, node->source_file,
-                                                        target_file, &err);
+      if (real_target_file == NULL)
+        {
+          /* remember large files, so we can continue if the copy is interrupted */
+          if (job->journal != NULL
+              && node->type == G_FILE_TYPE_REGULAR
+              && node->size >= THUNAR_TRANSFER_JOB_JOURNAL_PARTIAL_SIZE)
+            {
+              thunar_transfer_journal_record (job->journal, target_file, node->size,
+                                              node->mtime, THUNAR_TRANSFER_JOURNAL_PARTIAL);
+              job->journal_partial_file = target_file;
+            }
+
+          real_target_file = thunar_transfer_job_copy_file (job, node, target_file, &err);
+          job->journal_partial_file = NULL;
+
+          /* the other links to this inode are linked to the copy */
+          if (hardlink && real_target_file != NULL && real_target_file != node->source_file)
+            thunar_transfer_job_remember_link (job, node, real_target_file);
+        }
+
       if (G_LIKELY (real_target_file != NULL))
         {
           /* node->source_file == real_target_file means to skip the file */
@@ -663,17 +1915,46 @@ retry_copy:
                                                 node->source_file,
                                                 real_target_file);
 
-              /* check if we have children to copy */
-              if (node->children != NULL)
+              /* a resumed transfer does not need to copy this file again */
+              if (job->journal != NULL
+                  && node->type == G_FILE_TYPE_REGULAR
+                  && real_target_file == target_file)
+                {
+                  thunar_transfer_journal_record (job->journal, target_file, node->size,
+                                                  node->mtime, THUNAR_TRANSFER_JOURNAL_COMPLETE);
+                }
+
+              /* the children of a new directory don't need to be checked for conflicts */
+              if (node->type == G_FILE_TYPE_DIRECTORY
+                  && (new_directory || !g_file_equal (real_target_file, target_file)))
+                thunar_transfer_job_get_dir_index (job, real_target_file, TRUE);
+
+              /* check if we have children to copy, as soon as the scanner listed them */
+              if (node->type == G_FILE_TYPE_DIRECTORY
+                  && thunar_transfer_job_wait_node (job, node, THUNAR_TRANSFER_NODE_LISTED, &err)
+                  && node->children != NULL)
                 {
                   /* copy all children of this node */
                   thunar_transfer_job_copy_node (job, node->children, NULL, real_target_file, NULL, &err);
 
-                  /* free resources allocted for the children */
+                  /* the source directory can only be removed once the concurrent
+                   * copies of its children are done */
+                  if (job->type == THUNAR_TRANSFER_JOB_MOVE)
+                    thunar_transfer_job_wait_tasks (job, thumbnail_cache, &err);
+                }
+
+              /* free resources allocted for the children, once the scanner is done with them */
+              if (err == NULL
+                  && node->children != NULL
+                  && thunar_transfer_job_wait_node (job, node, THUNAR_TRANSFER_NODE_SCANNED, &err))
+                {
                   thunar_transfer_node_free (node->children);
                   node->children = NULL;
                 }
 
+              /* the names in the directory are no longer needed */
+              g_hash_table_remove (job->dir_indexes, real_target_file);
+
               /* check if the child copy failed */
               if (G_UNLIKELY (err != NULL))
                 {
@@ -691,32 +1972,9 @@ retry_copy:
                                                 real_target_file);
                 }
 
-retry_remove:
               /* try to remove the source directory if we are on copy+remove fallback for move */
               if (job->type == THUNAR_TRANSFER_JOB_MOVE)
-                {
-                  if (g_file_delete (node->source_file,
-                                     exo_job_get_cancellable (EXO_JOB (job)),
-                                     &err))
-                    {
-                      /* notify the thumbnail cache of the delete operation */
-                      thunar_thumbnail_cache_delete_file (thumbnail_cache,
-                                                          node->source_file);
-                    }
-                  else
-                    {
-                      /* ask the user to retry */
-                      response = thunar_job_ask_skip (THUNAR_JOB (job), "%s",
-                                                      err->message);
-
-                      /* reset the error */
-                      g_clear_error (&err);
-
-                      /* check whether to retry */
-                      if (G_UNLIKELY (response == THUNAR_JOB_RESPONSE_RETRY))
-                        goto retry_remove;
-                    }
-                }
+                thunar_transfer_job_remove_source (job, node->source_file, thumbnail_cache);
             }
 
           g_object_unref (real_target_file);
@@ -741,9 +1999,6 @@ retry_remove:
       /* release the guessed target file */
       g_object_unref (target_file);
       target_file = NULL;
-
-      /* release file info */
-      g_object_unref (info);
     }
 
   /* release the thumbnail cache */
@@ -768,6 +2023,7 @@ thunar_transfer_job_verify_destination (ThunarTransferJob  *transfer_job,
   gchar             *base_name;
   gboolean           succeed = TRUE;
   gchar             *size_string;
+  guint64            remaining_size;
 
   _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (transfer_job), FALSE);
 
@@ -775,10 +2031,12 @@ thunar_transfer_job_verify_destination (ThunarTransferJob  *transfer_job,
   if (transfer_job->target_file_list == NULL)
     return TRUE;
 
-  /* total size is nul, should be fine */
-  if (transfer_job->total_size == 0)
+  /* nothing left to copy, should be fine */
+  if (transfer_job->total_size <= transfer_job->total_progress)
     return TRUE;
 
+  remaining_size = transfer_job->total_size - transfer_job->total_progress;
+
   /* for all actions in thunar use the same target directory so
    * although not all files are checked, this should work nicely */
   dest = g_file_get_parent (G_FILE (transfer_job->target_file_list->data));
@@ -815,9 +2073,9 @@ thunar_transfer_job_verify_destination (ThunarTransferJob  *transfer_job,
   if (g_file_info_has_attribute (filesystem_info, G_FILE_ATTRIBUTE_FILESYSTEM_FREE))
     {
       free_space = g_file_info_get_attribute_uint64 (filesystem_info, G_FILE_ATTRIBUTE_FILESYSTEM_FREE);
-      if (transfer_job->total_size > free_space)
+      if (remaining_size > free_space)
         {
-          size_string = g_format_size_full (transfer_job->total_size - free_space,
+          size_string = g_format_size_full (remaining_size - free_space,
                                             transfer_job->file_size_binary ? G_FORMAT_SIZE_IEC_UNITS : G_FORMAT_SIZE_DEFAULT);
           succeed = thunar_job_ask_no_size (THUNAR_JOB (transfer_job),
                                              _("Error while copying to \"%s\": %s more space is "
@@ -846,6 +2104,42 @@ thunar_transfer_job_verify_destination (ThunarTransferJob  *transfer_job,
 
 
 
+static void
+thunar_transfer_job_report_strategies (ThunarTransferJob *job)
+{
+  ThunarIoCopyStrategy strategy;
+  GString             *summary;
+  guint                n_files = 0;
+
+  summary = g_string_new (NULL);
+  for (strategy = 0; strategy < THUNAR_IO_COPY_N_STRATEGIES; ++strategy)
+    {
+      if (job->n_strategy_files[strategy] == 0)
+        continue;
+
+      /* list the methods in a form like "clone 12, gio 3" */
+      if (summary->len > 0)
+        g_string_append (summary, ", ");
+      g_string_append_printf (summary, "%s %u",
+                              thunar_io_copy_strategy_get_name (strategy),
+                              job->n_strategy_files[strategy]);
+      n_files += job->n_strategy_files[strategy];
+    }
+
+  /* final status message for the progress view */
+  if (n_files > 0)
+    {
+      exo_job_info_message (EXO_JOB (job),
+                            ngettext ("Copied %u file (%s)",
+                                      "Copied %u files (%s)", n_files),
+                            n_files, summary->str);
+    }
+
+  g_string_free (summary, TRUE);
+}
+
+
+
 static gboolean
 thunar_transfer_job_execute (ExoJob  *job,
                              GError **error)
@@ -892,8 +2186,15 @@ thunar_transfer_job_execute (ExoJob  *job,
       /* determine the current source transfer node */
       node = sp->data;
 
+      /* query everything we need to move or copy the node at once */
       info = g_file_query_info (node->source_file,
-                                G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME,
+                                G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME ","
+                                G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                                G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                                G_FILE_ATTRIBUTE_UNIX_DEVICE ","
+                                G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+                                G_FILE_ATTRIBUTE_UNIX_INODE ","
+                                G_FILE_ATTRIBUTE_UNIX_NLINK,
                                 G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
                                 exo_job_get_cancellable (job),
                                 &err);
@@ -901,6 +2202,8 @@ thunar_transfer_job_execute (ExoJob  *job,
       if (G_UNLIKELY (info == NULL))
         break;
 
+      node->display_name = g_strdup (g_file_info_get_display_name (info));
+
       flags = G_FILE_COPY_NOFOLLOW_SYMLINKS | G_FILE_COPY_NO_FALLBACK_FOR_MOVE | G_FILE_COPY_ALL_METADATA;
 
       /* check if we are moving a file out of the trash */
@@ -1017,18 +2320,12 @@ thunar_transfer_job_execute (ExoJob  *job,
                                            "Collecting files for copying..."),
                                     g_file_info_get_display_name (info));
 
-              if (!thunar_transfer_job_collect_node (transfer_job, node, &err))
-                {
-                  /* failed to collect, cannot continue */
-                  g_object_unref (info);
-                  break;
-                }
+              thunar_transfer_job_collect_node (transfer_job, node, info);
             }
         }
       else if (transfer_job->type == THUNAR_TRANSFER_JOB_COPY)
         {
-          if (!thunar_transfer_job_collect_node (THUNAR_TRANSFER_JOB (job), node, &err))
-            break;
+          thunar_transfer_job_collect_node (transfer_job, node, info);
         }
 
       g_object_unref (info);
@@ -1037,6 +2334,10 @@ thunar_transfer_job_execute (ExoJob  *job,
   /* release the thumbnail cache */
   g_object_unref (thumbnail_cache);
 
+  /* continue an earlier, interrupted run of the same transfer */
+  if (G_LIKELY (err == NULL))
+    thunar_transfer_job_open_journal (transfer_job, &err);
+
   /* continue if there were no errors yet */
   if (G_LIKELY (err == NULL))
     {
@@ -1055,6 +2356,32 @@ thunar_transfer_job_execute (ExoJob  *job,
             }
         }
 
+      /* list the contents of the source directories in the background,
+       * so we can start copying before the whole tree is known */
+      for (sp = transfer_job->source_node_list; sp != NULL; sp = sp->next)
+        {
+          node = sp->data;
+          if (node->type == G_FILE_TYPE_DIRECTORY)
+            {
+              transfer_job->scan_pool = g_thread_pool_new (thunar_transfer_job_scan, transfer_job,
+                                                           1, FALSE, NULL);
+              g_thread_pool_push (transfer_job->scan_pool, transfer_job, NULL);
+              break;
+            }
+        }
+
+      /* index the names in the target directories, so conflicts and
+       * free duplicate names can be determined without probing files */
+      for (tp = transfer_job->target_file_list; tp != NULL; tp = tp->next)
+        {
+          target_parent = g_file_get_parent (tp->data);
+          if (G_LIKELY (target_parent != NULL))
+            {
+              thunar_transfer_job_get_dir_index (transfer_job, target_parent, FALSE);
+              g_object_unref (target_parent);
+            }
+        }
+
       /* transfer starts now */
       transfer_job->start_time = g_get_real_time ();
 
@@ -1066,6 +2393,38 @@ thunar_transfer_job_execute (ExoJob  *job,
           thunar_transfer_job_copy_node (transfer_job, sp->data, tp->data, NULL,
                                          &new_files_list, &err);
         }
+
+      /* wait for the remaining concurrent copies */
+      if (transfer_job->copy_pool != NULL)
+        {
+          application = thunar_application_get ();
+          thumbnail_cache = thunar_application_get_thumbnail_cache (application);
+          g_object_unref (application);
+
+          thunar_transfer_job_wait_tasks (transfer_job, thumbnail_cache, &err);
+
+          g_object_unref (thumbnail_cache);
+
+          /* release the worker threads */
+          g_thread_pool_free (transfer_job->copy_pool, FALSE, TRUE);
+          transfer_job->copy_pool = NULL;
+        }
+
+      /* wait for the scanner and report its errors, even if they
+       * happened in a part of the tree we skipped */
+      thunar_transfer_job_stop_scan (transfer_job);
+      if (err == NULL && transfer_job->scan_error != NULL)
+        err = g_error_copy (transfer_job->scan_error);
+    }
+
+  /* report how the files were copied */
+  thunar_transfer_job_report_strategies (transfer_job);
+
+  /* the journal is only needed if the transfer did not finish */
+  if (transfer_job->journal != NULL)
+    {
+      thunar_transfer_journal_free (transfer_job->journal, err == NULL);
+      transfer_job->journal = NULL;
     }
 
   /* check if we failed */
@@ -1101,6 +2460,7 @@ thunar_transfer_node_free (gpointer data)
 
       /* drop the source file of this node */
       g_object_unref (node->source_file);
+      g_free (node->display_name);
 
       /* release the resources of this node */
       g_slice_free (ThunarTransferNode, node);
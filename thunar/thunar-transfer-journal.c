@@ -0,0 +1,447 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#include <stdio.h>
+
+#include <glib/gstdio.h>
+
+#include <libxfce4util/libxfce4util.h>
+
+#include <thunar/thunar-private.h>
+#include <thunar/thunar-transfer-journal.h>
+
+
+
+/* The journal is a text file with one line per target file:
+ *
+ *   <state> <size> <mtime> <target uri>
+ *
+ * where state is 'P' if the copy was started and 'C' once it completed,
+ * and size/mtime describe the source file at the time. Later lines
+ * override earlier ones for the same target.
+ *
+ * The file is only written once a transfer copied enough to be worth
+ * resuming, small transfers never touch the disk.
+ */
+
+
+
+/* journals of transfers that were not resumed for this long are removed */
+#define THUNAR_TRANSFER_JOURNAL_MAX_AGE (14 * 24 * 60 * 60)
+
+/* the journal file is created once this much data or this many
+ * files were copied, or when the copy of a large file starts */
+#define THUNAR_TRANSFER_JOURNAL_MIN_SIZE  (64 * 1024 * 1024)
+#define THUNAR_TRANSFER_JOURNAL_MIN_FILES (1000)
+
+/* number of completed files that are written at once */
+#define THUNAR_TRANSFER_JOURNAL_BATCH_SIZE (64)
+
+
+
+typedef struct _ThunarTransferJournalEntry ThunarTransferJournalEntry;
+
+
+
+struct _ThunarTransferJournal
+{
+  gchar      *path;
+  FILE       *stream;
+
+  /* records that were not written yet */
+  GString    *pending;
+  guint       n_pending;
+
+  /* what was copied so far, see thunar_transfer_journal_record() */
+  guint64     n_bytes;
+  guint       n_files;
+
+  /* entries of an earlier run, by target uri */
+  GHashTable *entries;
+};
+
+struct _ThunarTransferJournalEntry
+{
+  ThunarTransferJournalState state;
+  guint64                    size;
+  guint64                    mtime;
+};
+
+
+
+static void
+thunar_transfer_journal_entry_free (gpointer data)
+{
+  g_slice_free (ThunarTransferJournalEntry, data);
+}
+
+
+
+static void
+thunar_transfer_journal_flush (ThunarTransferJournal *journal)
+{
+  gchar *dirname;
+
+  if (journal->pending->len == 0)
+    return;
+
+  /* create the journal on the first write */
+  if (G_UNLIKELY (journal->stream == NULL))
+    {
+      dirname = g_path_get_dirname (journal->path);
+      g_mkdir_with_parents (dirname, 0700);
+      g_free (dirname);
+
+      journal->stream = g_fopen (journal->path, "a");
+    }
+
+  if (G_LIKELY (journal->stream != NULL))
+    {
+      fwrite (journal->pending->str, 1, journal->pending->len, journal->stream);
+      fflush (journal->stream);
+    }
+
+  g_string_truncate (journal->pending, 0);
+  journal->n_pending = 0;
+}
+
+
+
+static void
+thunar_transfer_journal_prune (const gchar *path)
+{
+  const gchar *name;
+  GStatBuf     statb;
+  gchar       *dirname;
+  gchar       *filename;
+  gint64       now;
+  GDir        *dp;
+
+  /* the journals are stored next to each other */
+  dirname = g_path_get_dirname (path);
+  dp = g_dir_open (dirname, 0, NULL);
+  if (G_UNLIKELY (dp == NULL))
+    {
+      g_free (dirname);
+      return;
+    }
+
+  /* drop the journals of transfers that were never started again */
+  now = g_get_real_time () / G_USEC_PER_SEC;
+  while ((name = g_dir_read_name (dp)) != NULL)
+    {
+      filename = g_build_filename (dirname, name, NULL);
+      if (g_stat (filename, &statb) == 0
+          && S_ISREG (statb.st_mode)
+          && now - (gint64) statb.st_mtime > THUNAR_TRANSFER_JOURNAL_MAX_AGE)
+        g_unlink (filename);
+      g_free (filename);
+    }
+
+  g_dir_close (dp);
+  g_free (dirname);
+}
+
+
+
+/**
+ * thunar_transfer_journal_new:
+ * @source_file_list : the top-level source #GFile<!---->s of the transfer.
+ * @target_file_list : the top-level target #GFile<!---->s of the transfer.
+ *
+ * Allocates a journal for the transfer of @source_file_list to
+ * @target_file_list. The journal is stored in
+ * $XDG_CACHE_HOME/Thunar/transfers and is shared by all transfers
+ * of the same files, so a transfer that is started again finds the
+ * journal of the earlier run, see thunar_transfer_journal_load().
+ * Nothing is written until the transfer copied enough to be worth
+ * resuming. Journals that were not touched for two weeks are removed.
+ *
+ * Return value: the newly allocated #ThunarTransferJournal or %NULL
+ *               if there is no place to store it.
+ **/
+ThunarTransferJournal *
+thunar_transfer_journal_new (GList *source_file_list,
+                             GList *target_file_list)
+{
+  static gsize           pruned = 0;
+  ThunarTransferJournal *journal;
+  GChecksum             *checksum;
+  GList                 *lp;
+  gchar                 *uri;
+  gchar                 *spec;
+  gchar                 *path;
+
+  /* identify the transfer by its files */
+  checksum = g_checksum_new (G_CHECKSUM_MD5);
+  for (lp = source_file_list; lp != NULL; lp = lp->next)
+    {
+      uri = g_file_get_uri (lp->data);
+      g_checksum_update (checksum, (const guchar *) uri, -1);
+      g_checksum_update (checksum, (const guchar *) "\n", 1);
+      g_free (uri);
+    }
+  for (lp = target_file_list; lp != NULL; lp = lp->next)
+    {
+      uri = g_file_get_uri (lp->data);
+      g_checksum_update (checksum, (const guchar *) uri, -1);
+      g_checksum_update (checksum, (const guchar *) "\n", 1);
+      g_free (uri);
+    }
+
+  spec = g_strconcat ("Thunar/transfers/", g_checksum_get_string (checksum), NULL);
+  path = xfce_resource_save_location (XFCE_RESOURCE_CACHE, spec, FALSE);
+  g_checksum_free (checksum);
+  g_free (spec);
+
+  if (G_UNLIKELY (path == NULL))
+    return NULL;
+
+  /* clean up the old journals once per session */
+  if (g_once_init_enter (&pruned))
+    {
+      thunar_transfer_journal_prune (path);
+      g_once_init_leave (&pruned, 1);
+    }
+
+  journal = g_slice_new0 (ThunarTransferJournal);
+  journal->path = path;
+  journal->pending = g_string_new (NULL);
+  journal->entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                            thunar_transfer_journal_entry_free);
+
+  return journal;
+}
+
+
+
+/**
+ * thunar_transfer_journal_free:
+ * @journal  : a #ThunarTransferJournal.
+ * @finished : whether the transfer finished.
+ *
+ * Releases @journal. The journal file is removed if the transfer
+ * @finished, otherwise it is kept so the transfer can be resumed.
+ **/
+void
+thunar_transfer_journal_free (ThunarTransferJournal *journal,
+                              gboolean               finished)
+{
+  _thunar_return_if_fail (journal != NULL);
+
+  if (journal->stream != NULL)
+    {
+      /* write the last batch if the transfer can be resumed */
+      if (!finished)
+        thunar_transfer_journal_flush (journal);
+      fclose (journal->stream);
+    }
+
+  if (finished)
+    g_unlink (journal->path);
+
+  g_hash_table_destroy (journal->entries);
+  g_string_free (journal->pending, TRUE);
+  g_free (journal->path);
+
+  g_slice_free (ThunarTransferJournal, journal);
+}
+
+
+
+/**
+ * thunar_transfer_journal_load:
+ * @journal : a #ThunarTransferJournal.
+ *
+ * Loads what an earlier, interrupted run of the same transfer recorded.
+ *
+ * Return value: %TRUE if there was an earlier run to resume.
+ **/
+gboolean
+thunar_transfer_journal_load (ThunarTransferJournal *journal)
+{
+  ThunarTransferJournalEntry *entry;
+  gchar                     **lines;
+  gchar                      *contents;
+  gchar                      *end;
+  gchar                      *uri;
+  guint64                     size;
+  guint64                     mtime;
+  guint                       n;
+
+  _thunar_return_val_if_fail (journal != NULL, FALSE);
+
+  if (!g_file_get_contents (journal->path, &contents, NULL, NULL))
+    return FALSE;
+
+  lines = g_strsplit (contents, "\n", -1);
+  for (n = 0; lines[n] != NULL; ++n)
+    {
+      if (lines[n][0] != 'P' && lines[n][0] != 'C')
+        continue;
+
+      /* skip lines that were cut off */
+      size = g_ascii_strtoull (lines[n] + 1, &end, 10);
+      mtime = g_ascii_strtoull (end, &uri, 10);
+      if (G_UNLIKELY (*uri != ' ' || uri[1] == '\0'))
+        continue;
+
+      entry = g_slice_new (ThunarTransferJournalEntry);
+      entry->state = (lines[n][0] == 'C') ? THUNAR_TRANSFER_JOURNAL_COMPLETE : THUNAR_TRANSFER_JOURNAL_PARTIAL;
+      entry->size = size;
+      entry->mtime = mtime;
+      g_hash_table_replace (journal->entries, g_strdup (uri + 1), entry);
+    }
+
+  g_strfreev (lines);
+  g_free (contents);
+
+  return g_hash_table_size (journal->entries) > 0;
+}
+
+
+
+/**
+ * thunar_transfer_journal_reset:
+ * @journal : a #ThunarTransferJournal.
+ *
+ * Forgets about the earlier run, so the transfer starts from scratch.
+ **/
+void
+thunar_transfer_journal_reset (ThunarTransferJournal *journal)
+{
+  _thunar_return_if_fail (journal != NULL);
+
+  g_hash_table_remove_all (journal->entries);
+  g_string_truncate (journal->pending, 0);
+  journal->n_pending = 0;
+
+  if (journal->stream != NULL)
+    {
+      fclose (journal->stream);
+      journal->stream = NULL;
+    }
+
+  g_unlink (journal->path);
+}
+
+
+
+/**
+ * thunar_transfer_journal_lookup:
+ * @journal     : a #ThunarTransferJournal.
+ * @target_file : the target #GFile.
+ * @size        : the current size of the source file.
+ * @mtime       : the current modification time of the source file.
+ *
+ * Looks up what the earlier run recorded about @target_file. Entries
+ * for sources that changed meanwhile are ignored.
+ *
+ * Return value: the #ThunarTransferJournalState of @target_file.
+ **/
+ThunarTransferJournalState
+thunar_transfer_journal_lookup (ThunarTransferJournal *journal,
+                                GFile                 *target_file,
+                                guint64                size,
+                                guint64                mtime)
+{
+  ThunarTransferJournalEntry *entry;
+  gchar                      *uri;
+
+  _thunar_return_val_if_fail (journal != NULL, THUNAR_TRANSFER_JOURNAL_UNKNOWN);
+  _thunar_return_val_if_fail (G_IS_FILE (target_file), THUNAR_TRANSFER_JOURNAL_UNKNOWN);
+
+  if (g_hash_table_size (journal->entries) == 0)
+    return THUNAR_TRANSFER_JOURNAL_UNKNOWN;
+
+  uri = g_file_get_uri (target_file);
+  entry = g_hash_table_lookup (journal->entries, uri);
+  g_free (uri);
+
+  if (entry == NULL || entry->size != size || entry->mtime != mtime)
+    return THUNAR_TRANSFER_JOURNAL_UNKNOWN;
+
+  return entry->state;
+}
+
+
+
+/**
+ * thunar_transfer_journal_record:
+ * @journal     : a #ThunarTransferJournal.
+ * @target_file : the target #GFile.
+ * @size        : the size of the source file.
+ * @mtime       : the modification time of the source file.
+ * @state       : %THUNAR_TRANSFER_JOURNAL_PARTIAL when the copy of a
+ *                file starts, %THUNAR_TRANSFER_JOURNAL_COMPLETE once
+ *                it is done.
+ *
+ * Appends the @state of @target_file to the journal. Completed files
+ * are written in batches, started copies right away, so a partial
+ * file can be resumed after a crash. Until the transfer copied enough
+ * to be worth resuming, the records are only kept in memory.
+ **/
+void
+thunar_transfer_journal_record (ThunarTransferJournal     *journal,
+                                GFile                     *target_file,
+                                guint64                    size,
+                                guint64                    mtime,
+                                ThunarTransferJournalState state)
+{
+  gchar *uri;
+
+  _thunar_return_if_fail (journal != NULL);
+  _thunar_return_if_fail (G_IS_FILE (target_file));
+  _thunar_return_if_fail (state != THUNAR_TRANSFER_JOURNAL_UNKNOWN);
+
+  uri = g_file_get_uri (target_file);
+  g_string_append_printf (journal->pending, "%c%" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT " %s\n",
+                          (state == THUNAR_TRANSFER_JOURNAL_COMPLETE) ? 'C' : 'P', size, mtime, uri);
+  journal->n_pending += 1;
+  g_free (uri);
+
+  if (state == THUNAR_TRANSFER_JOURNAL_COMPLETE)
+    {
+      journal->n_bytes += size;
+      journal->n_files += 1;
+    }
+
+  if (state == THUNAR_TRANSFER_JOURNAL_PARTIAL)
+    thunar_transfer_journal_flush (journal);
+  else if (journal->stream == NULL)
+    {
+      /* small transfers are not worth a journal */
+      if (journal->n_bytes >= THUNAR_TRANSFER_JOURNAL_MIN_SIZE
+          || journal->n_files >= THUNAR_TRANSFER_JOURNAL_MIN_FILES)
+        thunar_transfer_journal_flush (journal);
+    }
+  else if (journal->n_pending >= THUNAR_TRANSFER_JOURNAL_BATCH_SIZE)
+    {
+      thunar_transfer_journal_flush (journal);
+    }
+}
@@ -0,0 +1,63 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __THUNAR_TRANSFER_JOURNAL_H__
+#define __THUNAR_TRANSFER_JOURNAL_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _ThunarTransferJournal ThunarTransferJournal;
+
+/**
+ * ThunarTransferJournalState:
+ * @THUNAR_TRANSFER_JOURNAL_UNKNOWN  : the file is not in the journal.
+ * @THUNAR_TRANSFER_JOURNAL_PARTIAL  : the copy of the file was started.
+ * @THUNAR_TRANSFER_JOURNAL_COMPLETE : the file was copied completely.
+ *
+ * What an earlier run of a transfer recorded about a target file.
+ **/
+typedef enum
+{
+  THUNAR_TRANSFER_JOURNAL_UNKNOWN,
+  THUNAR_TRANSFER_JOURNAL_PARTIAL,
+  THUNAR_TRANSFER_JOURNAL_COMPLETE,
+} ThunarTransferJournalState;
+
+ThunarTransferJournal     *thunar_transfer_journal_new      (GList                 *source_file_list,
+                                                             GList                 *target_file_list) G_GNUC_MALLOC;
+void                       thunar_transfer_journal_free     (ThunarTransferJournal *journal,
+                                                             gboolean               finished);
+
+gboolean                   thunar_transfer_journal_load     (ThunarTransferJournal *journal);
+void                       thunar_transfer_journal_reset    (ThunarTransferJournal *journal);
+
+ThunarTransferJournalState thunar_transfer_journal_lookup   (ThunarTransferJournal *journal,
+                                                             GFile                 *target_file,
+                                                             guint64                size,
+                                                             guint64                mtime);
+void                       thunar_transfer_journal_record   (ThunarTransferJournal *journal,
+                                                             GFile                 *target_file,
+                                                             guint64                size,
+                                                             guint64                mtime,
+                                                             ThunarTransferJournalState state);
+
+G_END_DECLS
+
+#endif /* !__THUNAR_TRANSFER_JOURNAL_H__ */
@@ -0,0 +1,850 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <glib/gstdio.h>
+
+#include <gio/gio.h>
+#ifdef HAVE_GIO_UNIX
+#include <gio/gunixmounts.h>
+#endif
+
+#include <thunar/thunar-io-trash.h>
+#include <thunar/thunar-private.h>
+#include <thunar/thunar-trash-monitor.h>
+
+
+
+/* delay before changes are announced, so emptying a large trash
+ * does not emit a notification per file */
+#define THUNAR_TRASH_MONITOR_NOTIFY_DELAY (250)
+
+
+
+/* property identifiers */
+enum
+{
+  PROP_0,
+  PROP_ITEM_COUNT,
+  PROP_SIZE,
+};
+
+
+
+typedef struct _ThunarTrashDir     ThunarTrashDir;
+typedef struct _ThunarTrashEntry   ThunarTrashEntry;
+typedef struct _ThunarTrashMeasure ThunarTrashMeasure;
+
+
+
+static void     thunar_trash_monitor_finalize           (GObject            *object);
+static void     thunar_trash_monitor_get_property       (GObject            *object,
+                                                         guint               prop_id,
+                                                         GValue             *value,
+                                                         GParamSpec         *pspec);
+static void     thunar_trash_monitor_measure            (gpointer            data,
+                                                         gpointer            user_data);
+static void     thunar_trash_monitor_refresh            (ThunarTrashMonitor *monitor);
+static void     thunar_trash_monitor_trash_changed      (GFileMonitor       *file_monitor,
+                                                         GFile              *file,
+                                                         GFile              *other_file,
+                                                         GFileMonitorEvent   event_type,
+                                                         ThunarTrashMonitor *monitor);
+
+
+
+struct _ThunarTrashMonitorClass
+{
+  GObjectClass __parent__;
+};
+
+struct _ThunarTrashMonitor
+{
+  GObject __parent__;
+
+  /* the monitored trash directories */
+  GList             *directories;
+
+#ifdef HAVE_GIO_UNIX
+  GUnixMountMonitor *mount_monitor;
+#endif
+
+  /* reports new trash directories, e.g. created when trashing
+   * files on a volume, see thunar_trash_monitor_trash_changed() */
+  GFileMonitor      *trash_monitor;
+  guint              refresh_timer_id;
+
+  /* measures the size of new trash entries, once someone
+   * asked for it, see thunar_trash_monitor_start_measuring() */
+  gboolean           measuring;
+  GThreadPool       *pool;
+  GAsyncQueue       *results;
+  volatile gint      results_scheduled;
+  volatile gint      shutdown;
+
+  guint              serial;
+  guint              n_items;
+  guint64            size;
+
+  /* the values of the last notification */
+  guint              notify_timer_id;
+  guint              notified_n_items;
+  guint64            notified_size;
+};
+
+/* a trash directory, with the top-level entries of its files/ */
+struct _ThunarTrashDir
+{
+  ThunarTrashMonitor *monitor;
+  gchar              *path;
+  GFileMonitor       *file_monitor;
+  GHashTable         *entries;
+};
+
+struct _ThunarTrashEntry
+{
+  guint64 size;
+  guint   serial;
+};
+
+/* sent to the worker threads and back */
+struct _ThunarTrashMeasure
+{
+  gchar   *path;
+  gchar   *name;
+  guint    serial;
+  guint64  size;
+};
+
+
+
+G_DEFINE_TYPE (ThunarTrashMonitor, thunar_trash_monitor, G_TYPE_OBJECT)
+
+
+
+static void
+thunar_trash_monitor_class_init (ThunarTrashMonitorClass *klass)
+{
+  GObjectClass *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->finalize = thunar_trash_monitor_finalize;
+  gobject_class->get_property = thunar_trash_monitor_get_property;
+
+  /**
+   * ThunarTrashMonitor:item-count:
+   *
+   * The number of items in the local trash directories.
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_ITEM_COUNT,
+                                   g_param_spec_uint ("item-count",
+                                                      "item-count",
+                                                      "item-count",
+                                                      0, G_MAXUINT, 0,
+                                                      EXO_PARAM_READABLE));
+
+  /**
+   * ThunarTrashMonitor:size:
+   *
+   * The total size in bytes of the items in the local trash directories.
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_SIZE,
+                                   g_param_spec_uint64 ("size",
+                                                        "size",
+                                                        "size",
+                                                        0, G_MAXUINT64, 0,
+                                                        EXO_PARAM_READABLE));
+}
+
+
+
+#ifdef HAVE_GIO_UNIX
+static void
+thunar_trash_monitor_mounts_changed (GUnixMountMonitor  *mount_monitor,
+                                     ThunarTrashMonitor *monitor)
+{
+  _thunar_return_if_fail (THUNAR_IS_TRASH_MONITOR (monitor));
+
+  /* volumes come and go with their trash directories */
+  thunar_trash_monitor_refresh (monitor);
+}
+#endif
+
+
+
+static void
+thunar_trash_monitor_init (ThunarTrashMonitor *monitor)
+{
+  GFile *trash;
+  gchar *path;
+
+  monitor->results = g_async_queue_new ();
+  monitor->pool = g_thread_pool_new (thunar_trash_monitor_measure, monitor, 1, FALSE, NULL);
+
+  /* make sure the home trash exists, so it is watched from the start */
+  path = g_build_filename (g_get_user_data_dir (), "Trash", "files", NULL);
+  g_mkdir_with_parents (path, 0700);
+  g_free (path);
+
+  thunar_trash_monitor_refresh (monitor);
+
+#ifdef HAVE_GIO_UNIX
+#if GLIB_CHECK_VERSION (2, 44, 0)
+  monitor->mount_monitor = g_unix_mount_monitor_get ();
+#else
+  monitor->mount_monitor = g_unix_mount_monitor_new ();
+#endif
+  g_signal_connect (G_OBJECT (monitor->mount_monitor), "mounts-changed",
+                    G_CALLBACK (thunar_trash_monitor_mounts_changed), monitor);
+#endif
+
+  /* trashing to a volume may add a trash directory */
+  trash = g_file_new_for_uri ("trash:///");
+  monitor->trash_monitor = g_file_monitor_directory (trash, G_FILE_MONITOR_NONE, NULL, NULL);
+  if (G_LIKELY (monitor->trash_monitor != NULL))
+    {
+      g_signal_connect (G_OBJECT (monitor->trash_monitor), "changed",
+                        G_CALLBACK (thunar_trash_monitor_trash_changed), monitor);
+    }
+  g_object_unref (trash);
+}
+
+
+
+static void
+thunar_trash_monitor_dir_free (ThunarTrashDir *dir)
+{
+  g_signal_handlers_disconnect_matched (dir->file_monitor, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, dir);
+  g_file_monitor_cancel (dir->file_monitor);
+  g_object_unref (dir->file_monitor);
+
+  g_hash_table_destroy (dir->entries);
+  g_free (dir->path);
+  g_slice_free (ThunarTrashDir, dir);
+}
+
+
+
+static void
+thunar_trash_monitor_measure_free (ThunarTrashMeasure *measure)
+{
+  g_free (measure->path);
+  g_free (measure->name);
+  g_slice_free (ThunarTrashMeasure, measure);
+}
+
+
+
+static void
+thunar_trash_monitor_finalize (GObject *object)
+{
+  ThunarTrashMonitor *monitor = THUNAR_TRASH_MONITOR (object);
+  ThunarTrashMeasure *measure;
+
+#ifdef HAVE_GIO_UNIX
+  g_signal_handlers_disconnect_matched (monitor->mount_monitor, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, monitor);
+  g_object_unref (monitor->mount_monitor);
+#endif
+
+  if (G_LIKELY (monitor->trash_monitor != NULL))
+    {
+      g_signal_handlers_disconnect_matched (monitor->trash_monitor, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, monitor);
+      g_file_monitor_cancel (monitor->trash_monitor);
+      g_object_unref (monitor->trash_monitor);
+    }
+
+  /* let the worker drop the queued entries without measuring them */
+  g_atomic_int_set (&monitor->shutdown, 1);
+  g_thread_pool_free (monitor->pool, FALSE, TRUE);
+
+  /* drop the pending idle and timeout sources */
+  while (g_source_remove_by_user_data (monitor))
+    ;
+
+  while ((measure = g_async_queue_try_pop (monitor->results)) != NULL)
+    thunar_trash_monitor_measure_free (measure);
+  g_async_queue_unref (monitor->results);
+
+  g_list_free_full (monitor->directories, (GDestroyNotify) thunar_trash_monitor_dir_free);
+
+  (*G_OBJECT_CLASS (thunar_trash_monitor_parent_class)->finalize) (object);
+}
+
+
+
+static void
+thunar_trash_monitor_get_property (GObject    *object,
+                                   guint       prop_id,
+                                   GValue     *value,
+                                   GParamSpec *pspec)
+{
+  ThunarTrashMonitor *monitor = THUNAR_TRASH_MONITOR (object);
+
+  switch (prop_id)
+    {
+    case PROP_ITEM_COUNT:
+      g_value_set_uint (value, monitor->notified_n_items);
+      break;
+
+    case PROP_SIZE:
+      g_value_set_uint64 (value, monitor->notified_size);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+
+
+static gboolean
+thunar_trash_monitor_notify_timeout (gpointer user_data)
+{
+  ThunarTrashMonitor *monitor = THUNAR_TRASH_MONITOR (user_data);
+
+  monitor->notify_timer_id = 0;
+
+  g_object_freeze_notify (G_OBJECT (monitor));
+
+  if (monitor->notified_n_items != monitor->n_items)
+    {
+      monitor->notified_n_items = monitor->n_items;
+      g_object_notify (G_OBJECT (monitor), "item-count");
+    }
+
+  if (monitor->notified_size != monitor->size)
+    {
+      monitor->notified_size = monitor->size;
+      g_object_notify (G_OBJECT (monitor), "size");
+    }
+
+  g_object_thaw_notify (G_OBJECT (monitor));
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_trash_monitor_schedule_notify (ThunarTrashMonitor *monitor)
+{
+  if (monitor->notify_timer_id == 0)
+    {
+      monitor->notify_timer_id = g_timeout_add (THUNAR_TRASH_MONITOR_NOTIFY_DELAY,
+                                                thunar_trash_monitor_notify_timeout,
+                                                monitor);
+    }
+}
+
+
+
+static guint64
+thunar_trash_monitor_measure_path (const gchar *path)
+{
+  struct stat  statb;
+  const gchar *name;
+  GPtrArray   *stack;
+  guint64      size = 0;
+  gchar       *current;
+  gchar       *child;
+  GDir        *dir;
+
+  if (g_lstat (path, &statb) != 0)
+    return 0;
+
+  if (!S_ISDIR (statb.st_mode))
+    return statb.st_size;
+
+  /* sum up the files in the tree, without following symlinks */
+  stack = g_ptr_array_new ();
+  g_ptr_array_add (stack, g_strdup (path));
+
+  while (stack->len > 0)
+    {
+      current = g_ptr_array_remove_index_fast (stack, stack->len - 1);
+
+      dir = g_dir_open (current, 0, NULL);
+      if (G_LIKELY (dir != NULL))
+        {
+          while ((name = g_dir_read_name (dir)) != NULL)
+            {
+              child = g_build_filename (current, name, NULL);
+
+              if (g_lstat (child, &statb) == 0 && S_ISDIR (statb.st_mode))
+                {
+                  g_ptr_array_add (stack, child);
+                  continue;
+                }
+
+              size += statb.st_size;
+              g_free (child);
+            }
+
+          g_dir_close (dir);
+        }
+
+      g_free (current);
+    }
+
+  g_ptr_array_free (stack, TRUE);
+
+  return size;
+}
+
+
+
+static ThunarTrashDir *
+thunar_trash_monitor_find_dir (ThunarTrashMonitor *monitor,
+                               const gchar        *path)
+{
+  ThunarTrashDir *dir;
+  GList          *lp;
+
+  for (lp = monitor->directories; lp != NULL; lp = lp->next)
+    {
+      dir = lp->data;
+      if (strcmp (dir->path, path) == 0)
+        return dir;
+    }
+
+  return NULL;
+}
+
+
+
+static gboolean
+thunar_trash_monitor_apply_results (gpointer user_data)
+{
+  ThunarTrashMonitor *monitor = THUNAR_TRASH_MONITOR (user_data);
+  ThunarTrashMeasure *measure;
+  ThunarTrashEntry   *entry;
+  ThunarTrashDir     *dir;
+
+  g_atomic_int_set (&monitor->results_scheduled, 0);
+
+  while ((measure = g_async_queue_try_pop (monitor->results)) != NULL)
+    {
+      /* ignore entries that changed since they were measured */
+      dir = thunar_trash_monitor_find_dir (monitor, measure->path);
+      entry = (dir != NULL) ? g_hash_table_lookup (dir->entries, measure->name) : NULL;
+      if (entry != NULL && entry->serial == measure->serial)
+        {
+          monitor->size = monitor->size - entry->size + measure->size;
+          entry->size = measure->size;
+        }
+
+      thunar_trash_monitor_measure_free (measure);
+    }
+
+  thunar_trash_monitor_schedule_notify (monitor);
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_trash_monitor_measure (gpointer data,
+                              gpointer user_data)
+{
+  ThunarTrashMeasure *measure = data;
+  ThunarTrashMonitor *monitor = THUNAR_TRASH_MONITOR (user_data);
+  gchar              *path;
+
+  /* this runs in the worker thread */
+  if (g_atomic_int_get (&monitor->shutdown) != 0)
+    {
+      thunar_trash_monitor_measure_free (measure);
+      return;
+    }
+
+  path = g_build_filename (measure->path, "files", measure->name, NULL);
+  measure->size = thunar_trash_monitor_measure_path (path);
+  g_free (path);
+
+  g_async_queue_push (monitor->results, measure);
+
+  /* hand the results to the main thread in batches */
+  if (g_atomic_int_compare_and_exchange (&monitor->results_scheduled, 0, 1))
+    g_idle_add (thunar_trash_monitor_apply_results, monitor);
+}
+
+
+
+static void
+thunar_trash_monitor_measure_entry (ThunarTrashMonitor *monitor,
+                                    ThunarTrashDir     *dir,
+                                    const gchar        *name,
+                                    ThunarTrashEntry   *entry)
+{
+  ThunarTrashMeasure *measure;
+
+  /* (re)measure the entry, older results are ignored */
+  entry->serial = ++monitor->serial;
+
+  measure = g_slice_new0 (ThunarTrashMeasure);
+  measure->path = g_strdup (dir->path);
+  measure->name = g_strdup (name);
+  measure->serial = entry->serial;
+  g_thread_pool_push (monitor->pool, measure, NULL);
+}
+
+
+
+static void
+thunar_trash_monitor_add_entry (ThunarTrashMonitor *monitor,
+                                ThunarTrashDir     *dir,
+                                const gchar        *name)
+{
+  ThunarTrashEntry *entry;
+
+  entry = g_hash_table_lookup (dir->entries, name);
+  if (entry == NULL)
+    {
+      entry = g_slice_new0 (ThunarTrashEntry);
+      g_hash_table_insert (dir->entries, g_strdup (name), entry);
+      monitor->n_items += 1;
+    }
+
+  if (monitor->measuring)
+    thunar_trash_monitor_measure_entry (monitor, dir, name, entry);
+
+  thunar_trash_monitor_schedule_notify (monitor);
+}
+
+
+
+static void
+thunar_trash_monitor_remove_entry (ThunarTrashMonitor *monitor,
+                                   ThunarTrashDir     *dir,
+                                   const gchar        *name)
+{
+  ThunarTrashEntry *entry;
+
+  entry = g_hash_table_lookup (dir->entries, name);
+  if (entry == NULL)
+    return;
+
+  monitor->n_items -= 1;
+  monitor->size -= entry->size;
+  g_hash_table_remove (dir->entries, name);
+
+  thunar_trash_monitor_schedule_notify (monitor);
+}
+
+
+
+static void
+thunar_trash_monitor_changed (GFileMonitor      *file_monitor,
+                              GFile             *file,
+                              GFile             *other_file,
+                              GFileMonitorEvent  event_type,
+                              ThunarTrashDir    *dir)
+{
+  ThunarTrashMonitor *monitor = dir->monitor;
+  gchar              *name;
+
+  _thunar_return_if_fail (THUNAR_IS_TRASH_MONITOR (monitor));
+
+  name = g_file_get_basename (file);
+
+  switch (event_type)
+    {
+    case G_FILE_MONITOR_EVENT_CREATED:
+    case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+      thunar_trash_monitor_add_entry (monitor, dir, name);
+      break;
+
+    case G_FILE_MONITOR_EVENT_DELETED:
+      thunar_trash_monitor_remove_entry (monitor, dir, name);
+      break;
+
+    default:
+      break;
+    }
+
+  g_free (name);
+}
+
+
+
+static void
+thunar_trash_monitor_entry_free (gpointer data)
+{
+  g_slice_free (ThunarTrashEntry, data);
+}
+
+
+
+static ThunarTrashDir *
+thunar_trash_monitor_dir_new (ThunarTrashMonitor *monitor,
+                              const gchar        *path)
+{
+  ThunarTrashDir *dir;
+  const gchar    *name;
+  GFile          *files;
+  gchar          *files_path;
+  GDir           *dp;
+
+  files_path = g_build_filename (path, "files", NULL);
+  files = g_file_new_for_path (files_path);
+
+  dir = g_slice_new0 (ThunarTrashDir);
+  dir->monitor = monitor;
+  dir->path = g_strdup (path);
+  dir->entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                        thunar_trash_monitor_entry_free);
+
+  /* watch the top-level entries */
+  dir->file_monitor = g_file_monitor_directory (files, G_FILE_MONITOR_NONE, NULL, NULL);
+  if (G_LIKELY (dir->file_monitor != NULL))
+    {
+      g_signal_connect (G_OBJECT (dir->file_monitor), "changed",
+                        G_CALLBACK (thunar_trash_monitor_changed), dir);
+    }
+
+  g_object_unref (files);
+
+  if (G_UNLIKELY (dir->file_monitor == NULL))
+    {
+      g_hash_table_destroy (dir->entries);
+      g_free (dir->path);
+      g_free (files_path);
+      g_slice_free (ThunarTrashDir, dir);
+      return NULL;
+    }
+
+  /* count the entries once, their sizes follow from the worker */
+  dp = g_dir_open (files_path, 0, NULL);
+  if (G_LIKELY (dp != NULL))
+    {
+      while ((name = g_dir_read_name (dp)) != NULL)
+        thunar_trash_monitor_add_entry (monitor, dir, name);
+      g_dir_close (dp);
+    }
+
+  g_free (files_path);
+
+  return dir;
+}
+
+
+
+static void
+thunar_trash_monitor_refresh (ThunarTrashMonitor *monitor)
+{
+  ThunarTrashEntry *entry;
+  ThunarTrashDir   *dir;
+  GHashTableIter    iter;
+  GPtrArray        *paths;
+  GList            *lp;
+  GList            *lnext;
+  guint             n;
+
+  paths = thunar_io_trash_get_directories (NULL);
+
+  /* forget the trash directories that went away */
+  for (lp = monitor->directories; lp != NULL; lp = lnext)
+    {
+      lnext = lp->next;
+      dir = lp->data;
+
+      for (n = 0; n < paths->len; ++n)
+        if (strcmp (g_ptr_array_index (paths, n), dir->path) == 0)
+          break;
+      if (n < paths->len)
+        continue;
+
+      g_hash_table_iter_init (&iter, dir->entries);
+      while (g_hash_table_iter_next (&iter, NULL, (gpointer) &entry))
+        monitor->size -= entry->size;
+      monitor->n_items -= g_hash_table_size (dir->entries);
+
+      monitor->directories = g_list_delete_link (monitor->directories, lp);
+      thunar_trash_monitor_dir_free (dir);
+
+      thunar_trash_monitor_schedule_notify (monitor);
+    }
+
+  /* watch the new ones */
+  for (n = 0; n < paths->len; ++n)
+    {
+      if (thunar_trash_monitor_find_dir (monitor, g_ptr_array_index (paths, n)) != NULL)
+        continue;
+
+      dir = thunar_trash_monitor_dir_new (monitor, g_ptr_array_index (paths, n));
+      if (G_LIKELY (dir != NULL))
+        monitor->directories = g_list_append (monitor->directories, dir);
+    }
+
+  g_ptr_array_free (paths, TRUE);
+}
+
+
+
+static gboolean
+thunar_trash_monitor_refresh_timeout (gpointer user_data)
+{
+  ThunarTrashMonitor *monitor = THUNAR_TRASH_MONITOR (user_data);
+
+  monitor->refresh_timer_id = 0;
+  thunar_trash_monitor_refresh (monitor);
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_trash_monitor_trash_changed (GFileMonitor       *file_monitor,
+                                    GFile              *file,
+                                    GFile              *other_file,
+                                    GFileMonitorEvent   event_type,
+                                    ThunarTrashMonitor *monitor)
+{
+  _thunar_return_if_fail (THUNAR_IS_TRASH_MONITOR (monitor));
+
+  if (event_type != G_FILE_MONITOR_EVENT_CREATED)
+    return;
+
+  /* the item may be in a trash directory we don't know about yet,
+   * look for new ones once a burst of changes is over */
+  if (monitor->refresh_timer_id == 0)
+    {
+      monitor->refresh_timer_id = g_timeout_add (THUNAR_TRASH_MONITOR_NOTIFY_DELAY,
+                                                 thunar_trash_monitor_refresh_timeout,
+                                                 monitor);
+    }
+}
+
+
+
+/**
+ * thunar_trash_monitor_get:
+ *
+ * Returns the shared #ThunarTrashMonitor, which keeps track of the
+ * number of items and the total size of the local trash directories
+ * from the changes reported by file monitors, so the trash does not
+ * have to be scanned again whenever it changes.
+ *
+ * The caller is responsible to free the returned object using
+ * g_object_unref() when no longer needed.
+ *
+ * Return value: the #ThunarTrashMonitor.
+ **/
+ThunarTrashMonitor *
+thunar_trash_monitor_get (void)
+{
+  static ThunarTrashMonitor *monitor = NULL;
+
+  if (G_UNLIKELY (monitor == NULL))
+    {
+      monitor = g_object_new (THUNAR_TYPE_TRASH_MONITOR, NULL);
+      g_object_add_weak_pointer (G_OBJECT (monitor), (gpointer) &monitor);
+    }
+  else
+    {
+      g_object_ref (G_OBJECT (monitor));
+    }
+
+  return monitor;
+}
+
+
+
+/**
+ * thunar_trash_monitor_start_measuring:
+ * @monitor : a #ThunarTrashMonitor.
+ *
+ * Starts measuring the items in the trash, in a worker thread. Only
+ * the items are counted until this is called, because measuring a
+ * large trash is expensive and its size is not needed most of the
+ * time. Calling this again has no effect.
+ **/
+void
+thunar_trash_monitor_start_measuring (ThunarTrashMonitor *monitor)
+{
+  ThunarTrashEntry *entry;
+  ThunarTrashDir   *dir;
+  GHashTableIter    iter;
+  const gchar      *name;
+  GList            *lp;
+
+  _thunar_return_if_fail (THUNAR_IS_TRASH_MONITOR (monitor));
+
+  if (monitor->measuring)
+    return;
+
+  monitor->measuring = TRUE;
+
+  for (lp = monitor->directories; lp != NULL; lp = lp->next)
+    {
+      dir = lp->data;
+      g_hash_table_iter_init (&iter, dir->entries);
+      while (g_hash_table_iter_next (&iter, (gpointer) &name, (gpointer) &entry))
+        thunar_trash_monitor_measure_entry (monitor, dir, name, entry);
+    }
+}
+
+
+
+/**
+ * thunar_trash_monitor_get_item_count:
+ * @monitor : a #ThunarTrashMonitor.
+ *
+ * Return value: the number of items in the trash.
+ **/
+guint
+thunar_trash_monitor_get_item_count (ThunarTrashMonitor *monitor)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_TRASH_MONITOR (monitor), 0);
+  return monitor->n_items;
+}
+
+
+
+/**
+ * thunar_trash_monitor_get_size:
+ * @monitor : a #ThunarTrashMonitor.
+ *
+ * Return value: the total size of the items in the trash in bytes.
+ *               Entries that are still being measured are not included,
+ *               nor is anything before thunar_trash_monitor_start_measuring().
+ **/
+guint64
+thunar_trash_monitor_get_size (ThunarTrashMonitor *monitor)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_TRASH_MONITOR (monitor), 0);
+  return monitor->size;
+}
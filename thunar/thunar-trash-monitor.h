@@ -0,0 +1,47 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __THUNAR_TRASH_MONITOR_H__
+#define __THUNAR_TRASH_MONITOR_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _ThunarTrashMonitorClass ThunarTrashMonitorClass;
+typedef struct _ThunarTrashMonitor      ThunarTrashMonitor;
+
+#define THUNAR_TYPE_TRASH_MONITOR            (thunar_trash_monitor_get_type ())
+#define THUNAR_TRASH_MONITOR(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), THUNAR_TYPE_TRASH_MONITOR, ThunarTrashMonitor))
+#define THUNAR_TRASH_MONITOR_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), THUNAR_TYPE_TRASH_MONITOR, ThunarTrashMonitorClass))
+#define THUNAR_IS_TRASH_MONITOR(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), THUNAR_TYPE_TRASH_MONITOR))
+#define THUNAR_IS_TRASH_MONITOR_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), THUNAR_TYPE_TRASH_MONITOR))
+#define THUNAR_TRASH_MONITOR_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), THUNAR_TYPE_TRASH_MONITOR, ThunarTrashMonitorClass))
+
+GType               thunar_trash_monitor_get_type        (void) G_GNUC_CONST;
+
+ThunarTrashMonitor *thunar_trash_monitor_get             (void);
+
+void                thunar_trash_monitor_start_measuring (ThunarTrashMonitor *monitor);
+
+guint               thunar_trash_monitor_get_item_count  (ThunarTrashMonitor *monitor);
+guint64             thunar_trash_monitor_get_size        (ThunarTrashMonitor *monitor);
+
+G_END_DECLS
+
+#endif /* !__THUNAR_TRASH_MONITOR_H__ */